@@ -0,0 +1,68 @@
+# Microbenchmarks of the finance kernels: no Qt modules are linked.
+
+QT      -= core gui
+
+TARGET   = stock-market-benchmark
+TEMPLATE = app
+CONFIG  += console c++11 thread release
+CONFIG  -= qt app_bundle debug
+
+# qmake CONFIG+=tracing compiles in the FINANCE_TRACE_SCOPE trace points.
+tracing: DEFINES += FINANCE_TRACING
+
+# The batch kernels are loops the compiler vectorizes for each instruction set level.
+gcc|clang: QMAKE_CXXFLAGS += -fopenmp-simd -fno-trapping-math -fno-math-errno
+
+# Allocations per operation are always reported.
+DEFINES += FINANCE_ALLOCATION_TRACKING
+
+INCLUDEPATH += include
+INCLUDEPATH += ../include
+
+SOURCES += src/main.cpp \
+           src/present_value_benchmarks.cpp \
+           src/date_benchmarks.cpp \
+           src/kernel_benchmarks.cpp \
+           src/accuracy.cpp \
+           src/pricing.cpp \
+           src/scheduling.cpp \
+           ../src/date.cpp \
+           ../src/perf_counters.cpp \
+           ../src/allocation_tracker.cpp \
+           ../src/batch_kernels.cpp \
+           ../src/random.cpp \
+           ../src/task_scheduler.cpp \
+           ../src/cpu_dispatch.cpp \
+           ../src/latency_histogram.cpp \
+           ../src/trace.cpp
+
+HEADERS += include/benchmark.hpp \
+           include/benchmarks.hpp \
+           include/accuracy.hpp \
+           include/pricing.hpp \
+           include/scheduling.hpp \
+           ../include/present_value.hpp \
+           ../include/hazard_curve.hpp \
+           ../include/credit_default_swap.hpp \
+           ../include/hull_white.hpp \
+           ../include/black_scholes.hpp \
+           ../include/volatility_surface.hpp \
+           ../include/carr_madan.hpp \
+           ../include/fft.hpp \
+           ../include/characteristic_functions.hpp \
+           ../include/monte_carlo.hpp \
+           ../include/path_payoffs.hpp \
+           ../include/reproducible_sum.hpp \
+           ../include/batch_kernels.hpp \
+           ../include/vector_math.hpp \
+           ../include/random.hpp \
+           ../include/parallel.hpp \
+           ../include/task_scheduler.hpp \
+           ../include/cpu_dispatch.hpp \
+           ../include/latency_histogram.hpp \
+           ../include/solver_statistics.hpp \
+           ../include/date.hpp \
+           ../include/dated.hpp \
+           ../include/perf_counters.hpp \
+           ../include/allocation_tracker.hpp \
+           ../include/trace.hpp
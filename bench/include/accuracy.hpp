@@ -0,0 +1,28 @@
+/**
+ * \file
+ * Accuracy of the batch kernels against long double references.
+ */
+
+#pragma once
+
+#include <ostream>
+
+#include <benchmark.hpp>
+
+
+
+namespace bench {
+
+/**
+ * \brief Measures the largest error in ulp of each elementwise batch kernel, for double and
+ *        float, at every finance::Isa level of this host and writes them as JSON to \p os.
+ *
+ * \par
+ *      Each function is checked on a random sample of its domain and on its special cases:
+ *      zeros, infinities, NaN, subnormals and the bounds of overflow and underflow.
+ *
+ * \return true if every error is within the bound vector_math.hpp documents.
+ */
+bool accuracy_report(std::ostream& os);
+
+}
@@ -0,0 +1,230 @@
+/**
+ * \file
+ * A minimal benchmark harness: calibrated timing loops, allocation counts and JSON output.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <allocation_tracker.hpp>
+#include <cpu_dispatch.hpp>
+#include <latency_histogram.hpp>
+#include <perf_counters.hpp>
+
+
+
+namespace bench {
+
+/**
+ * \brief Keeps the compiler from optimizing away the computation of \p value.
+ */
+template <class T>
+inline void do_not_optimize(const T& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+template <class T> inline const char* type_name();
+template <> inline const char* type_name<float>()  { return "float"; }
+template <> inline const char* type_name<double>() { return "double"; }
+
+/**
+ * \brief Measurement of one benchmark.
+ */
+struct Result
+{
+    std::string name;
+    std::string type;
+    int size;
+    long iterations;
+    double ns_per_op;
+    double items_per_second;
+    double allocations_per_op;
+    double events_per_op[finance::PerfCounters::NumEvents];
+    finance::LatencyHistogram latency;
+};
+
+/**
+ * \brief The Runner class times benchmarks and collects their results.
+ *
+ * \par
+ *      A benchmark is a callable performing one operation on \p items_per_op items. The number
+ *      of iterations is grown geometrically until one timed run lasts at least the minimum
+ *      time, and that run is reported, so fast and slow operations are both measured with
+ *      about the same precision. Allocations are counted over the same run.
+ * \par
+ *      With set_latency() a second run of the same length times samples of operations one by
+ *      one into a latency histogram, to report percentiles along with the mean. A sample is as
+ *      many operations as last about a microsecond, one for all but the fastest operations,
+ *      so the clock does not dominate; within a sample only the mean is seen.
+ */
+class Runner
+{
+public:
+    /**
+     * \param min_time  Minimum duration of the reported run, in seconds.
+     * \param filter    Only benchmarks whose name contains \p filter are run.
+     */
+    Runner(const double min_time,
+           const std::string& filter)
+        : min_time{min_time},
+          filter{filter},
+          counters{nullptr},
+          latency{false}
+    {}
+
+    /**
+     * \brief Also counts hardware events over the reported run. Events that \p counters cannot
+     *        count are left out of the results. Null disables counting.
+     */
+    void set_counters(finance::PerfCounters* counters)
+    {
+        this->counters = counters;
+    }
+
+    /**
+     * \brief Also measures the latency distribution of each benchmark.
+     */
+    void set_latency(const bool on)
+    {
+        latency = on;
+    }
+
+    template <class Function>
+    void run(const std::string& name,
+             const std::string& type,
+             const int size,
+             const long items_per_op,
+             Function operation)
+    {
+        if (name.find(filter) == std::string::npos)
+            return;
+
+        operation();
+        long iterations = 1;
+        for (;;) {
+            finance::AllocationScope allocations;
+            if (counters != nullptr)
+                counters->start();
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (long i = 0; i < iterations; i++)
+                operation();
+            const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+            if (counters != nullptr)
+                counters->stop();
+            const long allocated = allocations.counts().allocations;
+            const double seconds = std::chrono::duration<double>(stop - start).count();
+
+            if (seconds >= min_time or iterations >= (1L << 40)) {
+                Result r;
+                r.name = name;
+                r.type = type;
+                r.size = size;
+                r.iterations = iterations;
+                r.ns_per_op = seconds * 1.0e9 / iterations;
+                r.items_per_second = (seconds > 0.0) ? items_per_op * iterations / seconds : 0.0;
+                r.allocations_per_op = static_cast<double>(allocated) / iterations;
+                for (int e = 0; e < finance::PerfCounters::NumEvents; e++) {
+                    const finance::PerfCounters::Event event = static_cast<finance::PerfCounters::Event>(e);
+                    r.events_per_op[e] = (counters != nullptr) ? counters->value(event) / iterations
+                                                             : std::numeric_limits<double>::quiet_NaN();
+                }
+                if (latency)
+                    sample_latency(operation, r);
+                results.push_back(r);
+                std::cerr << name << '<' << type << ">/" << size << ": " << r.ns_per_op << " ns/op";
+                if (latency)
+                    std::cerr << ", p99 " << r.latency.percentile(0.99) << " ns";
+                std::cerr << '\n';
+                return;
+            }
+            // Aim past the minimum time, but never grow by more than 10 times at once.
+            const double scale = (seconds > 0.0) ? 1.4 * min_time / seconds : 10.0;
+            iterations = static_cast<long>(iterations * std::min(10.0, std::max(2.0, scale)));
+        }
+    }
+
+    const std::vector<Result>& get_results() const
+    {
+        return results;
+    }
+
+    /**
+     * \brief Writes the results as a JSON document.
+     */
+    void write_json(std::ostream& os) const
+    {
+        os << "{\n  \"context\": {\"min_time\": " << min_time
+#if defined(__VERSION__)
+           << ", \"compiler\": \"" << __VERSION__ << "\""
+#endif
+           << ", \"isa\": \"" << finance::isa_name(finance::active_isa()) << "\""
+           << "},\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const Result& r = results[i];
+            os << (i == 0 ? "\n" : ",\n")
+               << "    {\"name\": \"" << r.name << "\", \"type\": \"" << r.type << "\", \"size\": " << r.size
+               << ", \"iterations\": " << r.iterations << ", \"ns_per_op\": " << r.ns_per_op
+               << ", \"items_per_second\": " << r.items_per_second
+               << ", \"allocations_per_op\": " << r.allocations_per_op;
+            for (int e = 0; e < finance::PerfCounters::NumEvents; e++) {
+                if (not std::isnan(r.events_per_op[e]))
+                    os << ", \"" << finance::PerfCounters::name(static_cast<finance::PerfCounters::Event>(e))
+                       << "_per_op\": " << r.events_per_op[e];
+            }
+            const double cycles = r.events_per_op[finance::PerfCounters::Cycles];
+            const double instructions = r.events_per_op[finance::PerfCounters::Instructions];
+            if (cycles > 0.0 and not std::isnan(instructions))
+                os << ", \"ipc\": " << instructions / cycles;
+            if (r.latency.get_count() > 0)
+                os << ", \"latency_samples\": " << r.latency.get_count()
+                   << ", \"p50_ns\": " << r.latency.percentile(0.5)
+                   << ", \"p90_ns\": " << r.latency.percentile(0.9)
+                   << ", \"p99_ns\": " << r.latency.percentile(0.99)
+                   << ", \"p999_ns\": " << r.latency.percentile(0.999)
+                   << ", \"max_ns\": " << r.latency.get_max();
+            os << "}";
+        }
+        os << "\n  ]\n}\n";
+    }
+
+private:
+    template <class Function>
+    void sample_latency(Function& operation,
+                        Result& r) const
+    {
+        const long batch = std::max(1L, static_cast<long>(std::ceil(1000.0 / std::max(r.ns_per_op, 1.0e-3))));
+        const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now()
+            + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(min_time));
+        for (;;) {
+            const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            if (start >= end and r.latency.get_count() > 0)
+                return;
+            for (long i = 0; i < batch; i++)
+                operation();
+            const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+            const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+            r.latency.record(static_cast<std::uint64_t>(ns / batch + 0.5), 1);
+        }
+    }
+
+    double min_time;
+    std::string filter;
+    finance::PerfCounters* counters;
+    bool latency;
+    std::vector<Result> results;
+};
+
+}
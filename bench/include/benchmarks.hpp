@@ -0,0 +1,18 @@
+/**
+ * \file
+ * Registration of the benchmark groups.
+ */
+
+#pragma once
+
+#include <benchmark.hpp>
+
+
+
+namespace bench {
+
+void present_value_benchmarks(Runner& runner);
+void date_benchmarks(Runner& runner);
+void kernel_benchmarks(Runner& runner);
+
+}
@@ -0,0 +1,27 @@
+/**
+ * \file
+ * Behaviour checks of the pricing engines against values they must reproduce.
+ */
+
+#pragma once
+
+#include <ostream>
+
+
+
+namespace bench {
+
+/**
+ * \brief Prices instruments whose value is known by construction or in closed form with the
+ *        pricing engines and writes the largest error of each check as JSON to \p os.
+ *
+ * \par
+ *      A model calibrated to market quotes must reprice them, and a numerical method must
+ *      converge to the closed form where there is one. Each error is relative to the size of
+ *      the prices compared unless the check says otherwise.
+ *
+ * \return true if every error is within its tolerance.
+ */
+bool pricing_report(std::ostream& os);
+
+}
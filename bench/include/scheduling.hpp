@@ -0,0 +1,27 @@
+/**
+ * \file
+ * Task counts of parallel_for on schedulers of several sizes.
+ */
+
+#pragma once
+
+#include <ostream>
+
+
+
+namespace bench {
+
+/**
+ * \brief Runs an evenly loaded parallel_for on task schedulers of 2 to 16 threads and writes the
+ *        number of tasks each call spawned as JSON to \p os.
+ *
+ * \par
+ *      parallel_for splits a range into about four chunks per thread and splits stolen chunks
+ *      further, but never into chunks shorter than half the initial ones, so the task count
+ *      must stay proportional to the number of threads whatever the stealing.
+ *
+ * \return true if every count is within 16 tasks per thread.
+ */
+bool scheduling_report(std::ostream& os);
+
+}
@@ -0,0 +1,325 @@
+#include <accuracy.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <batch_kernels.hpp>
+#include <cpu_dispatch.hpp>
+
+
+namespace {
+
+typedef long double Real;
+
+const int Samples = 1 << 18;
+
+/**
+ * Size of one unit in the last place of T at the exact value \p y.
+ */
+template <class T>
+Real ulp(const Real y)
+{
+    const int lowest = std::numeric_limits<T>::min_exponent - 1;
+    const int exponent = y == 0.0L ? lowest : std::max(std::ilogb(y), lowest);
+    return std::ldexp(Real(1), exponent - (std::numeric_limits<T>::digits - 1));
+}
+
+/**
+ * Error of \p y in ulp of the reference \p exact, or infinity if one is not finite and they
+ * differ.
+ */
+template <class T>
+Real error_ulp(const T y, const Real exact)
+{
+    const T rounded = static_cast<T>(exact);
+    if (std::isnan(rounded) or std::isinf(rounded))
+        return (y == rounded or (std::isnan(y) and std::isnan(rounded))) ? Real(0) : std::numeric_limits<Real>::infinity();
+    if (not std::isfinite(y))
+        return std::numeric_limits<Real>::infinity();
+    return std::fabs(y - exact) / ulp<T>(exact);
+}
+
+Real normal_cdf_reference(const Real x)
+{
+    return 0.5L * std::erfc(-x / std::sqrt(2.0L));
+}
+
+/**
+ * The quantile by Newton steps in long double from \p z, on the lower half: 1 - p is exact for
+ * p >= 0.5, so the upper half is its mirror.
+ */
+Real normal_quantile_reference(const Real p, const Real z)
+{
+    if (p > 0.5L)
+        return -normal_quantile_reference(1.0L - p, -z);
+    if (p == 0.0L)
+        return -std::numeric_limits<Real>::infinity();
+    Real x = std::isfinite(z) ? z : Real(-38);
+    for (int i = 0; i < 4; i++) {
+        const Real density = std::exp(-0.5L * x * x) / std::sqrt(2.0L * 3.14159265358979323846264338327950288L);
+        x -= (normal_cdf_reference(x) - p) / density;
+    }
+    return x;
+}
+
+/**
+ * Log-uniform magnitude in [lo, hi], so every binade is sampled alike.
+ */
+template <class Generator>
+double log_uniform(Generator& generator, const double lo, const double hi)
+{
+    std::uniform_real_distribution<double> exponent(std::log(lo), std::log(hi));
+    return std::exp(exponent(generator));
+}
+
+/**
+ * The documented bound of a function in ulp of T: the float functions round a double result.
+ */
+template <class T>
+double bound(const double double_bound)
+{
+    return std::numeric_limits<T>::digits < std::numeric_limits<double>::digits ? 1.0 : double_bound;
+}
+
+struct Check
+{
+    const char* function;
+    const char* type;
+    double bound;
+    Real max_ulp;
+    double at;
+};
+
+template <class T>
+void record(Check& check, const T* x, const T* y, const Real* exact, const int n)
+{
+    for (int i = 0; i < n; i++) {
+        const Real e = error_ulp(y[i], exact[i]);
+        if (e > check.max_ulp or std::isnan(e)) {
+            check.max_ulp = e;
+            check.at = x[i];
+        }
+    }
+}
+
+/**
+ * Arguments of one function, its results and their references: a random sample of the domain
+ * followed by the special cases.
+ */
+template <class T>
+struct Inputs
+{
+    std::vector<T> x;
+    std::vector<T> y;
+    std::vector<Real> exact;
+
+    void add(const double xi, const Real e)
+    {
+        x.push_back(static_cast<T>(xi));
+        exact.push_back(e);
+    }
+};
+
+template <class T, class Reference>
+Inputs<T> sample(std::mt19937_64& generator,
+                 const double lo,
+                 const double hi,
+                 const double* specials,
+                 const int num_specials,
+                 Reference reference)
+{
+    Inputs<T> inputs;
+    std::uniform_real_distribution<double> uniform(lo, hi);
+    for (int i = 0; i < Samples; i++) {
+        const T x = static_cast<T>(uniform(generator));
+        inputs.add(x, reference(x));
+    }
+    for (int i = 0; i < num_specials; i++) {
+        const T x = static_cast<T>(specials[i]);
+        inputs.add(x, reference(x));
+    }
+    return inputs;
+}
+
+template <class T>
+Check run_unary(const char* function,
+                const double bound,
+                Inputs<T>& inputs,
+                void (*batch)(const T*, T*, int))
+{
+    Check check = { function, bench::type_name<T>(), bound, 0.0L, 0.0 };
+    const int n = inputs.x.size();
+    inputs.y.resize(n);
+    batch(inputs.x.data(), inputs.y.data(), n);
+    record(check, inputs.x.data(), inputs.y.data(), inputs.exact.data(), n);
+    return check;
+}
+
+const double Inf = std::numeric_limits<double>::infinity();
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+const double Tiny = std::numeric_limits<double>::denorm_min();
+const double Least = std::numeric_limits<double>::min();
+const double Most = std::numeric_limits<double>::max();
+
+template <class T>
+void check_type(std::mt19937_64& generator, std::vector<Check>& checks)
+{
+    // Special cases against the long double functions: they follow C99 Annex F too.
+    const double exp_specials[] = { 0.0, -0.0, 1.0, -1.0, 709.78, 709.79, -745.13, -745.14, -708.4, -720.0,
+                                    Inf, -Inf, NaN, Most, -Most, Tiny };
+    Inputs<T> exp_inputs = sample<T>(generator, -745.2, 709.8, exp_specials, sizeof(exp_specials) / sizeof(double), [](const T x) { return std::exp(Real(x)); });
+    checks.push_back(run_unary<T>("exp", bound<T>(1.5), exp_inputs, finance::exp_batch));
+
+    const double log_specials[] = { 1.0, 0.0, -0.0, -1.0, Tiny, Least, 0.5 * Least, Most, Inf, -Inf, NaN,
+                                    0.7071067811865476, 1.4142135623730951, 1.0 - 1.0e-16, 1.0 + 2.0e-16 };
+    Inputs<T> log_inputs;
+    for (int i = 0; i < Samples; i++) {
+        const T x = static_cast<T>(log_uniform(generator, std::numeric_limits<T>::denorm_min(), std::numeric_limits<T>::max()));
+        log_inputs.add(x, std::log(Real(x)));
+    }
+    for (const double s : log_specials)
+        log_inputs.add(static_cast<T>(s), std::log(Real(static_cast<T>(s))));
+    checks.push_back(run_unary<T>("log", bound<T>(1.5), log_inputs, finance::log_batch));
+
+    const double erf_specials[] = { 0.0, -0.0, 1.0e-300, -1.0e-300, Tiny, 1.0, -1.0, 3.0, 5.92, 6.0, -6.0,
+                                    27.0, 27.5, 28.0, -28.0, 40.0, Inf, -Inf, NaN };
+    const int num_erf_specials = sizeof(erf_specials) / sizeof(double);
+    Inputs<T> erf_inputs = sample<T>(generator, -6.5, 6.5, erf_specials, num_erf_specials, [](const T x) { return std::erf(Real(x)); });
+    checks.push_back(run_unary<T>("erf", bound<T>(2.5), erf_inputs, finance::erf_batch));
+    Inputs<T> erfc_inputs = sample<T>(generator, -6.5, 28.0, erf_specials, num_erf_specials, [](const T x) { return std::erfc(Real(x)); });
+    checks.push_back(run_unary<T>("erfc", bound<T>(7.0), erfc_inputs, finance::erfc_batch));
+
+    const double cdf_specials[] = { 0.0, -0.0, 1.0, -1.0, 1.4142135623730951, -1.4142135623730951, -8.5, 8.5,
+                                    -37.5, -38.5, -39.0, -40.0, 40.0, Inf, -Inf, NaN };
+    Inputs<T> cdf_inputs = sample<T>(generator, -38.5, 9.0, cdf_specials, sizeof(cdf_specials) / sizeof(double), [](const T x) { return normal_cdf_reference(Real(x)); });
+    checks.push_back(run_unary<T>("normal_cdf", bound<T>(8.0), cdf_inputs, finance::normal_cdf_batch));
+
+    // The quantile reference refines the result, so it is computed after the batch.
+    const double quantile_specials[] = { 0.5, 0.075, 0.925, 0.0, 1.0, -0.5, 1.5, Tiny, Least, 1.0e-300,
+                                         1.0 - 1.0e-16, Inf, NaN };
+    Inputs<T> quantile;
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int i = 0; i < Samples; i++) {
+        const double p = i % 2 == 0 ? uniform(generator) : log_uniform(generator, std::numeric_limits<T>::denorm_min(), 0.5);
+        quantile.add(i % 4 == 3 ? 1.0 - p : p, 0.0L);
+    }
+    for (const double s : quantile_specials)
+        quantile.add(s, 0.0L);
+    const int n = quantile.x.size();
+    quantile.y.resize(n);
+    finance::normals_batch(quantile.x.data(), quantile.y.data(), n);
+    for (int i = 0; i < n; i++) {
+        const Real p = quantile.x[i];
+        quantile.exact[i] = (p < 0.0L or p > 1.0L or std::isnan(p)) ? std::numeric_limits<Real>::quiet_NaN()
+                          : p == 1.0L ? std::numeric_limits<Real>::infinity()
+                          : normal_quantile_reference(p, quantile.y[i]);
+    }
+    Check quantile_check = { "normal_quantile", bench::type_name<T>(), bound<T>(8.0), 0.0L, 0.0 };
+    record(quantile_check, quantile.x.data(), quantile.y.data(), quantile.exact.data(), n);
+    checks.push_back(quantile_check);
+
+    // pow: x log-uniform, y chosen so that x^y stays in range half of the time, then the
+    // special cases of every sign, zero, one, infinity and NaN pair.
+    Inputs<T> pow_inputs;
+    std::vector<T> exponents;
+    const Real range = std::log(Real(std::numeric_limits<T>::max()));
+    for (int i = 0; i < Samples; i++) {
+        T x = static_cast<T>(log_uniform(generator, 1.0e-6, 1.0e6));
+        const Real limit = 1.25L * range / std::fabs(std::log(Real(x)));
+        std::uniform_real_distribution<double> exponent(-static_cast<double>(limit), static_cast<double>(limit));
+        T y = static_cast<T>(exponent(generator));
+        if (i % 8 == 0) {
+            x = -x;
+            y = static_cast<T>(std::floor(double(y)));
+        }
+        pow_inputs.add(x, 0.0L);
+        exponents.push_back(y);
+    }
+    const double pow_specials[] = { 0.0, -0.0, 1.0, -1.0, 0.5, 2.0, -2.0, 3.0, -3.0, 1.0e300, 1.0e-300,
+                                    4503599627370497.0, -4503599627370497.0, 9007199254740994.0, Inf, -Inf, NaN };
+    for (const double a : pow_specials)
+        for (const double b : pow_specials) {
+            pow_inputs.add(static_cast<T>(a), 0.0L);
+            exponents.push_back(static_cast<T>(b));
+        }
+    const int m = pow_inputs.x.size();
+    for (int i = 0; i < m; i++)
+        pow_inputs.exact[i] = std::pow(Real(pow_inputs.x[i]), Real(exponents[i]));
+    pow_inputs.y.resize(m);
+    finance::pow_batch(pow_inputs.x.data(), exponents.data(), pow_inputs.y.data(), m);
+    Check pow_check = { "pow", bench::type_name<T>(), bound<T>(1.5), 0.0L, 0.0 };
+    record(pow_check, pow_inputs.x.data(), pow_inputs.y.data(), pow_inputs.exact.data(), m);
+    checks.push_back(pow_check);
+
+    // sin and cos: half of the sample over the reduced range, half log-uniform in magnitude
+    // so that small arguments and the first quadrants are covered too.
+    const double trig_specials[] = { 0.0, -0.0, Tiny, -Tiny, 1.0e-300, 1.0e-8, 0.5, 0.785398163397448,
+                                     1.5707963267948966, -1.5707963267948966, 3.141592653589793, 4.71238898038469,
+                                     6.283185307179586, 355.0, 1.0e6, 1.6e6, -1.6e6, Inf, -Inf, NaN };
+    Inputs<T> trig;
+    std::uniform_real_distribution<double> wide(-1.6e6, 1.6e6);
+    for (int i = 0; i < Samples; i++) {
+        const double x = i % 2 == 0 ? wide(generator) : log_uniform(generator, 1.0e-8, 1.6e6);
+        trig.add(i % 4 == 3 ? -x : x, 0.0L);
+    }
+    for (const double s : trig_specials)
+        trig.add(s, 0.0L);
+    const int k = trig.x.size();
+    std::vector<T> cosines(k);
+    std::vector<Real> cosines_exact(k);
+    trig.y.resize(k);
+    finance::sincos_batch(trig.x.data(), trig.y.data(), cosines.data(), k);
+    for (int i = 0; i < k; i++) {
+        trig.exact[i] = std::sin(Real(trig.x[i]));
+        cosines_exact[i] = std::cos(Real(trig.x[i]));
+    }
+    Check sin_check = { "sin", bench::type_name<T>(), bound<T>(1.0), 0.0L, 0.0 };
+    record(sin_check, trig.x.data(), trig.y.data(), trig.exact.data(), k);
+    checks.push_back(sin_check);
+    Check cos_check = { "cos", bench::type_name<T>(), bound<T>(1.0), 0.0L, 0.0 };
+    record(cos_check, trig.x.data(), cosines.data(), cosines_exact.data(), k);
+    checks.push_back(cos_check);
+}
+
+}
+
+bool bench::accuracy_report(std::ostream& os)
+{
+    const finance::Isa restore = finance::active_isa();
+    const finance::Isa levels[] = { finance::Isa::Generic, finance::Isa::Avx2, finance::Isa::Avx512 };
+    bool within = true;
+    os << "{\n  \"accuracy\": [";
+    bool first = true;
+    for (const finance::Isa isa : levels) {
+        if (not finance::set_isa(isa))
+            continue;
+        std::mt19937_64 generator(42);
+        std::vector<Check> checks;
+        check_type<double>(generator, checks);
+        check_type<float>(generator, checks);
+        for (const Check& c : checks) {
+            const bool ok = c.max_ulp <= c.bound;
+            within = within and ok;
+            os << (first ? "\n" : ",\n")
+               << "    {\"isa\": \"" << finance::isa_name(isa) << "\", \"function\": \"" << c.function
+               << "\", \"type\": \"" << c.type << "\", \"max_ulp\": ";
+            if (std::isfinite(c.max_ulp))
+                os << static_cast<double>(c.max_ulp);
+            else
+                os << "null";
+            os << ", \"at\": ";
+            if (std::isfinite(c.at))
+                os << c.at;
+            else
+                os << "null";
+            os << ", \"bound\": " << c.bound << ", \"within\": " << (ok ? "true" : "false") << "}";
+            first = false;
+        }
+    }
+    os << "\n  ]\n}\n";
+    finance::set_isa(restore);
+    return within;
+}
@@ -0,0 +1,111 @@
+#include <benchmarks.hpp>
+
+#include <random>
+#include <vector>
+
+#include <date.hpp>
+#include <dated.hpp>
+
+
+namespace {
+
+const int NumDates = 4096;
+const int SeriesSizes[] = {256, 4096, 65536};
+const int NumQueries = 256;
+
+/**
+ * Returns the first \p n dates accepted by Date::valid() starting on 2000-01-01, in order.
+ */
+std::vector<Date> consecutive_dates(const int n)
+{
+    std::vector<Date> dates;
+    const std::size_t count = static_cast<std::size_t>(n);
+    dates.reserve(count);
+    for (int y = 2000; dates.size() < count; y++) {
+        for (int m = 1; m <= 12 and dates.size() < count; m++) {
+            for (int d = 1; d <= 31 and dates.size() < count; d++) {
+                const Date date(d, m, y);
+                if (date.valid())
+                    dates.push_back(date);
+            }
+        }
+    }
+    return dates;
+}
+
+template <class T>
+void run_dated(bench::Runner& runner)
+{
+    const char* type = bench::type_name<T>();
+    std::mt19937 generator(42);
+
+    for (const int n : SeriesSizes) {
+        const std::vector<Date> dates = consecutive_dates(n);
+        std::vector<T> values(n);
+        for (int i = 0; i < n; i++)
+            values[i] = static_cast<T>(100 + i % 17);
+        const Dated<T> series(dates, values);
+
+        std::uniform_int_distribution<int> index(0, n - 1);
+        std::vector<Date> queries;
+        for (int i = 0; i < NumQueries; i++)
+            queries.push_back(dates[index(generator)]);
+
+        runner.run("Dated::contains", type, n, NumQueries, [&] {
+            for (int i = 0; i < NumQueries; i++)
+                bench::do_not_optimize(series.contains(queries[i]));
+        });
+        runner.run("Dated::element_at", type, n, NumQueries, [&] {
+            for (int i = 0; i < NumQueries; i++)
+                bench::do_not_optimize(series.element_at(queries[i]));
+        });
+        runner.run("Dated::index_of_date", type, n, NumQueries, [&] {
+            for (int i = 0; i < NumQueries; i++)
+                bench::do_not_optimize(series.index_of_date(queries[i]));
+        });
+    }
+}
+
+}
+
+void bench::date_benchmarks(Runner& runner)
+{
+    std::mt19937 generator(7);
+    std::vector<Date> all = consecutive_dates(40 * 365);
+    std::uniform_int_distribution<int> index(0, static_cast<int>(all.size()) - 1);
+    // Date is not assignable: build the inputs with push_back.
+    std::vector<Date> lhs;
+    std::vector<Date> rhs;
+    for (int i = 0; i < NumDates; i++) {
+        lhs.push_back(all[index(generator)]);
+        rhs.push_back(all[index(generator)]);
+    }
+
+    runner.run("Date::operator<", "Date", NumDates, NumDates, [&] {
+        int count = 0;
+        for (int i = 0; i < NumDates; i++)
+            count += lhs[i] < rhs[i];
+        bench::do_not_optimize(count);
+    });
+    runner.run("Date::operator==", "Date", NumDates, NumDates, [&] {
+        int count = 0;
+        for (int i = 0; i < NumDates; i++)
+            count += lhs[i] == rhs[i];
+        bench::do_not_optimize(count);
+    });
+    runner.run("Date::operator++", "Date", NumDates, NumDates, [&] {
+        for (int i = 0; i < NumDates; i++) {
+            Date d = lhs[i];
+            bench::do_not_optimize(++d);
+        }
+    });
+    runner.run("Date::valid", "Date", NumDates, NumDates, [&] {
+        int count = 0;
+        for (int i = 0; i < NumDates; i++)
+            count += lhs[i].valid();
+        bench::do_not_optimize(count);
+    });
+
+    run_dated<float>(runner);
+    run_dated<double>(runner);
+}
@@ -0,0 +1,100 @@
+#include <benchmarks.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <batch_kernels.hpp>
+#include <random.hpp>
+
+
+namespace {
+
+const int Sizes[] = {256, 4096, 65536};
+const int Window = 20;
+
+}
+
+void bench::kernel_benchmarks(Runner& runner)
+{
+    const char* type = bench::type_name<double>();
+    std::mt19937_64 generator(42);
+
+    for (const int n : Sizes) {
+        std::vector<double> x(n);
+        std::vector<double> u(n);
+        std::vector<double> y(n);
+        std::vector<double> v(n);
+        std::uniform_real_distribution<double> exponent(-20.0, 20.0);
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (int i = 0; i < n; i++) {
+            x[i] = exponent(generator);
+            u[i] = uniform(generator);
+        }
+
+        runner.run("std::exp", type, n, n, [&] {
+            for (int i = 0; i < n; i++)
+                y[i] = std::exp(x[i]);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("exp_batch", type, n, n, [&] {
+            finance::exp_batch(x.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("log_batch", type, n, n, [&] {
+            finance::log_batch(u.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("std::pow", type, n, n, [&] {
+            for (int i = 0; i < n; i++)
+                y[i] = std::pow(u[i], x[i]);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("pow_batch", type, n, n, [&] {
+            finance::pow_batch(u.data(), x.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("std::erfc", type, n, n, [&] {
+            for (int i = 0; i < n; i++)
+                y[i] = std::erfc(x[i]);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("erfc_batch", type, n, n, [&] {
+            finance::erfc_batch(x.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("normal_cdf_batch", type, n, n, [&] {
+            finance::normal_cdf_batch(x.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("normals_batch", type, n, n, [&] {
+            finance::normals_batch(u.data(), y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("rolling_moments", type, n, n - Window + 1, [&] {
+            finance::rolling_moments(u.data(), n, Window, y.data(), v.data());
+            bench::do_not_optimize(v[0]);
+        });
+        std::normal_distribution<double> normal;
+        runner.run("std::normal_distribution", type, n, n, [&] {
+            for (int i = 0; i < n; i++)
+                y[i] = normal(generator);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("uniform_batch", type, n, n, [&] {
+            finance::uniform_batch(finance::StreamId(42), 0, y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+        runner.run("normal_batch", type, n, n, [&] {
+            finance::normal_batch(finance::StreamId(42), 0, y.data(), n);
+            bench::do_not_optimize(y[n-1]);
+        });
+
+        std::vector<float> xf(x.begin(), x.end());
+        std::vector<float> yf(n);
+        runner.run("exp_batch", bench::type_name<float>(), n, n, [&] {
+            finance::exp_batch(xf.data(), yf.data(), n);
+            bench::do_not_optimize(yf[n-1]);
+        });
+    }
+}
@@ -0,0 +1,102 @@
+#include <accuracy.hpp>
+#include <benchmarks.hpp>
+#include <pricing.hpp>
+#include <scheduling.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+namespace {
+
+int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--filter <substring>] [--min-time <seconds>] [--output <file>] [--counters] [--latency] [--accuracy] [--pricing] [--scheduling]\n"
+              << "Runs the benchmarks and writes the results as JSON (to standard output by default).\n"
+              << "--counters adds the hardware events per operation the system lets us count.\n"
+              << "--latency adds latency percentiles from a second run timing operations one by one.\n"
+              << "--accuracy measures the error in ulp of the math kernels instead, exiting with 3 if one\n"
+              << "exceeds its documented bound.\n"
+              << "--pricing checks the pricing engines against calibration quotes and closed forms instead,\n"
+              << "exiting with 3 if one misses its tolerance.\n"
+              << "--scheduling counts the tasks parallel_for spawns on 2 to 16 threads instead, exiting\n"
+              << "with 3 if one is not proportional to the threads.\n";
+    return 1;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    std::string filter;
+    std::string output = "-";
+    double min_time = 0.2;
+    bool use_counters = false;
+    bool use_latency = false;
+    bool use_accuracy = false;
+    bool use_pricing = false;
+    bool use_scheduling = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--filter") == 0 and i + 1 < argc)
+            filter = argv[++i];
+        else if (std::strcmp(argv[i], "--min-time") == 0 and i + 1 < argc)
+            min_time = std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--output") == 0 and i + 1 < argc)
+            output = argv[++i];
+        else if (std::strcmp(argv[i], "--counters") == 0)
+            use_counters = true;
+        else if (std::strcmp(argv[i], "--latency") == 0)
+            use_latency = true;
+        else if (std::strcmp(argv[i], "--accuracy") == 0)
+            use_accuracy = true;
+        else if (std::strcmp(argv[i], "--pricing") == 0)
+            use_pricing = true;
+        else if (std::strcmp(argv[i], "--scheduling") == 0)
+            use_scheduling = true;
+        else
+            return usage(argv[0]);
+    }
+
+    if (use_accuracy or use_pricing or use_scheduling) {
+        std::ofstream file;
+        if (output != "-")
+            file.open(output.c_str());
+        std::ostream& os = output == "-" ? std::cout : file;
+        const bool within = use_accuracy ? bench::accuracy_report(os)
+                          : use_pricing ? bench::pricing_report(os)
+                          : bench::scheduling_report(os);
+        if (not os) {
+            std::cerr << "cannot write " << output << '\n';
+            return 2;
+        }
+        return within ? 0 : 3;
+    }
+
+    bench::Runner runner(min_time, filter);
+    finance::PerfCounters counters;
+    if (use_counters) {
+        if (counters.available())
+            runner.set_counters(&counters);
+        else
+            std::cerr << "hardware counters unavailable, reporting time only\n";
+    }
+    runner.set_latency(use_latency);
+    bench::present_value_benchmarks(runner);
+    bench::date_benchmarks(runner);
+    bench::kernel_benchmarks(runner);
+
+    if (output == "-") {
+        runner.write_json(std::cout);
+        return 0;
+    }
+    std::ofstream os(output.c_str());
+    runner.write_json(os);
+    if (not os) {
+        std::cerr << "cannot write " << output << '\n';
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include <benchmarks.hpp>
+
+#include <vector>
+
+#include <present_value.hpp>
+
+
+namespace {
+
+const int Sizes[] = {8, 64, 512, 4096, 32768};
+const int NumRates = 1024;
+
+/**
+ * A coupon bond bought at par: -100 at time 0, then a coupon every period and the principal
+ * with the last one. Its IRR is the coupon rate, inside the initial bracket.
+ */
+template <class T>
+void bond_flows(const int n, std::vector<T>& times, std::vector<T>& amounts)
+{
+    times.resize(n);
+    amounts.resize(n);
+    for (int t = 0; t < n; t++) {
+        times[t] = static_cast<T>(t);
+        amounts[t] = T(6);
+    }
+    amounts[0] = T(-100);
+    amounts[n-1] += T(100);
+}
+
+template <class T>
+void run(bench::Runner& runner)
+{
+    const char* type = bench::type_name<T>();
+    finance::PresentValue<T> pv;
+
+    for (const int n : Sizes) {
+        std::vector<T> times;
+        std::vector<T> amounts;
+        bond_flows(n, times, amounts);
+
+        runner.run("pv_discrete_cflow", type, n, n, [&] {
+            bench::do_not_optimize(pv.pv_discrete_cflow(times, amounts, T(0.05)));
+        });
+        runner.run("pv_continuous_cflow", type, n, n, [&] {
+            bench::do_not_optimize(pv.pv_continuous_cflow(times, amounts, T(0.05)));
+        });
+        runner.run("irr_discrete_cflow", type, n, n, [&] {
+            bench::do_not_optimize(pv.irr_discrete_cflow(times, amounts));
+        });
+        runner.run("unique_discrete_irr", type, n, n, [&] {
+            bench::do_not_optimize(pv.unique_discrete_irr(times, amounts));
+        });
+    }
+
+    // The closed forms cost a few operations each: time them over a batch of rates.
+    std::vector<T> rates(NumRates);
+    for (int i = 0; i < NumRates; i++)
+        rates[i] = T(0.01) + T(0.1) * i / NumRates;
+
+    runner.run("pv_perpetuity", type, NumRates, NumRates, [&] {
+        for (int i = 0; i < NumRates; i++)
+            bench::do_not_optimize(pv.pv_perpetuity(T(100), rates[i]));
+    });
+    runner.run("pv_growing_perpetuity", type, NumRates, NumRates, [&] {
+        for (int i = 0; i < NumRates; i++)
+            bench::do_not_optimize(pv.pv_growing_perpetuity(T(100), rates[i] + T(0.02), T(0.02)));
+    });
+    runner.run("pv_annuity", type, NumRates, NumRates, [&] {
+        for (int i = 0; i < NumRates; i++)
+            bench::do_not_optimize(pv.pv_annuity(T(100), T(30), rates[i]));
+    });
+    runner.run("pv_growing_annuity", type, NumRates, NumRates, [&] {
+        for (int i = 0; i < NumRates; i++)
+            bench::do_not_optimize(pv.pv_growing_annuity(T(100), T(30), rates[i] + T(0.02), T(0.02)));
+    });
+}
+
+}
+
+void bench::present_value_benchmarks(Runner& runner)
+{
+    run<float>(runner);
+    run<double>(runner);
+}
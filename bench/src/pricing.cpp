@@ -0,0 +1,258 @@
+#include <pricing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <black_scholes.hpp>
+#include <carr_madan.hpp>
+#include <credit_default_swap.hpp>
+#include <hull_white.hpp>
+#include <monte_carlo.hpp>
+#include <path_payoffs.hpp>
+
+
+namespace {
+
+struct Check
+{
+    std::string name;
+    double tolerance;
+    double error;
+};
+
+/**
+ * Relative error of \p value, measured against \p exact but never against less than \p scale.
+ */
+double relative_error(const double value, const double exact, const double scale = 1e-12)
+{
+    return std::fabs(value - exact) / std::max(std::fabs(exact), scale);
+}
+
+/**
+ * A curve bootstrapped from par spreads reprices each quoted CDS at its par spread, and a
+ * contract at its par spread is worth nothing.
+ */
+void check_cds(std::vector<Check>& checks)
+{
+    const std::vector<double> tenors = {0.5, 1.0, 3.0, 5.0, 7.0, 10.0};
+    const std::vector<double> spreads = {0.0040, 0.0055, 0.0090, 0.0120, 0.0135, 0.0150};
+    const double recovery = 0.4;
+    const double r = 0.03;
+    finance::CdsBootstrapper<double> bootstrapper(tenors, recovery, r);
+    bootstrapper.bootstrap(spreads);
+
+    Check reprice = {"cds par spread repriced", 1e-10, 0.0};
+    Check value = {"cds value at par, per unit notional", 1e-12, 0.0};
+    std::vector<double> buffer;
+    for (std::size_t i = 0; i < tenors.size(); i++) {
+        const finance::CreditDefaultSwap<double> cds(tenors[i], recovery);
+        const finance::HazardCurve<double>& curve = bootstrapper.get_curve();
+        reprice.error = std::max(reprice.error, relative_error(cds.par_spread(curve, r, &buffer), spreads[i]));
+        value.error = std::max(value.error, std::fabs(cds.value(curve, r, spreads[i])));
+    }
+    checks.push_back(reprice);
+    checks.push_back(value);
+}
+
+/**
+ * A Hull-White tree reprices the zero coupon bonds of its input curve, and a swaption exercised
+ * with certainty is worth its forward starting swap.
+ */
+void check_hull_white(std::vector<Check>& checks)
+{
+    const std::vector<double> curve_times = {0.5, 1.0, 2.0, 5.0, 10.0};
+    const std::vector<double> zero_rates = {0.030, 0.032, 0.035, 0.040, 0.042};
+    const finance::HullWhiteTree<double> tree(curve_times, zero_rates, 0.1, 0.003, 10.0, 1000);
+
+    Check zeros = {"hull-white zero coupon bonds repriced", 1e-12, 0.0};
+    for (int year = 1; year <= 10; year++) {
+        const std::vector<double> time(1, year);
+        const finance::CallableBond<double> bond(time, std::vector<double>(1, 0.0), 1.0,
+                                                 std::vector<double>(), std::vector<double>());
+        zeros.error = std::max(zeros.error, relative_error(bond.price(tree), tree.discount_factor(year)));
+    }
+    checks.push_back(zeros);
+
+    // Paying 1% against forward rates near 4% at a low volatility is in the money on every node
+    // with weight, so the option is the swap: D(1) - 1% * (P(2) + ... + P(5)) - P(5), the first
+    // coupon accruing from the start at 1 and not from today.
+    const std::vector<double> payments = {2.0, 3.0, 4.0, 5.0};
+    const double rate = 0.01;
+    const finance::BermudanSwaption<double> swaption(payments, 1.0, rate, std::vector<double>(1, 1.0), 1.0, true);
+    double swap = tree.discount_factor(1.0) - tree.discount_factor(5.0);
+    for (const double t : payments)
+        swap -= rate * tree.discount_factor(t);
+    const Check forward = {"hull-white forward start swaption exercised with certainty", 1e-9,
+                           relative_error(swaption.price(tree), swap)};
+    checks.push_back(forward);
+}
+
+
+/**
+ * Carr-Madan under the geometric Brownian model is the Black-Scholes formula: on the grid, and
+ * interpolated at quoted strikes. Errors are in units of the spot, as prices far out of the
+ * money are below the accuracy of the transform.
+ */
+void check_carr_madan(std::vector<Check>& checks)
+{
+    const double spot = 100.0;
+    const double r = 0.03;
+    const double q = 0.01;
+    const double sigma = 0.2;
+    const finance::CarrMadanPricer<double> pricer;
+    const finance::GeometricBrownianModel<double> model(sigma);
+    const finance::BlackScholes<double> black_scholes;
+
+    Check grid = {"carr-madan gbm grid against black-scholes", 1e-8, 0.0};
+    Check quoted = {"carr-madan gbm quoted strikes against black-scholes", 1e-7, 0.0};
+    const double expiries[] = {0.25, 1.0, 5.0};
+    for (const double t : expiries) {
+        std::vector<double> strikes;
+        std::vector<double> calls;
+        pricer.price_grid(model, spot, r, q, t, strikes, calls);
+        for (std::size_t u = 0; u < strikes.size(); u++)
+            if (strikes[u] > 0.5 * spot and strikes[u] < 2.0 * spot)
+                grid.error = std::max(grid.error, std::fabs(calls[u] - black_scholes.call(spot, strikes[u], r, q, sigma, t)) / spot);
+
+        const std::vector<double> quotes = {60.0, 80.0, 95.0, 100.0, 105.0, 120.0, 150.0};
+        pricer.price_strikes(model, spot, r, q, t, quotes, calls);
+        for (std::size_t i = 0; i < quotes.size(); i++)
+            quoted.error = std::max(quoted.error, std::fabs(calls[i] - black_scholes.call(spot, quotes[i], r, q, sigma, t)) / spot);
+    }
+    checks.push_back(grid);
+    checks.push_back(quoted);
+}
+
+
+/**
+ * Down-and-out call with the strike above the barrier, continuously monitored: the vanilla call
+ * less the down-and-in call of Reiner and Rubinstein (1991).
+ */
+double down_and_out_call(const double spot, const double strike, const double barrier,
+                         const double r, const double q, const double sigma, const double t)
+{
+    const finance::BlackScholes<double> black_scholes;
+    const double sd = sigma * std::sqrt(t);
+    const double lambda = (r - q + 0.5 * sigma * sigma) / (sigma * sigma);
+    const double y = std::log(barrier * barrier / (spot * strike)) / sd + lambda * sd;
+    const double ratio = barrier / spot;
+    const double down_and_in = spot * std::exp(-q * t) * std::pow(ratio, 2 * lambda) * black_scholes.normal_cdf(y)
+                             - strike * std::exp(-r * t) * std::pow(ratio, 2 * lambda - 2) * black_scholes.normal_cdf(y - sd);
+    return black_scholes.call(spot, strike, r, q, sigma, t) - down_and_in;
+}
+
+/**
+ * The Monte Carlo barrier option with the Brownian bridge correction matches the continuously
+ * monitored closed form within a few standard errors on a coarse grid of dates, and knock-in
+ * plus knock-out is the vanilla call path by path.
+ */
+void check_monte_carlo(std::vector<Check>& checks)
+{
+    const double spot = 100.0;
+    const double strike = 100.0;
+    const double barrier = 90.0;
+    const double r = 0.03;
+    const double q = 0.01;
+    const double sigma = 0.25;
+    const double t = 1.0;
+    const int num_paths = 1 << 18;
+    const finance::MonteCarloEngine<double> engine(spot, r, q, sigma, t, 12);
+
+    const finance::MonteCarloResult<double> out =
+        engine.price(finance::BarrierOption<double>(strike, barrier, true, false, false), num_paths);
+    const double exact = down_and_out_call(spot, strike, barrier, r, q, sigma, t);
+    const Check analytic = {"monte carlo down-and-out call against closed form, in standard errors", 4.0,
+                            std::fabs(out.price - exact) / out.standard_error};
+    checks.push_back(analytic);
+
+    const finance::MonteCarloResult<double> in =
+        engine.price(finance::BarrierOption<double>(strike, barrier, true, false, true), num_paths);
+    const finance::MonteCarloResult<double> vanilla =
+        engine.price(finance::BarrierOption<double>(strike, 0.0, true, false, false, false), num_paths);
+    const Check parity = {"monte carlo knock-in plus knock-out is the vanilla call", 1e-12,
+                          relative_error(in.price + out.price, vanilla.price)};
+    checks.push_back(parity);
+}
+
+
+/**
+ * SVI calibration recovers the parameters of a slice from its own total variances, the surface
+ * cache follows its slices, and the batch chain pricer matches the scalar formula.
+ */
+void check_volatility_surface(std::vector<Check>& checks)
+{
+    const finance::SviSlice<double> known(1.0, 0.02, 0.1, -0.4, 0.05, 0.2);
+    std::vector<double> k;
+    std::vector<double> w;
+    for (int i = -10; i <= 10; i++) {
+        k.push_back(0.1 * i);
+        w.push_back(known.total_variance(k.back()));
+    }
+    const finance::SviSlice<double> fitted = finance::SviSlice<double>::calibrate(1.0, k, w);
+    const double parameters[][2] = {{fitted.get_a(), known.get_a()}, {fitted.get_b(), known.get_b()},
+                                    {fitted.get_rho(), known.get_rho()}, {fitted.get_m(), known.get_m()},
+                                    {fitted.get_s(), known.get_s()}};
+    // The search stops on the spread of the squared errors, which pins the parameters down to
+    // about the square root of its tolerance.
+    Check svi = {"svi calibration recovers its parameters", 1e-4, 0.0};
+    for (const auto& p : parameters)
+        svi.error = std::max(svi.error, relative_error(p[0], p[1]));
+    checks.push_back(svi);
+
+    // A lookup repeated, then one after a slice is added: the cache must give what a chain
+    // lookup computes from the current slices.
+    finance::VolatilitySurface<double> surface(100.0, 0.03, 0.01);
+    surface.add_slice(finance::SviSlice<double>(0.5, 0.01, 0.1, -0.4, 0.0, 0.2));
+    surface.add_slice(known);
+    const std::vector<double> strikes = {70.0, 85.0, 100.0, 115.0, 130.0};
+    Check cache = {"volatility surface cached lookups against chain lookups", 0.0, 0.0};
+    for (int pass = 0; pass < 2; pass++) {
+        for (const double t : {0.25, 0.75, 0.75, 2.0}) {
+            std::vector<double> chain;
+            surface.volatilities(t, strikes, chain);
+            for (std::size_t i = 0; i < strikes.size(); i++)
+                for (int repeat = 0; repeat < 2; repeat++)
+                    cache.error = std::max(cache.error, std::fabs(surface.volatility(strikes[i], t) - chain[i]));
+        }
+        surface.add_slice(finance::SviSlice<double>(0.7, 0.015, 0.12, -0.3, 0.02, 0.25));
+    }
+    checks.push_back(cache);
+
+    const finance::BlackScholes<double> black_scholes;
+    std::vector<double> prices;
+    black_scholes.call_prices(surface, 0.75, strikes, prices);
+    Check chain = {"black-scholes batch chain against single calls", 1e-13, 0.0};
+    for (std::size_t i = 0; i < strikes.size(); i++) {
+        const double single = black_scholes.call(100.0, strikes[i], 0.03, 0.01, surface.volatility(strikes[i], 0.75), 0.75);
+        chain.error = std::max(chain.error, relative_error(prices[i], single));
+    }
+    checks.push_back(chain);
+}
+
+}
+
+bool bench::pricing_report(std::ostream& os)
+{
+    std::vector<Check> checks;
+    check_cds(checks);
+    check_hull_white(checks);
+    check_carr_madan(checks);
+    check_monte_carlo(checks);
+    check_volatility_surface(checks);
+
+    bool within = true;
+    bool first = true;
+    os << "{\n  \"pricing\": [";
+    for (const Check& c : checks) {
+        const bool ok = c.error <= c.tolerance;
+        within = within and ok;
+        os << (first ? "\n" : ",\n")
+           << "    {\"check\": \"" << c.name << "\", \"error\": " << c.error
+           << ", \"tolerance\": " << c.tolerance << ", \"within\": " << (ok ? "true" : "false") << "}";
+        first = false;
+    }
+    os << "\n  ]\n}\n";
+    return within;
+}
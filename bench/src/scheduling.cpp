@@ -0,0 +1,47 @@
+#include <scheduling.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <parallel.hpp>
+
+
+namespace {
+
+const int Size = 100000;
+const int Repetitions = 5;
+const int TasksPerThread = 16;
+
+}
+
+bool bench::scheduling_report(std::ostream& os)
+{
+    std::vector<double> out(Size);
+    bool within = true;
+    bool first = true;
+    os << "{\n  \"scheduling\": [";
+    for (int threads = 2; threads <= 16; threads *= 2) {
+        finance::TaskScheduler scheduler(threads - 1);
+        long long most = 0;
+        for (int r = 0; r < Repetitions; r++) {
+            finance::TaskGroup group(scheduler);
+            const long long before = scheduler.get_spawned();
+            finance::parallel_for(0, Size, [&out](const int i) {
+                double x = i;
+                for (int k = 0; k < 50; k++)
+                    x = std::sqrt(x + k);
+                out[i] = x;
+            }, group);
+            most = std::max(most, scheduler.get_spawned() - before);
+        }
+        const long long bound = static_cast<long long>(TasksPerThread) * threads;
+        within = within and most <= bound;
+        os << (first ? "\n" : ",\n")
+           << "    {\"threads\": " << threads << ", \"size\": " << Size << ", \"max_tasks\": " << most
+           << ", \"bound\": " << bound << ", \"within\": " << (most <= bound ? "true" : "false") << "}";
+        first = false;
+    }
+    os << "\n  ]\n}\n";
+    return within;
+}
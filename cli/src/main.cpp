@@ -0,0 +1,241 @@
+#include "valuation_job.hpp"
+#include "allocation_tracker.hpp"
+#include "event_log.hpp"
+#include "latency_histogram.hpp"
+#include "parallel.hpp"
+#include "perf_counters.hpp"
+#include "reproducible_sum.hpp"
+#include "solver_statistics.hpp"
+#include "trace.hpp"
+
+#include <cmath>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " [--counters] [--allocations] [--solver-stats] [--latency] [--total]\n"
+              << "       [--trace <file>] [--event-log <file>] <input> <output>\n"
+              << "  Values every cash flow stream of <input> and writes the results to <output>.\n"
+              << "  Use '-' for standard input or standard output. Jobs are valued on every core, or on\n"
+              << "  FINANCE_NUM_THREADS threads if that variable is set.\n"
+              << "  --counters reports the hardware events of each phase per job on standard error.\n"
+              << "  --allocations reports the heap allocations of each phase per job on standard error\n"
+              << "  (needs a build with CONFIG += allocation_tracking). Both value the jobs on one thread.\n"
+              << "  --solver-stats reports the IRR solver iterations, evaluations, bracket widths and\n"
+              << "  failures of the batch on standard error.\n"
+              << "  --latency reports percentile tables of the job valuation latency on standard error.\n"
+              << "  --total reports the sum of the present values on standard error, bitwise identical\n"
+              << "  whatever the number of threads.\n"
+              << "  --trace writes a trace of the run, as Chrome JSON if <file> ends in .json and\n"
+              << "  as a Perfetto protobuf trace otherwise (needs a build with CONFIG += tracing).\n"
+              << "  --event-log records every job result in a binary log for stock-market-log-decoder.\n";
+    return 1;
+}
+
+/**
+ * Stops \p counters and reports the events of \p phase per job, if counting.
+ */
+void report_phase(finance::PerfCounters* counters, const char* phase, const std::size_t num_jobs)
+{
+    if (counters == nullptr)
+        return;
+    counters->stop();
+    const double jobs = num_jobs > 0 ? static_cast<double>(num_jobs) : 1.0;
+    std::cerr << phase << ':';
+    for (int e = 0; e < finance::PerfCounters::NumEvents; e++) {
+        const finance::PerfCounters::Event event = static_cast<finance::PerfCounters::Event>(e);
+        if (not std::isnan(counters->value(event)))
+            std::cerr << ' ' << finance::PerfCounters::name(event) << "_per_job=" << counters->value(event) / jobs;
+    }
+    const double cycles = counters->value(finance::PerfCounters::Cycles);
+    const double instructions = counters->value(finance::PerfCounters::Instructions);
+    if (cycles > 0.0 and not std::isnan(instructions))
+        std::cerr << " ipc=" << instructions / cycles;
+    std::cerr << "\n";
+}
+
+/**
+ * Reports the allocations counted by \p allocations for \p phase, per job.
+ */
+void report_allocations(const finance::AllocationScope& allocations, const char* phase, const std::size_t num_jobs)
+{
+    const double jobs = num_jobs > 0 ? static_cast<double>(num_jobs) : 1.0;
+    const finance::AllocationCounts c = allocations.counts();
+    std::cerr << phase << ": allocations_per_job=" << c.allocations / jobs
+              << " bytes_per_job=" << c.bytes / jobs << "\n";
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    bool use_counters = false;
+    bool use_allocations = false;
+    bool solver_stats = false;
+    bool latency = false;
+    bool total = false;
+    std::string trace_file;
+    std::string event_log;
+    int arg = 1;
+    for (; arg < argc - 2; arg++) {
+        if (std::strcmp(argv[arg], "--counters") == 0)
+            use_counters = true;
+        else if (std::strcmp(argv[arg], "--allocations") == 0)
+            use_allocations = true;
+        else if (std::strcmp(argv[arg], "--solver-stats") == 0)
+            solver_stats = true;
+        else if (std::strcmp(argv[arg], "--latency") == 0)
+            latency = true;
+        else if (std::strcmp(argv[arg], "--total") == 0)
+            total = true;
+        else if (std::strcmp(argv[arg], "--trace") == 0 and arg + 1 < argc - 2)
+            trace_file = argv[++arg];
+        else if (std::strcmp(argv[arg], "--event-log") == 0 and arg + 1 < argc - 2)
+            event_log = argv[++arg];
+        else
+            return usage(argv[0]);
+    }
+    if (arg != argc - 2)
+        return usage(argv[0]);
+
+    const std::string input  = argv[argc - 2];
+    const std::string output = argv[argc - 1];
+    finance::trace_enable(not trace_file.empty());
+    finance::latency_enable(latency);
+    if (not event_log.empty() and not finance::event_log_open(event_log)) {
+        std::cerr << "cannot open " << event_log << "\n";
+        return 2;
+    }
+
+    finance::PerfCounters perf;
+    finance::PerfCounters* counters = nullptr;
+    if (use_counters) {
+        if (perf.available())
+            counters = &perf;
+        else
+            std::cerr << "hardware counters unavailable\n";
+    }
+
+    if (use_allocations and not finance::allocation_tracking_enabled()) {
+        std::cerr << "allocation tracking not compiled in\n";
+        use_allocations = false;
+    }
+
+    std::vector<finance::ValuationJob> jobs;
+    finance::AllocationScope allocations;
+    if (counters != nullptr)
+        counters->start();
+    allocations.reset();
+    try {
+        FINANCE_TRACE_SCOPE("load");
+        if (input == "-") {
+            jobs = finance::read_valuation_jobs(std::cin);
+        } else {
+            std::ifstream is(input);
+            if (not is) {
+                std::cerr << "cannot open " << input << "\n";
+                return 2;
+            }
+            jobs = finance::read_valuation_jobs(is);
+        }
+    } catch (const std::invalid_argument& e) {
+        std::cerr << input << ": " << e.what() << "\n";
+        return 2;
+    }
+    report_phase(counters, "load", jobs.size());
+    if (use_allocations)
+        report_allocations(allocations, "load", jobs.size());
+
+    if (counters != nullptr)
+        counters->start();
+    allocations.reset();
+    std::vector<finance::ValuationResult> results(jobs.size());
+    {
+        FINANCE_TRACE_SCOPE("value");
+        auto value = [&](const int i) {
+            results[i] = finance::evaluate(jobs[i]);
+            const finance::ValuationResult& r = results[i];
+            FINANCE_LOG("job {} pv {} irr {} evaluations {}", r.name, r.present_value, r.irr,
+                        r.irr_statistics.function_evaluations);
+        };
+        // Counters and allocations are measured on this thread only: value serially then.
+        if (counters != nullptr or use_allocations) {
+            for (int i = 0; i < static_cast<int>(jobs.size()); i++)
+                value(i);
+        } else {
+            finance::parallel_for(0, static_cast<int>(jobs.size()), value);
+        }
+    }
+    report_phase(counters, "value", jobs.size());
+    if (use_allocations)
+        report_allocations(allocations, "value", jobs.size());
+
+    if (solver_stats) {
+        finance::SolverTelemetry telemetry;
+        for (const finance::ValuationResult& r : results)
+            telemetry.record(r.irr_statistics);
+        telemetry.write_report(std::cerr, "irr");
+    }
+    if (total) {
+        const double sum = finance::reproducible_sum(0, static_cast<int>(results.size()), [&](const int i) {
+            return results[i].present_value;
+        });
+        const std::streamsize precision = std::cerr.precision(17);
+        std::cerr << "total_present_value=" << sum << "\n";
+        std::cerr.precision(precision);
+    }
+    if (latency) {
+        finance::latency_enable(false);
+        finance::write_latency_report(std::cerr);
+    }
+
+    if (counters != nullptr)
+        counters->start();
+    allocations.reset();
+    bool written;
+    if (output == "-") {
+        FINANCE_TRACE_SCOPE("write");
+        finance::write_valuation_results(std::cout, results);
+        std::cout.flush();
+        written = static_cast<bool>(std::cout);
+    } else {
+        FINANCE_TRACE_SCOPE("write");
+        std::ofstream os(output);
+        if (not os) {
+            std::cerr << "cannot open " << output << "\n";
+            return 2;
+        }
+        finance::write_valuation_results(os, results);
+        os.close();
+        written = static_cast<bool>(os);
+    }
+    report_phase(counters, "write", jobs.size());
+    if (use_allocations)
+        report_allocations(allocations, "write", jobs.size());
+
+    if (not event_log.empty() and not finance::event_log_close()) {
+        std::cerr << "cannot write " << event_log << "\n";
+        return 2;
+    }
+
+    if (not trace_file.empty()) {
+        finance::trace_enable(false);
+        const bool json = trace_file.size() >= 5 and trace_file.compare(trace_file.size() - 5, 5, ".json") == 0;
+        std::ofstream ts(trace_file, std::ios::binary);
+        if (json)
+            finance::write_chrome_trace(ts);
+        else
+            finance::write_perfetto_trace(ts);
+        if (not ts) {
+            std::cerr << "cannot write " << trace_file << "\n";
+            return 2;
+        }
+    }
+    return written ? 0 : 2;
+}
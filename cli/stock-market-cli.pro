@@ -0,0 +1,45 @@
+# Headless batch valuation: no Qt modules are linked.
+
+QT      -= core gui
+
+TARGET   = stock-market-cli
+TEMPLATE = app
+CONFIG  += console c++11 thread
+CONFIG  -= qt app_bundle
+
+# qmake CONFIG+=tracing compiles in the FINANCE_TRACE_SCOPE trace points.
+tracing: DEFINES += FINANCE_TRACING
+
+# The batch kernels are loops the compiler vectorizes for each instruction set level.
+gcc|clang: QMAKE_CXXFLAGS += -fopenmp-simd -fno-trapping-math -fno-math-errno
+
+# qmake CONFIG+=allocation_tracking counts the heap allocations of each thread.
+allocation_tracking: DEFINES += FINANCE_ALLOCATION_TRACKING
+
+INCLUDEPATH += ../include
+
+SOURCES += src/main.cpp \
+           ../src/valuation_job.cpp \
+           ../src/perf_counters.cpp \
+           ../src/allocation_tracker.cpp \
+           ../src/event_log.cpp \
+           ../src/batch_kernels.cpp \
+           ../src/cpu_dispatch.cpp \
+           ../src/latency_histogram.cpp \
+           ../src/task_scheduler.cpp \
+           ../src/trace.cpp
+
+HEADERS += ../include/present_value.hpp \
+           ../include/allocation_tracker.hpp \
+           ../include/event_log.hpp \
+           ../include/batch_kernels.hpp \
+           ../include/vector_math.hpp \
+           ../include/cpu_dispatch.hpp \
+           ../include/latency_histogram.hpp \
+           ../include/parallel.hpp \
+           ../include/reproducible_sum.hpp \
+           ../include/task_scheduler.hpp \
+           ../include/solver_statistics.hpp \
+           ../include/valuation_job.hpp \
+           ../include/perf_counters.hpp \
+           ../include/trace.hpp
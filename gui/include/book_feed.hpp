@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include <bounded_queue.hpp>
+#include <depth_book.hpp>
+#include <market_update.hpp>
+
+
+/**
+ * \brief The BookFeed class maintains the order book of one instrument from a queue of
+ *        finance::BookDelta messages.
+ *
+ * \par
+ *      Once per frame (16 ms) the queue is drained on the GUI thread and every delta is applied
+ *      to the book, so the book is always current whatever the message rate. frame() is then
+ *      emitted once with the range of ticks that changed during the frame, which is all the
+ *      views need to redraw incrementally.
+ * \par
+ *      A gap in the sequence numbers of the deltas means one was lost, typically because the
+ *      queue was full. The book is then cleared, snapshot_requested() is emitted and deltas
+ *      are ignored until the snapshot the producer sends in reply starts with a reset delta,
+ *      so levels whose removal was lost never linger.
+ */
+class BookFeed : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * \param min_price     Price of the lowest tick of the book.
+     * \param tick_size     Tick size.
+     * \param num_ticks     Number of ticks of the book.
+     */
+    BookFeed(double min_price, double tick_size, int num_ticks, QObject *parent = 0);
+
+    /**
+     * \brief Reads the deltas of \p instrument from \p queue, which must outlive the feed.
+     *        Null unsubscribes. The book is cleared and rebuilt from the next snapshot.
+     */
+    void subscribe(finance::BoundedQueue<finance::BookDelta> *queue, int instrument);
+
+    const finance::DepthBook<double>& get_book() const;
+
+signals:
+    /**
+     * \brief Emitted every frame. \p first_tick > \p last_tick if the book did not change.
+     */
+    void frame(int first_tick, int last_tick);
+
+    /**
+     * \brief Emitted when the book of \p instrument must be resent as a snapshot, once per gap.
+     */
+    void snapshot_requested(int instrument);
+
+private slots:
+    void drain();
+
+private:
+    void lose_sync();
+
+    finance::BoundedQueue<finance::BookDelta> *queue;
+    int instrument;
+    bool synchronized;
+    bool requested;
+    unsigned long long next_sequence;
+    finance::DepthBook<double> book;
+    QTimer frame_timer;
+};
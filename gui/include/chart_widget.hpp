@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QImage>
+#include <QWidget>
+
+#include <dated.hpp>
+#include <min_max_pyramid.hpp>
+
+
+/**
+ * \brief The ChartWidget class plots a Dated<double> series of any length.
+ *
+ * \par Level of detail.
+ *      Every pixel column covers a range of samples and is drawn as one vertical segment from
+ *      the minimum to the maximum of that range, read from a finance::MinMaxPyramid. A frame
+ *      therefore draws at most two points per column whatever the zoom level, and building it
+ *      costs \f$ O(W\log n) \f$ for a widget \f$ W \f$ pixels wide. When zoomed in past one sample
+ *      per column the samples are joined with lines instead.
+ * \par Dirty regions.
+ *      The plot is rendered with a raster QPainter into a cached image. Dragging scrolls the
+ *      cached image by whole pixels and renders only the newly exposed columns; zooming,
+ *      resizing or a new series render the whole image. The vertical scale is fixed while
+ *      dragging and fitted to the visible range when the drag ends.
+ */
+class ChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ChartWidget(QWidget *parent = 0);
+
+    void set_series(Dated<double> series);
+    const Dated<double>& get_series() const;
+
+public slots:
+    void reset_zoom();
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+    void mousePressEvent(QMouseEvent *event);
+    void mouseMoveEvent(QMouseEvent *event);
+    void mouseReleaseEvent(QMouseEvent *event);
+    void wheelEvent(QWheelEvent *event);
+
+private:
+    double samples_per_column() const;
+    void fit_vertical_range();
+    void render_all();
+    void render_columns(QImage& image, int first_column, int last_column) const;
+    void scroll_by(int dx);
+    int to_y(double value) const;
+
+    Dated<double> series;
+    finance::MinMaxPyramid<double> pyramid;
+
+    double view_first;
+    double view_last;
+    double y_min;
+    double y_max;
+
+    QImage cache;
+    bool dragging;
+    int drag_x;
+};
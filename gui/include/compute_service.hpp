@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <task_scheduler.hpp>
+#include <valuation_job.hpp>
+
+
+/**
+ * \brief The ComputeService class runs valuation batches on the shared finance::TaskScheduler
+ *        and reports back to the GUI thread.
+ *
+ * \par
+ *      submit_valuations() returns immediately: a task of the service runs the batch with
+ *      finance::parallel_for() in chunks of jobs, on the same threads as the pricing engines.
+ *      Each chunk posts its range of indices to the GUI thread with a queued call, but results
+ *      are not delivered one by one: the indices that became ready are collected and flushed
+ *      together through results_ready() at most once per frame (16 ms), so a batch of millions
+ *      of jobs costs a bounded number of UI updates per second. Submitting a new batch cancels
+ *      the one still running without waiting for it: its chunks stop at the next job and its
+ *      queued calls carry a serial number that is no longer current, so none of its results or
+ *      signals reach the GUI.
+ */
+class ComputeService : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ComputeService(QObject *parent = 0);
+    ~ComputeService();
+
+    void submit_valuations(const QVector<finance::ValuationJob>& jobs);
+
+    bool is_running() const;
+
+public slots:
+    void cancel();
+
+signals:
+    void progress_changed(int done, int total);
+    void results_ready(const QVector<int>& indices, const QVector<finance::ValuationResult>& results);
+    void finished();
+    void cancelled();
+
+private slots:
+    void on_results_ready_at(int serial, int begin, int end);
+    void on_finished(int serial);
+    void flush();
+
+private:
+    // Jobs and results of one submitted batch, shared with the task that runs it.
+    struct Batch
+    {
+        int serial;
+        std::vector<finance::ValuationJob> jobs;
+        std::vector<finance::ValuationResult> results;
+        std::atomic<int> done;
+        finance::TaskGroup chunks;
+    };
+
+    void run(Batch& b);
+
+    std::shared_ptr<Batch> batch;
+    int serial;
+    QTimer flush_timer;
+    QVector<int> pending;
+    finance::TaskGroup tasks;
+};
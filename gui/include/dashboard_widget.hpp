@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QStringList>
+#include <QTimer>
+#include <QWidget>
+
+#include <vector>
+
+#include <bounded_queue.hpp>
+#include <market_update.hpp>
+
+
+/**
+ * \brief The DashboardWidget class shows the live state of every instrument.
+ *
+ * \par Update coalescing.
+ *      Engines push finance::InstrumentUpdate messages into a lock-free queue at any rate.
+ *      Once per frame the widget drains the queue and keeps only the latest state of each
+ *      instrument, so a thousand updates of one instrument within a frame cost one repaint.
+ * \par Throttled repaint.
+ *      Only cells whose displayed value changed are invalidated, and paintEvent() draws only
+ *      the rows inside the invalidated region. The queue is drained while the widget is
+ *      subscribed, hidden or not, but cells are invalidated only while it is visible.
+ *      Painting cost is bounded by the refresh rate and the number of visible cells, not by
+ *      the message rate.
+ */
+class DashboardWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Column { Instrument, Bid, Ask, Last, Position, Pnl, ColumnCount };
+
+    explicit DashboardWidget(QWidget *parent = 0);
+
+    /**
+     * \brief Reads updates from \p queue, which must outlive the widget. Null unsubscribes.
+     *
+     * Updates for instrument ids outside [0, 65536) are dropped.
+     */
+    void subscribe(finance::BoundedQueue<finance::InstrumentUpdate> *queue);
+
+    void set_instrument_names(const QStringList& names);
+
+    QSize sizeHint() const;
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private slots:
+    void drain();
+
+private:
+    void ensure_rows(int rows);
+    QRect cell_rect(int row, int column) const;
+    QString cell_text(int row, int column) const;
+    double cell_value(const finance::InstrumentUpdate& u, int column) const;
+
+    finance::BoundedQueue<finance::InstrumentUpdate> *queue;
+    QStringList names;
+    std::vector<finance::InstrumentUpdate> displayed;
+    std::vector<int> direction;
+    std::vector<char> dirty;
+    std::vector<int> dirty_cells;
+    QTimer frame_timer;
+    int row_height;
+    int column_width;
+};
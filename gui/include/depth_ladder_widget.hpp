@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QWidget>
+
+class BookFeed;
+
+
+/**
+ * \brief The DepthLadderWidget class shows the price levels around the inside of an order book,
+ *        one row per tick, bids on the left and asks on the right.
+ *
+ * \par
+ *      The ladder is centred on the mid price and only recentred when the mid leaves the middle
+ *      half of the visible ticks. In between, each frame invalidates only the rows of the ticks
+ *      that changed during the frame, and paintEvent() draws only the rows inside the
+ *      invalidated region.
+ */
+class DepthLadderWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit DepthLadderWidget(QWidget *parent = 0);
+
+    /**
+     * \brief Shows the book of \p feed, which must outlive the widget.
+     */
+    void set_feed(BookFeed *feed);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+
+private slots:
+    void on_frame(int first_tick, int last_tick);
+
+private:
+    int visible_rows() const;
+    int row_of(int tick) const;
+    bool recenter();
+
+    BookFeed *feed;
+    int top_tick;
+    double scale;
+    int row_height;
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QAbstractTableModel>
+
+#include <vector>
+
+#include <table_source.hpp>
+
+
+/**
+ * \brief The LazyTableModel class adapts a TableSource to Qt item views without copying it.
+ *
+ * \par
+ *      Cells are read and formatted in data(), so only the rows a view actually shows are
+ *      ever touched and opening a table costs nothing whatever its size. Sorting computes a
+ *      permutation of row indices and leaves the source untouched; data() reads through it.
+ */
+class LazyTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit LazyTableModel(QObject *parent = 0);
+
+    /**
+     * \brief Shows \p source, which must outlive the model or be replaced first. Null clears.
+     */
+    void set_source(const TableSource *source);
+
+    /**
+     * \brief Tells views the source rows \p begin ... \p end - 1 changed without changing its shape.
+     */
+    void refresh(int begin, int end);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+private:
+    int source_row(int row) const;
+
+    const TableSource *source;
+    std::vector<int> permutation;
+    std::vector<int> inverse;
+};
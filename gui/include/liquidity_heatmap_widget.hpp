@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QImage>
+#include <QVector>
+#include <QWidget>
+
+class BookFeed;
+
+
+/**
+ * \brief The LiquidityHeatmapWidget class plots the resting quantity of an order book against
+ *        time (horizontal) and price (vertical, one pixel row per tick).
+ *
+ * \par Ring buffer.
+ *      The history lives in an image used as a ring of pixel columns. Every frame writes only
+ *      the newest column, straight into the image memory through a colour lookup table, and
+ *      advances the ring. Painting blits the two halves of the ring in order, so the plot
+ *      scrolls without ever redrawing old columns. When the mid price drifts out of the middle
+ *      half of the window the image rows are moved in memory to recentre it.
+ * \par
+ *      The cost of a frame is one column of the book plus one blit of the widget, whatever the
+ *      message rate, so a busy symbol is followed at full rate on a plain raster backend.
+ */
+class LiquidityHeatmapWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit LiquidityHeatmapWidget(QWidget *parent = 0);
+
+    /**
+     * \brief Shows the book of \p feed, which must outlive the widget.
+     */
+    void set_feed(BookFeed *feed);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
+
+private slots:
+    void on_frame(int first_tick, int last_tick);
+
+private:
+    void recenter();
+    void fill_rows(int first, int last);
+    void write_column();
+
+    BookFeed *feed;
+    QImage history;
+    QVector<QRgb> bid_colors;
+    QVector<QRgb> ask_colors;
+    int head;
+    int top_tick;
+    double scale;
+};
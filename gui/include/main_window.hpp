@@ -2,6 +2,23 @@
 
 #include <ui_main_window.h>
 
+#include <QVector>
+
+#include <bounded_queue.hpp>
+#include <compute_service.hpp>
+#include <market_update.hpp>
+
+class QAction;
+class QTableView;
+class QTabWidget;
+class BookFeed;
+class ChartWidget;
+class DashboardWidget;
+class LazyTableModel;
+class ValuationResultSource;
+template <typename T> class DatedTableSource;
+class QProgressBar;
+
 
 class MainWindow : public QMainWindow, private Ui::MainWindow
 {
@@ -9,4 +26,54 @@ class MainWindow : public QMainWindow, private Ui::MainWindow
 
 public:
     explicit MainWindow(QWidget *parent = 0);
+    ~MainWindow();
+
+    /**
+     * \brief Queue the engines push live instrument updates into for the dashboard.
+     */
+    finance::BoundedQueue<finance::InstrumentUpdate>& market_updates();
+
+    /**
+     * \brief Queue the engines push order book deltas into for the depth ladder and heatmap.
+     */
+    finance::BoundedQueue<finance::BookDelta>& book_deltas();
+
+signals:
+    /**
+     * \brief Emitted when a delta of \p instrument was lost: its engine must push a snapshot
+     *        of the book into book_deltas().
+     */
+    void book_snapshot_requested(int instrument);
+
+private slots:
+    void open_jobs();
+    void open_history();
+    void show_dashboard();
+    void show_book();
+    void show_sweep();
+    void on_progress(int done, int total);
+    void on_results(const QVector<int>& indices, const QVector<finance::ValuationResult>& batch);
+    void on_finished();
+    void on_cancelled();
+
+private:
+    ComputeService compute;
+    QVector<finance::ValuationResult> results;
+    QProgressBar *progress;
+    finance::BoundedQueue<finance::InstrumentUpdate> updates;
+    finance::BoundedQueue<finance::BookDelta> deltas;
+    BookFeed *book_feed;
+    QTabWidget *tabs;
+    QWidget *dashboard_page;
+    QWidget *book_page;
+    QWidget *sweep_page;
+    ChartWidget *chart;
+    DashboardWidget *dashboard;
+    QTableView *table;
+    LazyTableModel *model;
+    ValuationResultSource *result_source;
+    QTableView *history_table;
+    LazyTableModel *history_model;
+    DatedTableSource<double> *history_source;
+    QAction *cancel_action;
 };
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QImage>
+#include <QMetaType>
+#include <QVector>
+#include <QWidget>
+
+
+/**
+ * \brief A grid of values sampled over two parameter ranges, row major with the first row at
+ *        the lowest value of the vertical parameter.
+ */
+struct SweepGrid
+{
+    quint64 generation;
+    int level;
+    int rows;
+    int columns;
+    double x_min;
+    double x_max;
+    double y_min;
+    double y_max;
+    QVector<double> values;
+};
+
+Q_DECLARE_METATYPE(SweepGrid)
+
+
+/**
+ * \brief The SweepPlot class draws a SweepGrid as a colour mapped surface.
+ *
+ * \par
+ *      The grid is converted once to an image with one pixel per sample and the image is
+ *      scaled to the widget when painting, so a coarse grid is shown as large smooth cells and
+ *      a finer one simply replaces it.
+ */
+class SweepPlot : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SweepPlot(QWidget *parent = 0);
+
+    void show_grid(const SweepGrid& grid);
+
+    void set_axis_titles(const QString& x_title, const QString& y_title);
+
+protected:
+    void paintEvent(QPaintEvent *event);
+
+private:
+    QRect plot_rect() const;
+
+    QImage surface;
+    SweepGrid grid;
+    double value_min;
+    double value_max;
+    QString x_title;
+    QString y_title;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QWidget>
+
+#include <atomic>
+
+#include <sweep_plot.hpp>
+#include <task_scheduler.hpp>
+
+class QDoubleSpinBox;
+class QSpinBox;
+
+
+/**
+ * \brief The SweepWidget class explores the present value of a growing annuity over a range of
+ *        interest rates and growing rates.
+ *
+ * \par Progressive refinement.
+ *      Every parameter change evaluates a coarse grid on the GUI thread and shows it at once.
+ *      The grid is then refined in the background, doubling its resolution at each level up to
+ *      the full resolution, and each level replaces the previous one as soon as it is done.
+ *      The refinement is a task on the shared finance::TaskScheduler, which evaluates the levels
+ *      in row chunks with the batch kernel finance::PresentValue::pv_growing_annuity_grid()
+ *      spread over all cores, and hands each level to the GUI thread with a queued call.
+ * \par Cancellation.
+ *      Every change also increments a generation counter. Background work checks it before
+ *      every chunk and stops as soon as it is stale, and results of a stale generation are
+ *      dropped when they reach the GUI thread, so only the newest parameters are ever shown.
+ */
+class SweepWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SweepWidget(QWidget *parent = 0);
+    ~SweepWidget();
+
+private slots:
+    void restart();
+    void on_level(const SweepGrid& grid);
+
+private:
+    struct Parameters
+    {
+        double amount;
+        double periods;
+        double rate_min;
+        double rate_max;
+        double growth_min;
+        double growth_max;
+    };
+
+    Parameters read_parameters() const;
+    void refine(const Parameters& parameters, quint64 run);
+    static bool evaluate(const Parameters& parameters, int resolution, quint64 run,
+                         const std::atomic<quint64>& current, SweepGrid& grid);
+
+    QDoubleSpinBox *amount;
+    QSpinBox *periods;
+    QDoubleSpinBox *rate_min;
+    QDoubleSpinBox *rate_max;
+    QDoubleSpinBox *growth_min;
+    QDoubleSpinBox *growth_max;
+    SweepPlot *plot;
+
+    std::atomic<quint64> generation;
+    int shown_level;
+    finance::TaskGroup tasks;
+};
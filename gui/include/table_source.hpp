@@ -0,0 +1,115 @@
+#pragma once
+
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+#include <dated.hpp>
+#include <valuation_job.hpp>
+
+
+/**
+ * \brief The TableSource class exposes existing storage as rows and columns of cells.
+ *
+ * \par
+ *      Implementations only reference the storage they adapt, which must outlive them. Cells
+ *      are produced one at a time when a view asks for them.
+ */
+class TableSource
+{
+public:
+    virtual ~TableSource() {}
+
+    virtual int row_count() const = 0;
+    virtual int column_count() const = 0;
+    virtual QString header(int column) const = 0;
+    virtual QVariant value(int row, int column) const = 0;
+
+    /**
+     * \brief Orders two rows by \p column, used to sort without moving the data.
+     */
+    virtual bool less(int column, int lhs, int rhs) const = 0;
+};
+
+/**
+ * \brief The DatedTableSource class shows a Dated<T> series as a date column and a value column.
+ */
+template <typename T>
+class DatedTableSource : public TableSource
+{
+public:
+    explicit DatedTableSource(const Dated<T>& series)
+        : series(series)
+    {}
+
+    int row_count() const { return series.size(); }
+    int column_count() const { return 2; }
+
+    QString header(int column) const
+    {
+        return column == 0 ? QString("Date") : QString("Value");
+    }
+
+    QVariant value(int row, int column) const
+    {
+        if (column == 0)
+            return QString::fromStdString(series.get_dates()[row].debug_string());
+        return QVariant(static_cast<double>(series.get_elements()[row]));
+    }
+
+    bool less(int column, int lhs, int rhs) const
+    {
+        if (column == 0)
+            return series.get_dates()[lhs] < series.get_dates()[rhs];
+        return series.get_elements()[lhs] < series.get_elements()[rhs];
+    }
+
+private:
+    const Dated<T>& series;
+};
+
+/**
+ * \brief The ValuationResultSource class shows valuation results, one per row.
+ */
+class ValuationResultSource : public TableSource
+{
+public:
+    explicit ValuationResultSource(const QVector<finance::ValuationResult>& results)
+        : results(results)
+    {}
+
+    int row_count() const { return results.size(); }
+    int column_count() const { return 4; }
+
+    QString header(int column) const
+    {
+        static const char* const names[] = {"Name", "Present value", "IRR", "Unique IRR"};
+        return QString(names[column]);
+    }
+
+    QVariant value(int row, int column) const
+    {
+        const finance::ValuationResult& r = results[row];
+        switch (column) {
+        case 0: return QString::fromStdString(r.name);
+        case 1: return r.present_value;
+        case 2: return r.irr_found ? QVariant(r.irr) : QVariant(QString("-"));
+        default: return r.unique_irr ? QString("yes") : QString("no");
+        }
+    }
+
+    bool less(int column, int lhs, int rhs) const
+    {
+        const finance::ValuationResult& l = results[lhs];
+        const finance::ValuationResult& r = results[rhs];
+        switch (column) {
+        case 0: return l.name < r.name;
+        case 1: return l.present_value < r.present_value;
+        case 2: return (l.irr_found and r.irr_found) ? l.irr < r.irr : (l.irr_found and not r.irr_found);
+        default: return l.unique_irr < r.unique_irr;
+        }
+    }
+
+private:
+    const QVector<finance::ValuationResult>& results;
+};
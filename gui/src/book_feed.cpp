@@ -0,0 +1,81 @@
+#include <book_feed.hpp>
+
+#include <event_log.hpp>
+
+
+namespace {
+
+const int FrameMilliseconds = 16;
+
+}
+
+BookFeed::BookFeed(double min_price, double tick_size, int num_ticks, QObject *parent)
+    : QObject(parent),
+      queue(0),
+      instrument(0),
+      synchronized(false),
+      requested(false),
+      next_sequence(0),
+      book(min_price, tick_size, num_ticks)
+{
+    frame_timer.setInterval(FrameMilliseconds);
+    connect(&frame_timer, SIGNAL(timeout()), this, SLOT(drain()));
+}
+
+void BookFeed::subscribe(finance::BoundedQueue<finance::BookDelta> *queue, int instrument)
+{
+    this->queue = queue;
+    this->instrument = instrument;
+    book.clear();
+    synchronized = false;
+    requested = false;
+    if (queue == 0)
+        frame_timer.stop();
+    else
+        frame_timer.start();
+}
+
+const finance::DepthBook<double>& BookFeed::get_book() const
+{
+    return book;
+}
+
+void BookFeed::drain()
+{
+    // At most one queue's worth per frame, so a producer faster than the GUI cannot keep
+    // this loop running forever.
+    finance::BookDelta delta;
+    for (std::size_t n = queue->capacity(); n > 0 and queue->try_pop(delta); --n) {
+        if (delta.instrument == instrument) {
+            if (delta.reset) {
+                book.clear();
+                synchronized = true;
+                requested = false;
+            } else if (synchronized and delta.sequence != next_sequence) {
+                lose_sync();
+            }
+            if (synchronized) {
+                book.apply(delta);
+                next_sequence = delta.sequence + 1;
+            } else if (not requested) {
+                requested = true;
+                emit snapshot_requested(instrument);
+            }
+        }
+        FINANCE_LOG("book {} {} {} x {}", delta.instrument, delta.side == finance::BookDelta::Bid ? "bid" : "ask",
+                    delta.price, delta.quantity);
+    }
+
+    int first = 0;
+    int last = -1;
+    book.take_changes(first, last);
+    emit frame(first, last);
+}
+
+void BookFeed::lose_sync()
+{
+    // The lost delta may have emptied any level, so nothing in the book can be trusted.
+    book.clear();
+    synchronized = false;
+    requested = false;
+}
@@ -0,0 +1,233 @@
+#include <chart_widget.hpp>
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+
+namespace {
+
+const QColor Background(255, 255, 255);
+const QColor Foreground(31, 119, 180);
+const QColor Text(80, 80, 80);
+const double ZoomStep = 1.25;
+
+}
+
+ChartWidget::ChartWidget(QWidget *parent)
+    : QWidget(parent),
+      view_first{0},
+      view_last{0},
+      y_min{0},
+      y_max{1},
+      dragging{false},
+      drag_x{0}
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    setMouseTracking(false);
+}
+
+void ChartWidget::set_series(Dated<double> series)
+{
+    this->series = std::move(series);
+    pyramid.build(this->series.get_elements());
+    reset_zoom();
+}
+
+const Dated<double>& ChartWidget::get_series() const
+{
+    return series;
+}
+
+void ChartWidget::reset_zoom()
+{
+    view_first = 0;
+    view_last = std::max(1, series.size());
+    fit_vertical_range();
+    render_all();
+}
+
+double ChartWidget::samples_per_column() const
+{
+    return (view_last - view_first) / std::max(1, width());
+}
+
+void ChartWidget::fit_vertical_range()
+{
+    double lo, hi;
+    if (not pyramid.range(static_cast<int>(std::floor(view_first)), static_cast<int>(std::ceil(view_last)) + 1, lo, hi)) {
+        y_min = 0;
+        y_max = 1;
+        return;
+    }
+    const double margin = (hi > lo) ? 0.05 * (hi - lo) : 0.5;
+    y_min = lo - margin;
+    y_max = hi + margin;
+}
+
+int ChartWidget::to_y(double value) const
+{
+    return static_cast<int>((y_max - value) / (y_max - y_min) * (height() - 1));
+}
+
+void ChartWidget::render_all()
+{
+    if (width() <= 0 or height() <= 0)
+        return;
+    if (cache.size() != size())
+        cache = QImage(size(), QImage::Format_RGB32);
+    render_columns(cache, 0, width());
+    update();
+}
+
+void ChartWidget::render_columns(QImage& image, int first_column, int last_column) const
+{
+    QPainter painter(&image);
+    painter.fillRect(first_column, 0, last_column - first_column, height(), Background);
+    if (series.empty())
+        return;
+
+    painter.setPen(Foreground);
+    const double spp = samples_per_column();
+    const std::vector<double>& values = series.get_elements();
+
+    if (spp < 1.0) {
+        // Fewer samples than columns: join the samples, including one either side of the strip.
+        const int first = std::max(0, static_cast<int>(std::floor(view_first + first_column * spp)) - 1);
+        const int last  = std::min(series.size() - 1, static_cast<int>(std::ceil(view_first + last_column * spp)) + 1);
+        painter.setClipRect(first_column, 0, last_column - first_column, height());
+        for (int i = first; i < last; ++i) {
+            const double x0 = (i - view_first) / spp;
+            const double x1 = (i + 1 - view_first) / spp;
+            painter.drawLine(QPointF(x0, to_y(values[i])), QPointF(x1, to_y(values[i+1])));
+        }
+        return;
+    }
+
+    int prev_lo = -1;
+    int prev_hi = -1;
+    for (int c = first_column; c < last_column; ++c) {
+        const int first = static_cast<int>(std::floor(view_first + c * spp));
+        const int last  = static_cast<int>(std::floor(view_first + (c + 1) * spp));
+        double lo, hi;
+        if (not pyramid.range(first, std::max(last, first + 1), lo, hi)) {
+            prev_lo = prev_hi = -1;
+            continue;
+        }
+        int top = to_y(hi);
+        int bottom = to_y(lo);
+        // Join with the previous column so steep moves stay connected.
+        if (prev_lo >= 0) {
+            top = std::min(top, prev_lo);
+            bottom = std::max(bottom, prev_hi);
+        }
+        painter.drawLine(c, top, c, bottom);
+        prev_lo = to_y(lo);
+        prev_hi = to_y(hi);
+    }
+}
+
+void ChartWidget::scroll_by(int dx)
+{
+    if (dx == 0 or cache.isNull())
+        return;
+
+    const double spp = samples_per_column();
+    view_first -= dx * spp;
+    view_last  -= dx * spp;
+
+    if (std::abs(dx) >= width()) {
+        render_all();
+        return;
+    }
+
+    QImage scrolled(cache.size(), cache.format());
+    {
+        QPainter painter(&scrolled);
+        painter.drawImage(dx, 0, cache);
+    }
+    if (dx > 0)
+        render_columns(scrolled, 0, dx);
+    else
+        render_columns(scrolled, width() + dx, width());
+    std::swap(cache, scrolled);
+    update();
+}
+
+void ChartWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    if (cache.size() != size()) {
+        painter.fillRect(event->rect(), Background);
+        return;
+    }
+    painter.drawImage(event->rect(), cache, event->rect());
+
+    if (not series.empty()) {
+        const int first = std::max(0, static_cast<int>(view_first));
+        const int last  = std::min(series.size() - 1, static_cast<int>(view_last));
+        if (first <= last) {
+            painter.setPen(Text);
+            painter.drawText(rect().adjusted(4, 0, -4, -2), Qt::AlignBottom | Qt::AlignLeft,
+                             QString::fromStdString(series.date_at(first).debug_string()));
+            painter.drawText(rect().adjusted(4, 0, -4, -2), Qt::AlignBottom | Qt::AlignRight,
+                             QString::fromStdString(series.date_at(last).debug_string()));
+        }
+    }
+}
+
+void ChartWidget::resizeEvent(QResizeEvent *)
+{
+    render_all();
+}
+
+void ChartWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton) {
+        dragging = true;
+        drag_x = event->pos().x();
+    }
+}
+
+void ChartWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (not dragging)
+        return;
+    const int x = event->pos().x();
+    scroll_by(x - drag_x);
+    drag_x = x;
+}
+
+void ChartWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton or not dragging)
+        return;
+    dragging = false;
+    fit_vertical_range();
+    render_all();
+}
+
+void ChartWidget::wheelEvent(QWheelEvent *event)
+{
+    if (series.empty())
+        return;
+
+    const double factor = (event->angleDelta().y() > 0) ? 1.0 / ZoomStep : ZoomStep;
+    const double anchor = view_first + event->position().x() * samples_per_column();
+    const double min_span = 4.0;
+    const double span = std::max(min_span, std::min<double>(series.size(), (view_last - view_first) * factor));
+
+    const double ratio = (anchor - view_first) / (view_last - view_first);
+    view_first = anchor - ratio * span;
+    view_last  = view_first + span;
+
+    fit_vertical_range();
+    render_all();
+    event->accept();
+}
@@ -0,0 +1,122 @@
+#include <compute_service.hpp>
+
+#include <algorithm>
+
+#include <parallel.hpp>
+
+
+namespace {
+
+const int FrameMilliseconds = 16;
+const int ChunkJobs = 256;
+
+}
+
+ComputeService::ComputeService(QObject *parent)
+    : QObject(parent),
+      serial(0)
+{
+    flush_timer.setInterval(FrameMilliseconds);
+    connect(&flush_timer, SIGNAL(timeout()), this, SLOT(flush()));
+}
+
+ComputeService::~ComputeService()
+{
+    // Retired batches are cancelled already; their tasks must return before the service goes.
+    if (batch)
+        batch->chunks.cancel();
+    tasks.wait();
+}
+
+void ComputeService::submit_valuations(const QVector<finance::ValuationJob>& jobs)
+{
+    // The running batch is cancelled, not waited for: the GUI thread never blocks on a batch it
+    // no longer wants, and its queued calls are dropped by their serial.
+    if (batch)
+        batch->chunks.cancel();
+    pending.clear();
+
+    batch = std::make_shared<Batch>();
+    batch->serial = ++serial;
+    batch->jobs.assign(jobs.begin(), jobs.end());
+    batch->results.resize(batch->jobs.size());
+    batch->done = 0;
+    const std::shared_ptr<Batch> submitted = batch;
+    tasks.run([this, submitted] { run(*submitted); });
+    flush_timer.start();
+}
+
+bool ComputeService::is_running() const
+{
+    return static_cast<bool>(batch);
+}
+
+void ComputeService::cancel()
+{
+    if (batch)
+        batch->chunks.cancel();
+}
+
+void ComputeService::run(Batch& b)
+{
+    const int n = static_cast<int>(b.jobs.size());
+    try {
+        finance::parallel_for(0, (n + ChunkJobs - 1) / ChunkJobs, [this, &b, n](const int c) {
+            const int begin = c * ChunkJobs;
+            const int end = std::min(n, begin + ChunkJobs);
+            int i = begin;
+            for (; i < end and not b.chunks.is_cancelled(); ++i) {
+                b.results[i] = finance::evaluate(b.jobs[i]);
+                b.done.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (i > begin)
+                QMetaObject::invokeMethod(this, "on_results_ready_at", Qt::QueuedConnection,
+                                          Q_ARG(int, b.serial), Q_ARG(int, begin), Q_ARG(int, i));
+        }, b.chunks);
+    } catch (...) {
+        b.chunks.cancel();
+    }
+    QMetaObject::invokeMethod(this, "on_finished", Qt::QueuedConnection, Q_ARG(int, b.serial));
+}
+
+void ComputeService::on_results_ready_at(int serial, int begin, int end)
+{
+    if (not batch or serial != batch->serial)
+        return;
+    for (int i = begin; i < end; ++i)
+        pending.append(i);
+}
+
+void ComputeService::flush()
+{
+    if (not batch)
+        return;
+    emit progress_changed(batch->done.load(std::memory_order_relaxed), static_cast<int>(batch->jobs.size()));
+    if (pending.isEmpty())
+        return;
+
+    QVector<finance::ValuationResult> results;
+    results.reserve(pending.size());
+    for (int i : pending)
+        results.append(batch->results[i]);
+
+    const QVector<int> indices = pending;
+    pending.clear();
+    emit results_ready(indices, results);
+}
+
+void ComputeService::on_finished(int serial)
+{
+    if (not batch or serial != batch->serial)
+        return;
+    flush_timer.stop();
+    if (batch->chunks.is_cancelled()) {
+        pending.clear();
+        batch.reset();
+        emit cancelled();
+        return;
+    }
+    flush();
+    batch.reset();
+    emit finished();
+}
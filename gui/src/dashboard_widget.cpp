@@ -0,0 +1,162 @@
+#include <dashboard_widget.hpp>
+
+#include <event_log.hpp>
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+
+
+namespace {
+
+const int FrameMilliseconds = 16;
+const int MaxUpdatesPerFrame = 1 << 20;
+// Rows are allocated up to the largest id seen, so a corrupt id must not size the table.
+const int MaxInstruments = 1 << 16;
+const char* const Headers[] = {"Instrument", "Bid", "Ask", "Last", "Position", "P&L"};
+
+}
+
+DashboardWidget::DashboardWidget(QWidget *parent)
+    : QWidget(parent),
+      queue(0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    row_height = fontMetrics().height() + 6;
+    column_width = fontMetrics().averageCharWidth() * 14;
+    frame_timer.setInterval(FrameMilliseconds);
+    connect(&frame_timer, SIGNAL(timeout()), this, SLOT(drain()));
+}
+
+void DashboardWidget::subscribe(finance::BoundedQueue<finance::InstrumentUpdate> *queue)
+{
+    this->queue = queue;
+    if (queue == 0)
+        frame_timer.stop();
+    else
+        frame_timer.start();
+}
+
+void DashboardWidget::set_instrument_names(const QStringList& names)
+{
+    this->names = names;
+    ensure_rows(names.size());
+    update();
+}
+
+QSize DashboardWidget::sizeHint() const
+{
+    return QSize(ColumnCount * column_width, (static_cast<int>(displayed.size()) + 1) * row_height);
+}
+
+void DashboardWidget::ensure_rows(int rows)
+{
+    if (rows <= static_cast<int>(displayed.size()))
+        return;
+    finance::InstrumentUpdate empty = {0, 0.0, 0.0, 0.0, 0.0, 0.0};
+    const int old_rows = static_cast<int>(displayed.size());
+    displayed.resize(rows, empty);
+    direction.resize(rows * ColumnCount, 0);
+    dirty.resize(rows * ColumnCount, 0);
+    for (int r = old_rows; r < rows; ++r)
+        displayed[r].instrument = r;
+    setMinimumHeight((rows + 1) * row_height);
+    updateGeometry();
+}
+
+QRect DashboardWidget::cell_rect(int row, int column) const
+{
+    return QRect(column * column_width, (row + 1) * row_height, column_width, row_height);
+}
+
+double DashboardWidget::cell_value(const finance::InstrumentUpdate& u, int column) const
+{
+    switch (column) {
+    case Bid:      return u.bid;
+    case Ask:      return u.ask;
+    case Last:     return u.last;
+    case Position: return u.position;
+    case Pnl:      return u.pnl;
+    default:       return u.instrument;
+    }
+}
+
+QString DashboardWidget::cell_text(int row, int column) const
+{
+    if (column == Instrument)
+        return row < names.size() ? names[row] : QString::number(row);
+    const int decimals = (column == Position) ? 0 : 2;
+    return QString::number(cell_value(displayed[row], column), 'f', decimals);
+}
+
+void DashboardWidget::drain()
+{
+    if (queue == 0)
+        return;
+
+    // Keep only the newest state per instrument and collect the cells that changed.
+    finance::InstrumentUpdate u;
+    for (int n = 0; n < MaxUpdatesPerFrame and queue->try_pop(u); ++n) {
+        if (u.instrument < 0 or u.instrument >= MaxInstruments)
+            continue;
+        FINANCE_LOG("update {} bid {} ask {} last {} position {} pnl {}",
+                    u.instrument, u.bid, u.ask, u.last, u.position, u.pnl);
+        ensure_rows(u.instrument + 1);
+        finance::InstrumentUpdate& shown = displayed[u.instrument];
+        for (int c = Bid; c < ColumnCount; ++c) {
+            const double before = cell_value(shown, c);
+            const double after = cell_value(u, c);
+            if (after == before)
+                continue;
+            const int cell = u.instrument * ColumnCount + c;
+            direction[cell] = (after > before) ? 1 : -1;
+            if (not dirty[cell]) {
+                dirty[cell] = 1;
+                dirty_cells.push_back(cell);
+            }
+        }
+        shown = u;
+    }
+
+    // While hidden the queue is still drained so it never fills up and drops the newest
+    // updates; the whole widget is painted from displayed when it is shown again.
+    const bool visible = isVisible();
+    for (int cell : dirty_cells) {
+        dirty[cell] = 0;
+        if (visible)
+            update(cell_rect(cell / ColumnCount, cell % ColumnCount));
+    }
+    dirty_cells.clear();
+}
+
+void DashboardWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect region = event->rect();
+    painter.fillRect(region, palette().base());
+
+    if (region.top() < row_height) {
+        painter.setPen(palette().text().color());
+        for (int c = 0; c < ColumnCount; ++c)
+            painter.drawText(QRect(c * column_width + 4, 0, column_width - 8, row_height),
+                             Qt::AlignVCenter | (c == Instrument ? Qt::AlignLeft : Qt::AlignRight),
+                             tr(Headers[c]));
+    }
+
+    const int first = std::max(0, region.top() / row_height - 1);
+    const int last  = std::min(static_cast<int>(displayed.size()) - 1, region.bottom() / row_height);
+    for (int row = first; row <= last; ++row) {
+        for (int c = 0; c < ColumnCount; ++c) {
+            const QRect rect = cell_rect(row, c);
+            if (not rect.intersects(region))
+                continue;
+            const int dir = (c == Instrument) ? 0 : direction[row * ColumnCount + c];
+            const QColor color = dir > 0 ? QColor(0, 140, 0) : dir < 0 ? QColor(200, 0, 0) : palette().text().color();
+            painter.setPen(color);
+            painter.drawText(rect.adjusted(4, 0, -4, 0),
+                             Qt::AlignVCenter | (c == Instrument ? Qt::AlignLeft : Qt::AlignRight),
+                             cell_text(row, c));
+        }
+    }
+}
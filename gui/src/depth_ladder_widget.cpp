@@ -0,0 +1,138 @@
+#include <depth_ladder_widget.hpp>
+#include <book_feed.hpp>
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+namespace {
+
+const QColor Background(255, 255, 255);
+const QColor BidColor(31, 119, 180, 90);
+const QColor AskColor(214, 39, 40, 90);
+const QColor Text(40, 40, 40);
+
+}
+
+DepthLadderWidget::DepthLadderWidget(QWidget *parent)
+    : QWidget(parent),
+      feed(0),
+      top_tick(-1),
+      scale(1.0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    row_height = fontMetrics().height() + 2;
+}
+
+void DepthLadderWidget::set_feed(BookFeed *feed)
+{
+    if (this->feed != 0)
+        disconnect(this->feed, 0, this, 0);
+    this->feed = feed;
+    top_tick = -1;
+    if (feed != 0)
+        connect(feed, SIGNAL(frame(int,int)), this, SLOT(on_frame(int,int)));
+    update();
+}
+
+int DepthLadderWidget::visible_rows() const
+{
+    return std::max(1, height() / row_height);
+}
+
+int DepthLadderWidget::row_of(int tick) const
+{
+    return top_tick - tick;
+}
+
+bool DepthLadderWidget::recenter()
+{
+    const finance::DepthBook<double>& book = feed->get_book();
+    const int bid = book.best_bid();
+    const int ask = book.best_ask();
+    if (bid < 0 and ask >= book.size())
+        return false;
+
+    const int mid = (bid < 0) ? ask : (ask >= book.size()) ? bid : (bid + ask) / 2;
+    const int rows = visible_rows();
+    if (top_tick >= 0 and std::abs(row_of(mid) - rows / 2) <= rows / 4)
+        return false;
+    top_tick = mid + rows / 2;
+    return true;
+}
+
+void DepthLadderWidget::on_frame(int first_tick, int last_tick)
+{
+    if (recenter()) {
+        update();
+        return;
+    }
+    if (first_tick > last_tick or top_tick < 0)
+        return;
+
+    const finance::DepthBook<double>& book = feed->get_book();
+    double changed_max = 0.0;
+    for (int k = first_tick; k <= last_tick; k++)
+        changed_max = std::max(changed_max, std::max(book.bid_quantity(k), book.ask_quantity(k)));
+    if (changed_max > scale) {
+        // The bars are drawn against a scale that only grows, so the unchanged rows stay valid.
+        while (scale < changed_max)
+            scale *= 2;
+        update();
+        return;
+    }
+
+    const int first_row = std::max(0, row_of(last_tick));
+    const int last_row  = std::min(visible_rows() - 1, row_of(first_tick));
+    if (first_row <= last_row)
+        update(0, first_row * row_height, width(), (last_row - first_row + 1) * row_height);
+}
+
+void DepthLadderWidget::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(this);
+    const QRect region = event->rect();
+    painter.fillRect(region, Background);
+    if (feed == 0 or top_tick < 0)
+        return;
+
+    const finance::DepthBook<double>& book = feed->get_book();
+    const int column = width() / 3;
+    const int decimals = std::max(0, static_cast<int>(std::ceil(-std::log10(book.get_tick_size()) - 1e-9)));
+    const int first_row = region.top() / row_height;
+    const int last_row  = region.bottom() / row_height;
+    painter.setPen(Text);
+    for (int row = first_row; row <= last_row; row++) {
+        const int k = top_tick - row;
+        if (k < 0 or k >= book.size())
+            continue;
+        const int y = row * row_height;
+        const double bid = book.bid_quantity(k);
+        const double ask = book.ask_quantity(k);
+        if (bid > 0.0) {
+            const int w = static_cast<int>(column * bid / scale);
+            painter.fillRect(column - w, y, w, row_height - 1, BidColor);
+            painter.drawText(QRect(0, y, column - 4, row_height), Qt::AlignVCenter | Qt::AlignRight,
+                             QString::number(bid, 'g', 8));
+        }
+        if (ask > 0.0) {
+            const int w = static_cast<int>(column * ask / scale);
+            painter.fillRect(2 * column, y, w, row_height - 1, AskColor);
+            painter.drawText(QRect(2 * column + 4, y, column - 4, row_height), Qt::AlignVCenter | Qt::AlignLeft,
+                             QString::number(ask, 'g', 8));
+        }
+        painter.drawText(QRect(column, y, column, row_height), Qt::AlignCenter,
+                         QString::number(book.price_of(k), 'f', decimals));
+    }
+}
+
+void DepthLadderWidget::resizeEvent(QResizeEvent *)
+{
+    top_tick = -1;
+    if (feed != 0)
+        recenter();
+}
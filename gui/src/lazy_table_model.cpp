@@ -0,0 +1,128 @@
+#include <lazy_table_model.hpp>
+
+#include <algorithm>
+
+
+LazyTableModel::LazyTableModel(QObject *parent)
+    : QAbstractTableModel(parent),
+      source(0)
+{}
+
+void LazyTableModel::set_source(const TableSource *source)
+{
+    beginResetModel();
+    this->source = source;
+    permutation.clear();
+    inverse.clear();
+    endResetModel();
+}
+
+void LazyTableModel::refresh(int begin, int end)
+{
+    if (source == 0)
+        return;
+    begin = std::max(begin, 0);
+    end = std::min(end, source->row_count());
+    if (begin >= end)
+        return;
+
+    // After a sort the source rows are scattered; the views repaint the span that holds them.
+    int first = begin;
+    int last = end - 1;
+    if (not inverse.empty()) {
+        first = rowCount();
+        last = -1;
+        for (int row = begin; row < end; ++row) {
+            const int shown = row < static_cast<int>(inverse.size()) ? inverse[row] : row;
+            first = std::min(first, shown);
+            last = std::max(last, shown);
+        }
+    }
+    emit dataChanged(index(first, 0), index(last, columnCount() - 1));
+}
+
+int LazyTableModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() or source == 0)
+        return 0;
+    return source->row_count();
+}
+
+int LazyTableModel::columnCount(const QModelIndex& parent) const
+{
+    if (parent.isValid() or source == 0)
+        return 0;
+    return source->column_count();
+}
+
+QVariant LazyTableModel::data(const QModelIndex& index, int role) const
+{
+    if (source == 0 or not index.isValid())
+        return QVariant();
+    if (role != Qt::DisplayRole and role != Qt::TextAlignmentRole)
+        return QVariant();
+
+    const QVariant value = source->value(source_row(index.row()), index.column());
+    if (role == Qt::TextAlignmentRole) {
+        const bool numeric = value.userType() == QMetaType::Double;
+        return int((numeric ? Qt::AlignRight : Qt::AlignLeft) | Qt::AlignVCenter);
+    }
+    if (value.userType() == QMetaType::Double)
+        return QString::number(value.toDouble(), 'f', 6);
+    return value;
+}
+
+QVariant LazyTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (source == 0 or role != Qt::DisplayRole)
+        return QVariant();
+    if (orientation == Qt::Horizontal)
+        return source->header(section);
+    return section + 1;
+}
+
+void LazyTableModel::sort(int column, Qt::SortOrder order)
+{
+    if (source == 0 or column < 0 or column >= source->column_count())
+        return;
+
+    emit layoutAboutToBeChanged();
+    // Selections and the current index follow their source row to its sorted position.
+    const QModelIndexList before = persistentIndexList();
+    std::vector<int> rows(before.size());
+    for (int i = 0; i < before.size(); ++i)
+        rows[i] = source_row(before[i].row());
+
+    const int n = source->row_count();
+    permutation.resize(n);
+    for (int i = 0; i < n; ++i)
+        permutation[i] = i;
+
+    const TableSource *s = source;
+    if (order == Qt::AscendingOrder)
+        std::stable_sort(permutation.begin(), permutation.end(),
+                         [s, column](int l, int r) { return s->less(column, l, r); });
+    else
+        std::stable_sort(permutation.begin(), permutation.end(),
+                         [s, column](int l, int r) { return s->less(column, r, l); });
+    inverse.resize(n);
+    for (int i = 0; i < n; ++i)
+        inverse[permutation[i]] = i;
+
+    QModelIndexList after;
+    after.reserve(before.size());
+    for (int i = 0; i < before.size(); ++i) {
+        const int row = rows[i] < n ? inverse[rows[i]] : rows[i];
+        after.append(index(row, before[i].column()));
+    }
+    changePersistentIndexList(before, after);
+    emit layoutChanged();
+}
+
+int LazyTableModel::source_row(int row) const
+{
+    // Rows appended after the last sort are shown unsorted at the end.
+    if (row < static_cast<int>(permutation.size()))
+        return permutation[row];
+    return row;
+}
@@ -0,0 +1,161 @@
+#include <liquidity_heatmap_widget.hpp>
+#include <book_feed.hpp>
+
+#include <QPainter>
+#include <QPaintEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+
+namespace {
+
+const int NumColors = 256;
+const QRgb Background = qRgb(0, 0, 0);
+const QRgb BestPrice = qRgb(255, 255, 255);
+const double ScaleDecay = 0.999;
+
+QVector<QRgb> make_ramp(int red, int green, int blue)
+{
+    QVector<QRgb> ramp(NumColors);
+    for (int i = 0; i < NumColors; ++i)
+        ramp[i] = qRgb(red * i / (NumColors - 1), green * i / (NumColors - 1), blue * i / (NumColors - 1));
+    return ramp;
+}
+
+}
+
+LiquidityHeatmapWidget::LiquidityHeatmapWidget(QWidget *parent)
+    : QWidget(parent),
+      feed(0),
+      bid_colors(make_ramp(60, 160, 255)),
+      ask_colors(make_ramp(255, 90, 60)),
+      head(0),
+      top_tick(-1),
+      scale(1.0)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void LiquidityHeatmapWidget::set_feed(BookFeed *feed)
+{
+    if (this->feed != 0)
+        disconnect(this->feed, 0, this, 0);
+    this->feed = feed;
+    top_tick = -1;
+    history.fill(Background);
+    if (feed != 0)
+        connect(feed, SIGNAL(frame(int,int)), this, SLOT(on_frame(int,int)));
+    update();
+}
+
+void LiquidityHeatmapWidget::recenter()
+{
+    const finance::DepthBook<double>& book = feed->get_book();
+    const int bid = book.best_bid();
+    const int ask = book.best_ask();
+    if (bid < 0 and ask >= book.size())
+        return;
+
+    const int rows = history.height();
+    const int mid = (bid < 0) ? ask : (ask >= book.size()) ? bid : (bid + ask) / 2;
+    if (top_tick >= 0 and std::abs(top_tick - mid - rows / 2) <= rows / 4)
+        return;
+
+    // A higher top tick moves every price down the image by the same number of rows.
+    const int new_top = mid + rows / 2;
+    const int shift = (top_tick < 0) ? rows : new_top - top_tick;
+    top_tick = new_top;
+    if (std::abs(shift) >= rows) {
+        history.fill(Background);
+        return;
+    }
+    const int line = history.bytesPerLine();
+    uchar *bits = history.bits();
+    if (shift > 0) {
+        std::memmove(bits + shift * line, bits, (rows - shift) * line);
+        fill_rows(0, shift);
+    } else {
+        std::memmove(bits, bits - shift * line, (rows + shift) * line);
+        fill_rows(rows + shift, rows);
+    }
+}
+
+void LiquidityHeatmapWidget::fill_rows(int first, int last)
+{
+    for (int y = first; y < last; ++y) {
+        QRgb *line = reinterpret_cast<QRgb*>(history.scanLine(y));
+        std::fill(line, line + history.width(), Background);
+    }
+}
+
+void LiquidityHeatmapWidget::write_column()
+{
+    const finance::DepthBook<double>& book = feed->get_book();
+    const int rows = history.height();
+    const int bid = book.best_bid();
+    const int ask = book.best_ask();
+
+    double column_max = 0.0;
+    for (int y = 0; y < rows; ++y) {
+        const int k = top_tick - y;
+        if (k >= 0 and k < book.size())
+            column_max = std::max(column_max, std::max(book.bid_quantity(k), book.ask_quantity(k)));
+    }
+    scale = std::max(1.0, std::max(column_max, scale * ScaleDecay));
+    const double to_index = (NumColors - 1) / std::log1p(scale);
+
+    for (int y = 0; y < rows; ++y) {
+        QRgb *pixel = reinterpret_cast<QRgb*>(history.scanLine(y)) + head;
+        const int k = top_tick - y;
+        if (k < 0 or k >= book.size()) {
+            *pixel = Background;
+        } else if (k == bid or k == ask) {
+            *pixel = BestPrice;
+        } else if (book.bid_quantity(k) > 0.0) {
+            *pixel = bid_colors[static_cast<int>(std::log1p(book.bid_quantity(k)) * to_index)];
+        } else if (book.ask_quantity(k) > 0.0) {
+            *pixel = ask_colors[static_cast<int>(std::log1p(book.ask_quantity(k)) * to_index)];
+        } else {
+            *pixel = Background;
+        }
+    }
+    head = (head + 1) % history.width();
+}
+
+void LiquidityHeatmapWidget::on_frame(int, int)
+{
+    if (history.isNull())
+        return;
+    recenter();
+    if (top_tick < 0)
+        return;
+    write_column();
+    update();
+}
+
+void LiquidityHeatmapWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    if (history.isNull())
+        return;
+    // The oldest column is at head: blit [head, width) then [0, head).
+    const int w = history.width();
+    painter.drawImage(QPoint(0, 0), history, QRect(head, 0, w - head, history.height()));
+    if (head > 0)
+        painter.drawImage(QPoint(w - head, 0), history, QRect(0, 0, head, history.height()));
+}
+
+void LiquidityHeatmapWidget::resizeEvent(QResizeEvent *)
+{
+    if (width() <= 0 or height() <= 0) {
+        history = QImage();
+        return;
+    }
+    history = QImage(width(), height(), QImage::Format_RGB32);
+    history.fill(Background);
+    head = 0;
+    top_tick = -1;
+}
@@ -1,8 +1,265 @@
 #include <main_window.hpp>
+#include <book_feed.hpp>
+#include <chart_widget.hpp>
+#include <dashboard_widget.hpp>
+#include <depth_ladder_widget.hpp>
+#include <lazy_table_model.hpp>
+#include <liquidity_heatmap_widget.hpp>
+#include <sweep_widget.hpp>
+#include <table_source.hpp>
 
+#include <reproducible_sum.hpp>
+#include <solver_statistics.hpp>
+
+#include <QAction>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QMenu>
+#include <QMessageBox>
+#include <QProgressBar>
+#include <QScrollArea>
+#include <QSplitter>
+#include <QTableView>
+#include <QTabWidget>
+#include <QVBoxLayout>
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+
+namespace {
+
+// Fixed row heights let the view place any of millions of rows without measuring them.
+QTableView *make_table_view(LazyTableModel *model)
+{
+    QTableView *view = new QTableView;
+    view->setModel(model);
+    view->setSortingEnabled(true);
+    view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view->verticalHeader()->setDefaultSectionSize(view->fontMetrics().height() + 4);
+    return view;
+}
+
+}
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent)
+    : QMainWindow(parent),
+      updates(1 << 16),
+      deltas(1 << 18)
 {
     setupUi(this);
+
+    result_source = new ValuationResultSource(results);
+    model = new LazyTableModel(this);
+    model->set_source(result_source);
+
+    table = make_table_view(model);
+
+    // The history table reads the series the chart plots, so loading it copies nothing.
+    chart = new ChartWidget;
+    history_source = new DatedTableSource<double>(chart->get_series());
+    history_model = new LazyTableModel(this);
+    history_model->set_source(history_source);
+    history_table = make_table_view(history_model);
+
+    dashboard = new DashboardWidget;
+    dashboard->subscribe(&updates);
+    QScrollArea *dashboard_area = new QScrollArea;
+    dashboard_area->setWidget(dashboard);
+    dashboard_area->setWidgetResizable(true);
+    dashboard_page = dashboard_area;
+
+    // One cent ticks up to 1000 cover the simulated prices; deltas outside are dropped.
+    book_feed = new BookFeed(0.0, 0.01, 100000, this);
+    book_feed->subscribe(&deltas, 0);
+    connect(book_feed, SIGNAL(snapshot_requested(int)), this, SIGNAL(book_snapshot_requested(int)));
+    DepthLadderWidget *ladder = new DepthLadderWidget;
+    ladder->set_feed(book_feed);
+    LiquidityHeatmapWidget *heatmap = new LiquidityHeatmapWidget;
+    heatmap->set_feed(book_feed);
+    QSplitter *book_splitter = new QSplitter;
+    book_splitter->addWidget(ladder);
+    book_splitter->addWidget(heatmap);
+    book_splitter->setStretchFactor(1, 3);
+    book_page = book_splitter;
+    sweep_page = new SweepWidget;
+
+    tabs = new QTabWidget(centralwidget);
+    tabs->addTab(chart, tr("Chart"));
+    tabs->addTab(history_table, tr("History"));
+    tabs->addTab(table, tr("Results"));
+    tabs->addTab(dashboard_page, tr("Dashboard"));
+    tabs->addTab(book_page, tr("Book"));
+    tabs->addTab(sweep_page, tr("Sweep"));
+    QVBoxLayout *layout = new QVBoxLayout(centralwidget);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(tabs);
+
+    QMenu *file_menu = menubar->addMenu(tr("&File"));
+    QAction *history_action = file_menu->addAction(tr("Open &history..."));
+    QAction *open_action = file_menu->addAction(tr("&Value jobs..."));
+    cancel_action = file_menu->addAction(tr("&Cancel"));
+    cancel_action->setEnabled(false);
+    connect(history_action, SIGNAL(triggered()), this, SLOT(open_history()));
+    connect(open_action, SIGNAL(triggered()), this, SLOT(open_jobs()));
+    connect(cancel_action, SIGNAL(triggered()), &compute, SLOT(cancel()));
+
+    QMenu *view_menu = menubar->addMenu(tr("&View"));
+    QAction *dashboard_action = view_menu->addAction(tr("&Dashboard"));
+    QAction *book_action = view_menu->addAction(tr("&Book"));
+    QAction *sweep_action = view_menu->addAction(tr("&Sweep"));
+    connect(dashboard_action, SIGNAL(triggered()), this, SLOT(show_dashboard()));
+    connect(book_action, SIGNAL(triggered()), this, SLOT(show_book()));
+    connect(sweep_action, SIGNAL(triggered()), this, SLOT(show_sweep()));
+
+    progress = new QProgressBar(this);
+    progress->setVisible(false);
+    statusbar->addPermanentWidget(progress);
+
+    connect(&compute, SIGNAL(progress_changed(int,int)), this, SLOT(on_progress(int,int)));
+    connect(&compute, SIGNAL(results_ready(QVector<int>,QVector<finance::ValuationResult>)),
+            this, SLOT(on_results(QVector<int>,QVector<finance::ValuationResult>)));
+    connect(&compute, SIGNAL(finished()), this, SLOT(on_finished()));
+    connect(&compute, SIGNAL(cancelled()), this, SLOT(on_cancelled()));
+}
+
+MainWindow::~MainWindow()
+{
+    model->set_source(0);
+    delete result_source;
+    history_model->set_source(0);
+    delete history_source;
+}
+
+finance::BoundedQueue<finance::InstrumentUpdate>& MainWindow::market_updates()
+{
+    return updates;
+}
+
+finance::BoundedQueue<finance::BookDelta>& MainWindow::book_deltas()
+{
+    return deltas;
+}
+
+void MainWindow::show_dashboard()
+{
+    tabs->setCurrentWidget(dashboard_page);
+}
+
+void MainWindow::show_book()
+{
+    tabs->setCurrentWidget(book_page);
+}
+
+void MainWindow::show_sweep()
+{
+    tabs->setCurrentWidget(sweep_page);
+}
+
+void MainWindow::open_history()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Price history"));
+    if (path.isEmpty())
+        return;
+
+    Dated<double> series;
+    try {
+        std::ifstream is(path.toLocal8Bit().constData());
+        if (not is) {
+            QMessageBox::warning(this, tr("Price history"), tr("Cannot open %1").arg(path));
+            return;
+        }
+        series = read_dated<double>(is);
+    } catch (const std::invalid_argument& e) {
+        QMessageBox::warning(this, tr("Price history"), QString::fromLocal8Bit(e.what()));
+        return;
+    }
+
+    history_model->set_source(0);
+    chart->set_series(std::move(series));
+    history_model->set_source(history_source);
+    statusbar->showMessage(tr("%1 samples").arg(chart->get_series().size()));
+}
+
+void MainWindow::open_jobs()
+{
+    const QString path = QFileDialog::getOpenFileName(this, tr("Valuation jobs"));
+    if (path.isEmpty())
+        return;
+
+    std::vector<finance::ValuationJob> jobs;
+    try {
+        std::ifstream is(path.toLocal8Bit().constData());
+        if (not is) {
+            QMessageBox::warning(this, tr("Valuation jobs"), tr("Cannot open %1").arg(path));
+            return;
+        }
+        jobs = finance::read_valuation_jobs(is);
+    } catch (const std::invalid_argument& e) {
+        QMessageBox::warning(this, tr("Valuation jobs"), QString::fromLocal8Bit(e.what()));
+        return;
+    }
+
+    model->set_source(0);
+    results.fill(finance::ValuationResult(), static_cast<int>(jobs.size()));
+    model->set_source(result_source);
+    progress->setRange(0, static_cast<int>(jobs.size()));
+    progress->setValue(0);
+    progress->setVisible(true);
+    cancel_action->setEnabled(true);
+    QVector<finance::ValuationJob> batch;
+    batch.reserve(static_cast<int>(jobs.size()));
+    for (const finance::ValuationJob& job : jobs)
+        batch.append(job);
+    compute.submit_valuations(batch);
+}
+
+void MainWindow::on_progress(int done, int total)
+{
+    progress->setRange(0, total);
+    progress->setValue(done);
+}
+
+void MainWindow::on_results(const QVector<int>& indices, const QVector<finance::ValuationResult>& batch)
+{
+    if (indices.isEmpty())
+        return;
+    int begin = indices[0];
+    int end = indices[0] + 1;
+    for (int i = 0; i < indices.size(); ++i) {
+        results[indices[i]] = batch[i];
+        begin = std::min(begin, indices[i]);
+        end = std::max(end, indices[i] + 1);
+    }
+    model->refresh(begin, end);
+}
+
+void MainWindow::on_finished()
+{
+    progress->setVisible(false);
+    cancel_action->setEnabled(false);
+
+    finance::SolverTelemetry telemetry;
+    for (const finance::ValuationResult& r : results)
+        telemetry.record(r.irr_statistics);
+    const long long failed = telemetry.get_calls() - telemetry.get_failures(finance::SolverStatistics::None);
+    const QVector<finance::ValuationResult>& values = results;
+    const double total = finance::reproducible_sum(0, values.size(), [&values](const int i) {
+        return values[i].present_value;
+    });
+    statusbar->showMessage(tr("%1 jobs valued, total PV %2, %3 PV evaluations per IRR (p99 %4), %5 IRR not found")
+                           .arg(results.size())
+                           .arg(total, 0, 'f', 2)
+                           .arg(telemetry.mean(finance::SolverTelemetry::FunctionEvaluations), 0, 'f', 1)
+                           .arg(telemetry.percentile(finance::SolverTelemetry::FunctionEvaluations, 0.99))
+                           .arg(failed));
+}
+
+void MainWindow::on_cancelled()
+{
+    progress->setVisible(false);
+    cancel_action->setEnabled(false);
+    statusbar->showMessage(tr("Valuation cancelled"));
 }
@@ -0,0 +1,106 @@
+#include <sweep_plot.hpp>
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace {
+
+const int Margin = 40;
+
+QRgb ramp(double t)
+{
+    // Dark blue, teal, green, yellow.
+    const int stops[][3] = {{68, 1, 84}, {59, 82, 139}, {33, 145, 140}, {94, 201, 98}, {253, 231, 37}};
+    const int last = static_cast<int>(sizeof(stops) / sizeof(stops[0])) - 1;
+    const double x = std::min(std::max(t, 0.0), 1.0) * last;
+    const int i = std::min(static_cast<int>(x), last - 1);
+    const double w = x - i;
+    return qRgb(static_cast<int>(stops[i][0] + w * (stops[i+1][0] - stops[i][0])),
+                static_cast<int>(stops[i][1] + w * (stops[i+1][1] - stops[i][1])),
+                static_cast<int>(stops[i][2] + w * (stops[i+1][2] - stops[i][2])));
+}
+
+}
+
+SweepPlot::SweepPlot(QWidget *parent)
+    : QWidget(parent),
+      value_min(0.0),
+      value_max(1.0)
+{
+    grid.rows = 0;
+    grid.columns = 0;
+    setMinimumSize(2 * Margin + 100, 2 * Margin + 100);
+}
+
+void SweepPlot::set_axis_titles(const QString& x_title, const QString& y_title)
+{
+    this->x_title = x_title;
+    this->y_title = y_title;
+    update();
+}
+
+void SweepPlot::show_grid(const SweepGrid& grid)
+{
+    this->grid = grid;
+    value_min = 0.0;
+    value_max = 0.0;
+    bool first = true;
+    for (int i = 0; i < grid.values.size(); ++i) {
+        const double v = grid.values[i];
+        if (not std::isfinite(v))
+            continue;
+        value_min = first ? v : std::min(value_min, v);
+        value_max = first ? v : std::max(value_max, v);
+        first = false;
+    }
+    const double span = (value_max > value_min) ? value_max - value_min : 1.0;
+
+    // Image rows go down, the vertical parameter goes up.
+    surface = QImage(grid.columns, grid.rows, QImage::Format_RGB32);
+    for (int i = 0; i < grid.rows; ++i) {
+        QRgb *line = reinterpret_cast<QRgb*>(surface.scanLine(grid.rows - 1 - i));
+        const double *row = grid.values.constData() + i * grid.columns;
+        for (int j = 0; j < grid.columns; ++j)
+            line[j] = std::isfinite(row[j]) ? ramp((row[j] - value_min) / span) : qRgb(0, 0, 0);
+    }
+    update();
+}
+
+QRect SweepPlot::plot_rect() const
+{
+    return rect().adjusted(Margin, Margin / 2, -Margin / 2, -Margin);
+}
+
+void SweepPlot::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), palette().window());
+    if (surface.isNull())
+        return;
+
+    const QRect area = plot_rect();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    painter.drawImage(area, surface);
+
+    painter.setPen(palette().text().color());
+    const QFontMetrics metrics = fontMetrics();
+    painter.drawText(QRect(area.left(), area.bottom() + 2, area.width(), metrics.height()),
+                     Qt::AlignLeft, QString::number(grid.x_min, 'g', 4));
+    painter.drawText(QRect(area.left(), area.bottom() + 2, area.width(), metrics.height()),
+                     Qt::AlignRight, QString::number(grid.x_max, 'g', 4));
+    painter.drawText(QRect(area.left(), area.bottom() + 2, area.width(), metrics.height()),
+                     Qt::AlignHCenter, x_title);
+    painter.drawText(QRect(0, area.bottom() - metrics.height(), Margin - 2, metrics.height()),
+                     Qt::AlignRight, QString::number(grid.y_min, 'g', 4));
+    painter.drawText(QRect(0, area.top(), Margin - 2, metrics.height()),
+                     Qt::AlignRight, QString::number(grid.y_max, 'g', 4));
+    painter.drawText(QRect(0, area.center().y(), Margin - 2, metrics.height()),
+                     Qt::AlignRight, y_title);
+    painter.drawText(QRect(area.left(), area.bottom() + 2 + metrics.height(), area.width(), metrics.height()),
+                     Qt::AlignHCenter,
+                     tr("%1 x %2, values %3 to %4").arg(grid.columns).arg(grid.rows)
+                         .arg(value_min, 0, 'g', 6).arg(value_max, 0, 'g', 6));
+}
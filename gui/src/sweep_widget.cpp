@@ -0,0 +1,163 @@
+#include <sweep_widget.hpp>
+
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QSpinBox>
+
+#include <algorithm>
+#include <vector>
+
+#include <parallel.hpp>
+#include <present_value.hpp>
+
+
+namespace {
+
+const int CoarseResolution = 16;
+const int FullResolution = 1024;
+const int ChunkRows = 16;
+
+QDoubleSpinBox* make_rate_box(double value)
+{
+    QDoubleSpinBox *box = new QDoubleSpinBox;
+    box->setRange(-0.99, 10.0);
+    box->setDecimals(4);
+    box->setSingleStep(0.005);
+    box->setValue(value);
+    return box;
+}
+
+}
+
+SweepWidget::SweepWidget(QWidget *parent)
+    : QWidget(parent),
+      generation(0),
+      shown_level(-1)
+{
+    qRegisterMetaType<SweepGrid>("SweepGrid");
+
+    amount = new QDoubleSpinBox;
+    amount->setRange(-1.0e9, 1.0e9);
+    amount->setValue(100.0);
+    periods = new QSpinBox;
+    periods->setRange(1, 1000);
+    periods->setValue(30);
+    rate_min = make_rate_box(0.01);
+    rate_max = make_rate_box(0.15);
+    growth_min = make_rate_box(-0.05);
+    growth_max = make_rate_box(0.10);
+
+    QFormLayout *form = new QFormLayout;
+    form->addRow(tr("Initial payment"), amount);
+    form->addRow(tr("Periods"), periods);
+    form->addRow(tr("Rate from"), rate_min);
+    form->addRow(tr("Rate to"), rate_max);
+    form->addRow(tr("Growth from"), growth_min);
+    form->addRow(tr("Growth to"), growth_max);
+
+    plot = new SweepPlot;
+    plot->set_axis_titles(tr("r"), tr("g"));
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->addLayout(form);
+    layout->addWidget(plot, 1);
+
+    connect(amount, SIGNAL(valueChanged(double)), this, SLOT(restart()));
+    connect(periods, SIGNAL(valueChanged(int)), this, SLOT(restart()));
+    connect(rate_min, SIGNAL(valueChanged(double)), this, SLOT(restart()));
+    connect(rate_max, SIGNAL(valueChanged(double)), this, SLOT(restart()));
+    connect(growth_min, SIGNAL(valueChanged(double)), this, SLOT(restart()));
+    connect(growth_max, SIGNAL(valueChanged(double)), this, SLOT(restart()));
+
+    restart();
+}
+
+SweepWidget::~SweepWidget()
+{
+    ++generation;
+    tasks.wait();
+}
+
+SweepWidget::Parameters SweepWidget::read_parameters() const
+{
+    Parameters p;
+    p.amount = amount->value();
+    p.periods = periods->value();
+    p.rate_min = rate_min->value();
+    p.rate_max = rate_max->value();
+    p.growth_min = growth_min->value();
+    p.growth_max = growth_max->value();
+    return p;
+}
+
+void SweepWidget::restart()
+{
+    const quint64 g = ++generation;
+    const Parameters p = read_parameters();
+
+    SweepGrid coarse;
+    evaluate(p, CoarseResolution, g, generation, coarse);
+    shown_level = -1;
+    on_level(coarse);
+
+    // Stale refinements stop at their next chunk, so they hardly overlap the new one.
+    tasks.run([this, p, g] { refine(p, g); });
+}
+
+void SweepWidget::refine(const Parameters& parameters, quint64 run)
+{
+    for (int resolution = 2 * CoarseResolution; resolution <= FullResolution; resolution *= 2) {
+        SweepGrid grid;
+        if (not evaluate(parameters, resolution, run, generation, grid))
+            return;
+        QMetaObject::invokeMethod(this, "on_level", Qt::QueuedConnection, Q_ARG(SweepGrid, grid));
+    }
+}
+
+bool SweepWidget::evaluate(const Parameters& parameters, int resolution, quint64 run,
+                           const std::atomic<quint64>& current, SweepGrid& grid)
+{
+    std::vector<double> rates(resolution);
+    std::vector<double> growths(resolution);
+    for (int i = 0; i < resolution; ++i) {
+        const double w = static_cast<double>(i) / (resolution - 1);
+        rates[i] = parameters.rate_min + w * (parameters.rate_max - parameters.rate_min);
+        growths[i] = parameters.growth_min + w * (parameters.growth_max - parameters.growth_min);
+    }
+
+    grid.generation = run;
+    grid.level = 0;
+    for (int r = CoarseResolution; r < resolution; r *= 2)
+        grid.level++;
+    grid.rows = resolution;
+    grid.columns = resolution;
+    grid.x_min = parameters.rate_min;
+    grid.x_max = parameters.rate_max;
+    grid.y_min = parameters.growth_min;
+    grid.y_max = parameters.growth_max;
+    grid.values.resize(resolution * resolution);
+    double *values = grid.values.data();
+
+    const int num_chunks = (resolution + ChunkRows - 1) / ChunkRows;
+    finance::parallel_for(0, num_chunks, [&](const int c) {
+        if (current.load(std::memory_order_relaxed) != run)
+            return;
+        const int first = c * ChunkRows;
+        const int last = std::min(resolution, first + ChunkRows);
+        const std::vector<double> chunk_growths(growths.begin() + first, growths.begin() + last);
+        std::vector<double> pvs;
+        finance::PresentValue<double>().pv_growing_annuity_grid(parameters.amount, parameters.periods,
+                                                               rates, chunk_growths, pvs);
+        std::copy(pvs.begin(), pvs.end(), values + first * resolution);
+    });
+    return current.load() == run;
+}
+
+void SweepWidget::on_level(const SweepGrid& grid)
+{
+    if (grid.generation != generation.load() or grid.level <= shown_level)
+        return;
+    shown_level = grid.level;
+    plot->show_grid(grid);
+}
@@ -0,0 +1,106 @@
+/**
+ * \file
+ * Counts of the heap allocations made by each thread, and scoped regions measuring them.
+ *
+ * Counting is compiled in only when FINANCE_ALLOCATION_TRACKING is defined
+ * (<tt>CONFIG += allocation_tracking</tt> in the qmake projects): src/allocation_tracker.cpp then
+ * replaces the global operator new and delete. Otherwise every count stays zero and the
+ * allocation functions are the standard ones.
+ */
+
+#pragma once
+
+#include <string>
+#include <stdexcept>
+
+
+
+namespace finance {
+
+/**
+ * \brief Allocations and deallocations made through the global operator new and delete, and the
+ *        bytes requested.
+ * \ingroup Finance
+ */
+struct AllocationCounts
+{
+    long allocations;
+    long deallocations;
+    long bytes;
+};
+
+/**
+ * \brief Returns true if the allocation counting hooks are compiled in.
+ */
+bool allocation_tracking_enabled();
+
+/**
+ * \brief Returns the counts of the calling thread since it started.
+ */
+AllocationCounts thread_allocations();
+
+/**
+ * \brief The AllocationScope class measures the allocations of the calling thread from its
+ *        construction on.
+ * \ingroup Finance
+ *
+ * \par
+ *      Counters are per thread, kept in plain thread local variables: the hooks take no lock
+ *      and touch no shared cache line, and a region only sees the work of its own thread. Work
+ *      handed to other threads inside the region is not counted.
+ * \par Example.
+ *      \code
+ *      finance::AllocationScope steady;
+ *      for (int i = 0; i < 1000; i++)
+ *          pv.pv_discrete_cflow(times, amounts, r);
+ *      steady.check_no_allocations("pv_discrete_cflow");
+ *      \endcode
+ */
+class AllocationScope
+{
+public:
+    AllocationScope()
+        : start(thread_allocations())
+    {}
+
+    /**
+     * \brief Restarts the measurement.
+     */
+    void reset()
+    {
+        start = thread_allocations();
+    }
+
+    /**
+     * \brief Returns the counts of the calling thread since construction or reset().
+     */
+    AllocationCounts counts() const
+    {
+        const AllocationCounts now = thread_allocations();
+        AllocationCounts c;
+        c.allocations   = now.allocations - start.allocations;
+        c.deallocations = now.deallocations - start.deallocations;
+        c.bytes         = now.bytes - start.bytes;
+        return c;
+    }
+
+    /**
+     * \brief Checks that the region made no allocation.
+     *
+     * \param region    Name of the region, for the message.
+     * \exception std::logic_error if the calling thread allocated since construction or
+     *            reset(). Never throws when tracking is not compiled in.
+     */
+    void check_no_allocations(const char* region) const
+    {
+        const AllocationCounts c = counts();
+        if (c.allocations != 0)
+            throw std::logic_error(std::string(region) + ": " + std::to_string(c.allocations)
+                                   + " allocations (" + std::to_string(c.bytes) + " bytes)");
+    }
+
+private:
+    AllocationCounts start;
+};
+
+}
@@ -0,0 +1,124 @@
+/**
+ * \file
+ * Batch kernels over arrays of doubles and floats, compiled for each finance::Isa level and
+ * dispatched to the one active_isa() selects. The elementwise ones apply the functions of
+ * vector_math.hpp and share their error bounds.
+ */
+
+#pragma once
+
+#include <cpu_dispatch.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief Returns \f$ \sum_{i} a_{i} e^{-r t_{i}} \f$ over the \p n cash flows \p amounts at
+ *        \p times.
+ * \ingroup Finance
+ */
+double pv_continuous_batch(const double* times, const double* amounts, const int n, const double r);
+
+/**
+ * \brief Returns \f$ \sum_{i} a_{i} (1+r)^{-t_{i}} \f$ over the \p n cash flows \p amounts at
+ *        \p times, computed as \f$ e^{-t_{i} \log(1+r)} \f$.
+ * \ingroup Finance
+ *
+ * \par
+ *      \p r must be greater than -1; pow() alone gives real discount factors below, at integer
+ *      times.
+ */
+double pv_discrete_batch(const double* times, const double* amounts, const int n, const double r);
+
+/**
+ * \brief Stores \f$ e^{x_{i}} \f$ in \p y[i] for each of the \p n values \p x.
+ * \ingroup Finance
+ *
+ * \par
+ *      See vmath::exp(); subnormal results included, overflow gives infinity and NaN stays NaN.
+ */
+void exp_batch(const double* x, double* y, const int n);
+void exp_batch(const float* x, float* y, const int n);
+
+/**
+ * \brief Stores \f$ \log x_{i} \f$ in \p y[i] for each of the \p n values \p x.
+ * \ingroup Finance
+ *
+ * \par
+ *      See vmath::log(); log(0) is minus infinity and negative arguments give NaN.
+ */
+void log_batch(const double* x, double* y, const int n);
+void log_batch(const float* x, float* y, const int n);
+
+/**
+ * \brief Stores \f$ x_{i}^{y_{i}} \f$ in \p z[i] for each of the \p n pairs of \p x and \p y.
+ * \ingroup Finance
+ *
+ * \par
+ *      See vmath::pow() for the special cases.
+ */
+void pow_batch(const double* x, const double* y, double* z, const int n);
+void pow_batch(const float* x, const float* y, float* z, const int n);
+
+/**
+ * \brief Stores \f$ erf(x_{i}) \f$ in \p y[i] for each of the \p n values \p x.
+ * \ingroup Finance
+ */
+void erf_batch(const double* x, double* y, const int n);
+void erf_batch(const float* x, float* y, const int n);
+
+/**
+ * \brief Stores \f$ erfc(x_{i}) \f$ in \p y[i] for each of the \p n values \p x.
+ * \ingroup Finance
+ */
+void erfc_batch(const double* x, double* y, const int n);
+void erfc_batch(const float* x, float* y, const int n);
+
+/**
+ * \brief Stores the standard normal distribution \f$ N(x_{i}) \f$ in \p y[i] for each of the
+ *        \p n values \p x.
+ * \ingroup Finance
+ */
+void normal_cdf_batch(const double* x, double* y, const int n);
+void normal_cdf_batch(const float* x, float* y, const int n);
+
+/**
+ * \brief Stores in \p z[i] the standard normal quantile of the uniform \p u[i], for each of the
+ *        \p n values: turns uniform variates into normal ones.
+ * \ingroup Finance
+ *
+ * \par
+ *      See vmath::normal_quantile(): Wichura's AS 241, accurate to a few ulp. 0 and 1 map to minus
+ *      and plus infinity.
+ */
+void normals_batch(const double* u, double* z, const int n);
+void normals_batch(const float* u, float* z, const int n);
+
+/**
+ * \brief Stores \f$ \sin x_{i} \f$ in \p s[i] and \f$ \cos x_{i} \f$ in \p c[i] for each of the
+ *        \p n values \p x.
+ * \ingroup Finance
+ *
+ * \par
+ *      See vmath::sincos(): accurate for \f$ |x| \f$ up to about 1.6e6.
+ */
+void sincos_batch(const double* x, double* s, double* c, const int n);
+void sincos_batch(const float* x, float* s, float* c, const int n);
+
+/**
+ * \brief Computes the mean and variance of each window of \p window consecutive values of the
+ *        \p n values \p x.
+ * \ingroup Finance
+ *
+ * \par
+ *      \p mean and \p variance receive \p n - \p window + 1 values each, the statistics of
+ *      \p x[i] ... \p x[i + \p window - 1] at \p i. Each window is summed afresh, in two passes for
+ *      the variance (divided by \p window - 1), so no error builds up along the series; the cost
+ *      is \f$ O(n \cdot window) \f$, spread over the SIMD lanes.
+ *
+ * \exception std::invalid_argument if \p window is not in [2, \p n].
+ */
+void rolling_moments(const double* x, const int n, const int window, double* mean, double* variance);
+
+}
@@ -0,0 +1,192 @@
+/**
+ * \file
+ * The finance::BlackScholes class prices European options with the Black-Scholes formula, one
+ * at a time or for a whole option chain.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <stdexcept>
+
+#include <batch_kernels.hpp>
+#include <volatility_surface.hpp>
+
+
+
+namespace finance {
+
+namespace detail {
+
+/**
+ * Call prices of a chain: a plain loop, and for float and double one log_batch() over the
+ * strikes and one normal_cdf_batch() over every \f$ d_{1} \f$ and \f$ d_{2} \f$ of the chain.
+ */
+template <class T>
+void call_chain(const T forward_spot,
+                const T discount,
+                const T log_forward,
+                const T sqrt_t,
+                const std::vector<T>& strikes,
+                const std::vector<T>& vols,
+                std::vector<T>& prices)
+{
+    prices.resize(strikes.size());
+    for (std::size_t i = 0; i < strikes.size(); i++) {
+        const T sd = vols[i] * sqrt_t;
+        const T d1 = (log_forward - log(strikes[i])) / sd + T(0.5) * sd;
+        prices[i] = forward_spot * T(0.5) * erfc(-d1 * T(0.70710678118654752440))
+                  - strikes[i] * discount * T(0.5) * erfc((sd - d1) * T(0.70710678118654752440));
+    }
+}
+
+template <class T>
+void call_chain_batch(const T forward_spot,
+                      const T discount,
+                      const T log_forward,
+                      const T sqrt_t,
+                      const std::vector<T>& strikes,
+                      const std::vector<T>& vols,
+                      std::vector<T>& prices)
+{
+    const int n = static_cast<int>(strikes.size());
+    std::vector<T> d(2 * n);
+    prices.resize(n);
+    log_batch(strikes.data(), prices.data(), n);
+    for (int i = 0; i < n; i++) {
+        const T sd = vols[i] * sqrt_t;
+        d[i] = (log_forward - prices[i]) / sd + T(0.5) * sd;
+        d[n + i] = d[i] - sd;
+    }
+    normal_cdf_batch(d.data(), d.data(), 2 * n);
+    for (int i = 0; i < n; i++)
+        prices[i] = forward_spot * d[i] - strikes[i] * discount * d[n + i];
+}
+
+inline void call_chain(const double forward_spot,
+                       const double discount,
+                       const double log_forward,
+                       const double sqrt_t,
+                       const std::vector<double>& strikes,
+                       const std::vector<double>& vols,
+                       std::vector<double>& prices)
+{
+    call_chain_batch(forward_spot, discount, log_forward, sqrt_t, strikes, vols, prices);
+}
+
+inline void call_chain(const float forward_spot,
+                       const float discount,
+                       const float log_forward,
+                       const float sqrt_t,
+                       const std::vector<float>& strikes,
+                       const std::vector<float>& vols,
+                       std::vector<float>& prices)
+{
+    call_chain_batch(forward_spot, discount, log_forward, sqrt_t, strikes, vols, prices);
+}
+
+}
+
+/**
+ * \brief The BlackScholes class prices European calls and puts.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par The Black-Scholes formula.
+ *      With \f$ d_{1} = \frac{\ln(S/K) + (r - q + \frac{1}{2}\sigma^{2})t}{\sigma\sqrt{t}} \f$ and
+ *      \f$ d_{2} = d_{1} - \sigma\sqrt{t} \f$:
+ *
+ *      \f$ C = Se^{-qt}N(d_{1}) - Ke^{-rt}N(d_{2}) \f$
+ *
+ *      \f$ P = Ke^{-rt}N(-d_{2}) - Se^{-qt}N(-d_{1}) \f$
+ */
+template <class T>
+class BlackScholes
+{
+public:
+    /**
+     * \brief Returns the standard normal cumulative distribution \f$ N(x) \f$.
+     */
+    T normal_cdf(const T x) const
+    {
+        return T(0.5) * erfc(-x * T(0.70710678118654752440));
+    }
+
+    T call(const T spot,
+           const T strike,
+           const T r,
+           const T q,
+           const T sigma,
+           const T t) const
+    {
+        const T sd = sigma * sqrt(t);
+        const T d1 = (log(spot / strike) + (r - q) * t) / sd + T(0.5) * sd;
+        return spot * exp(-q * t) * normal_cdf(d1) - strike * exp(-r * t) * normal_cdf(d1 - sd);
+    }
+
+    T put(const T spot,
+          const T strike,
+          const T r,
+          const T q,
+          const T sigma,
+          const T t) const
+    {
+        const T sd = sigma * sqrt(t);
+        const T d1 = (log(spot / strike) + (r - q) * t) / sd + T(0.5) * sd;
+        return strike * exp(-r * t) * normal_cdf(sd - d1) - spot * exp(-q * t) * normal_cdf(-d1);
+    }
+
+    /**
+     * \brief Prices the calls of a chain of one expiry.
+     *
+     * \par
+     *      For float and double the whole chain goes through the batch kernels: one log_batch()
+     *      over the strikes and one normal_cdf_batch() over both \f$ d_{1} \f$ and \f$ d_{2} \f$.
+     *
+     * \param spot      Spot price \f$ S \f$.
+     * \param r         Constant interest rate, continuously compounded.
+     * \param q         Constant dividend yield, continuously compounded.
+     * \param t         Time to expiry.
+     * \param strikes   Strikes of the chain.
+     * \param vols      Volatility of each strike.
+     * \param prices    Output prices, one per strike.
+     * \exception std::invalid_argument if parameter sizes differ.
+     */
+    void call_prices(const T spot,
+                     const T r,
+                     const T q,
+                     const T t,
+                     const std::vector<T>& strikes,
+                     const std::vector<T>& vols,
+                     std::vector<T>& prices) const
+    {
+        if (strikes.size() != vols.size())
+            throw std::invalid_argument("sizes differ");
+
+        const T sqrt_t = sqrt(t);
+        const T forward_spot = spot * exp(-q * t);
+        const T discount = exp(-r * t);
+        const T log_forward = log(spot) + (r - q) * t;
+        detail::call_chain(forward_spot, discount, log_forward, sqrt_t, strikes, vols, prices);
+    }
+
+    /**
+     * \brief Prices the calls of a chain of one expiry with volatilities read from \p surface.
+     *
+     * \par
+     *      The whole chain is queried in one call to VolatilitySurface::volatilities().
+     */
+    void call_prices(const VolatilitySurface<T>& surface,
+                     const T t,
+                     const std::vector<T>& strikes,
+                     std::vector<T>& prices) const
+    {
+        std::vector<T> vols;
+        surface.volatilities(t, strikes, vols);
+        call_prices(surface.get_spot(), surface.get_rate(), surface.get_dividend_yield(), t, strikes, vols, prices);
+    }
+};
+
+}
@@ -0,0 +1,124 @@
+/**
+ * \file
+ * The finance::BoundedQueue class is a fixed capacity lock-free queue to hand data between
+ * threads.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <stdexcept>
+
+
+
+namespace finance {
+
+/**
+ * \brief The BoundedQueue class is a multi-producer multi-consumer lock-free ring buffer.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of the elements (copy assignable).
+ *
+ * \par
+ *      Each cell carries a sequence number that tells producers and consumers whether it is
+ *      free or full for the current lap of the ring (D. Vyukov's bounded queue). Pushing and
+ *      popping cost one compare-and-swap on the shared position in the common case and never
+ *      block: try_push() fails when the queue is full and try_pop() when it is empty, so a
+ *      slow consumer can never stall the producers.
+ */
+template <class T>
+class BoundedQueue
+{
+public:
+    /**
+     * \param capacity  Number of cells (a power of two).
+     * \exception std::invalid_argument if \p capacity is not a power of two.
+     */
+    explicit BoundedQueue(const std::size_t capacity)
+        : cells(new Cell[capacity]),
+          mask(capacity - 1),
+          enqueue_pos(0),
+          dequeue_pos(0)
+    {
+        if (capacity < 2 or (capacity & (capacity - 1)) != 0)
+            throw std::invalid_argument("capacity must be a power of two");
+        for (std::size_t i = 0; i < capacity; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    /**
+     * \brief Appends \p value.
+     * \return false if the queue is full.
+     */
+    bool try_push(const T& value)
+    {
+        Cell* cell;
+        std::size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \brief Removes the oldest element into \p value.
+     * \return false if the queue is empty.
+     */
+    bool try_pop(T& value)
+    {
+        Cell* cell;
+        std::size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells[pos & mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->data;
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<std::size_t> sequence;
+        T data;
+    };
+
+    BoundedQueue(const BoundedQueue&);
+    BoundedQueue& operator =(const BoundedQueue&);
+
+    std::unique_ptr<Cell[]> cells;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueue_pos;
+    alignas(64) std::atomic<std::size_t> dequeue_pos;
+};
+
+}
@@ -0,0 +1,224 @@
+/**
+ * \file
+ * The finance::CarrMadanPricer class prices European calls on a whole strike grid with one fast
+ * Fourier transform.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <algorithm>
+#include <stdexcept>
+
+#include <fft.hpp>
+#include <batch_kernels.hpp>
+#include <characteristic_functions.hpp>
+
+
+
+namespace finance {
+
+namespace detail {
+
+/**
+ * Replaces each \p x[j] by \f$ e^{x_{j}}w_{j} \f$: a plain loop, and for float and double the
+ * real parts and imaginary parts split apart and sent through exp_batch() and sincos_batch().
+ */
+template <class T>
+void complex_exp_weighted(std::vector<std::complex<T>>& x, const std::vector<std::complex<T>>& weights)
+{
+    for (std::size_t j = 0; j < x.size(); j++) {
+        const T m = exp(x[j].real());
+        x[j] = std::complex<T>(m * cos(x[j].imag()), m * sin(x[j].imag())) * weights[j];
+    }
+}
+
+template <class T>
+void complex_exp_weighted_batch(std::vector<std::complex<T>>& x, const std::vector<std::complex<T>>& weights)
+{
+    const int n = static_cast<int>(x.size());
+    std::vector<T> modulus(n);
+    std::vector<T> s(n);
+    std::vector<T> c(n);
+    for (int j = 0; j < n; j++) {
+        modulus[j] = x[j].real();
+        s[j] = x[j].imag();
+    }
+    exp_batch(modulus.data(), modulus.data(), n);
+    sincos_batch(s.data(), s.data(), c.data(), n);
+    for (int j = 0; j < n; j++)
+        x[j] = std::complex<T>(modulus[j] * c[j], modulus[j] * s[j]) * weights[j];
+}
+
+inline void complex_exp_weighted(std::vector<std::complex<double>>& x, const std::vector<std::complex<double>>& weights)
+{
+    complex_exp_weighted_batch(x, weights);
+}
+
+inline void complex_exp_weighted(std::vector<std::complex<float>>& x, const std::vector<std::complex<float>>& weights)
+{
+    complex_exp_weighted_batch(x, weights);
+}
+
+}
+
+/**
+ * \brief The CarrMadanPricer class prices European calls for every strike of an expiry from the
+ *        characteristic function of the log price.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par The Carr-Madan method.
+ *      Let \f$ \kappa = \ln(K/F) \f$ be the log moneyness and \f$ \phi \f$ the characteristic
+ *      function of \f$ \ln(S_{t}/F) \f$. The damped call price \f$ e^{\alpha\kappa}C \f$ is square
+ *      integrable and its Fourier transform is known in closed form:
+ *
+ *      \f$ \psi(v) = \frac{e^{-rt}\phi(v - (\alpha + 1)i)}{\alpha^{2} + \alpha - v^{2} + i(2\alpha + 1)v} \f$
+ * \par
+ *      so that \f$ C(\kappa) = F\frac{e^{-\alpha\kappa}}{\pi}\int_{0}^{\infty}Re\lbrack e^{-iv\kappa}\psi(v)\rbrack dv \f$.
+ *      Discretizing with \f$ v_{j} = j\eta \f$ and Simpson weights on the log moneyness grid
+ *      \f$ \kappa_{u} = -b + \lambda u \f$, with \f$ \lambda\eta = 2\pi/N \f$ and \f$ b = N\lambda/2 \f$,
+ *      turns the integral into one discrete Fourier transform of size \f$ N \f$ that gives all the
+ *      \f$ N \f$ strikes at once in \f$ O(N\log N) \f$.
+ * \par
+ *      Everything that depends only on the grid (frequencies, Simpson weights, the
+ *      \f$ e^{ivb} \f$ shifts, the denominators of \f$ \psi \f$ and the damping factors) is computed
+ *      once at construction. Pricing a grid costs one batch evaluation of the characteristic
+ *      function, one batch of complex exponentials (exp_batch() and sincos_batch() for float and
+ *      double) and one transform.
+ */
+template <class T>
+class CarrMadanPricer
+{
+public:
+    /**
+     * \param n         Number of grid points (a power of two).
+     * \param eta       Spacing \f$ \eta \f$ of the frequency grid.
+     * \param alpha     Damping factor \f$ \alpha \f$.
+     * \exception std::invalid_argument if \p n is not a power of two.
+     */
+    explicit CarrMadanPricer(const int n = 4096,
+                             const T eta = 0.25,
+                             const T alpha = 1.5)
+        : fft(n),
+          frequencies(n),
+          weights(n),
+          log_moneyness(n),
+          damping(n)
+    {
+        const T pi = acos(T(-1));
+        const std::complex<T> i(0, 1);
+        lambda = 2 * pi / (n * eta);
+        const T b = n * lambda / 2;
+
+        for (int j = 0; j < n; j++) {
+            const T v = j * eta;
+            const T simpson = (j == 0) ? T(1) : ((j % 2 == 1) ? T(4) : T(2));
+            const std::complex<T> den(alpha * alpha + alpha - v * v, (2 * alpha + 1) * v);
+            frequencies[j] = std::complex<T>(v, -(alpha + 1));
+            weights[j] = (eta / 3) * simpson * std::exp(i * v * b) / den;
+            log_moneyness[j] = -b + lambda * j;
+            damping[j] = exp(-alpha * log_moneyness[j]) / pi;
+        }
+    }
+
+    int size() const
+    {
+        return fft.size();
+    }
+
+    /**
+     * \brief Returns the spacing \f$ \lambda \f$ of the log moneyness grid.
+     */
+    T get_log_strike_spacing() const
+    {
+        return lambda;
+    }
+
+    /**
+     * \brief Prices calls on the whole strike grid of one expiry.
+     *
+     * \param model     Model providing <tt>log_characteristic</tt>.
+     * \param spot      Spot price \f$ S_{0} \f$.
+     * \param r         Constant interest rate, continuously compounded.
+     * \param q         Constant dividend yield, continuously compounded.
+     * \param t         Time to expiry.
+     * \param strikes   Output strikes \f$ K_{u} = Fe^{\kappa_{u}} \f$, increasing.
+     * \param calls     Output call prices, one per strike.
+     */
+    template <class Model>
+    void price_grid(const Model& model,
+                    const T spot,
+                    const T r,
+                    const T q,
+                    const T t,
+                    std::vector<T>& strikes,
+                    std::vector<T>& calls) const
+    {
+        const int n = size();
+        std::vector<std::complex<T>> x;
+        model.log_characteristic(frequencies, t, x);
+
+        detail::complex_exp_weighted(x, weights);
+        fft.forward(x);
+
+        const T forward = spot * exp((r - q) * t);
+        const T scale = forward * exp(-r * t);
+        strikes.resize(n);
+        calls.resize(n);
+        for (int u = 0; u < n; u++) {
+            strikes[u] = forward * exp(log_moneyness[u]);
+            calls[u] = std::max(T(0), scale * damping[u] * x[u].real());
+        }
+    }
+
+    /**
+     * \brief Prices calls at arbitrary \p strikes of one expiry.
+     *
+     * \par
+     *      The grid is priced once with price_grid() and the prices are interpolated with cubic
+     *      Lagrange polynomials in log strike.
+     * \exception std::domain_error if a strike is outside the grid.
+     */
+    template <class Model>
+    void price_strikes(const Model& model,
+                       const T spot,
+                       const T r,
+                       const T q,
+                       const T t,
+                       const std::vector<T>& strikes,
+                       std::vector<T>& calls) const
+    {
+        std::vector<T> grid_strikes;
+        std::vector<T> grid_calls;
+        price_grid(model, spot, r, q, t, grid_strikes, grid_calls);
+
+        const T forward = spot * exp((r - q) * t);
+        const T k0 = log_moneyness.front();
+        calls.resize(strikes.size());
+        for (std::size_t i = 0; i < strikes.size(); i++) {
+            const T pos = (log(strikes[i] / forward) - k0) / lambda;
+            const int u = static_cast<int>(floor(pos));
+            if (u < 1 or u + 2 >= size())
+                throw std::domain_error("strike outside the grid");
+            const T w = pos - u;
+            calls[i] = - w * (w - 1) * (w - 2) / 6 * grid_calls[u-1]
+                       + (w + 1) * (w - 1) * (w - 2) / 2 * grid_calls[u]
+                       - (w + 1) * w * (w - 2) / 2 * grid_calls[u+1]
+                       + (w + 1) * w * (w - 1) / 6 * grid_calls[u+2];
+        }
+    }
+
+private:
+    Fft<T> fft;
+    T lambda;
+    std::vector<std::complex<T>> frequencies;
+    std::vector<std::complex<T>> weights;
+    std::vector<T> log_moneyness;
+    std::vector<T> damping;
+};
+
+}
@@ -0,0 +1,165 @@
+/**
+ * \file
+ * Characteristic functions of the log price under risk neutral models, for use with
+ * finance::CarrMadanPricer.
+ *
+ * Every model provides
+ *
+ *     void log_characteristic(const std::vector<std::complex<T>>& u, const T t,
+ *                             std::vector<std::complex<T>>& out) const;
+ *
+ * filling \c out with \f$ \ln E\lbrack e^{iuy_{t}}\rbrack \f$ for \f$ y_{t} = \ln(S_{t}/F_{t}) \f$,
+ * the log price relative to the forward. The whole frequency grid is evaluated in one call so
+ * the terms depending only on \f$ t \f$ are computed once per grid.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <complex>
+
+
+
+namespace finance {
+
+/**
+ * \brief The GeometricBrownianModel class is the Black-Scholes model with constant volatility.
+ * \ingroup Finance
+ *
+ * \par
+ *      \f$ \ln\phi(u) = -\frac{1}{2}\sigma^{2}t(iu + u^{2}) \f$
+ */
+template <class T>
+class GeometricBrownianModel
+{
+public:
+    explicit GeometricBrownianModel(const T sigma)
+        : sigma{sigma}
+    {}
+
+    void log_characteristic(const std::vector<std::complex<T>>& u,
+                            const T t,
+                            std::vector<std::complex<T>>& out) const
+    {
+        const std::complex<T> i(0, 1);
+        const T half_var = T(0.5) * sigma * sigma * t;
+        out.resize(u.size());
+        for (std::size_t j = 0; j < u.size(); j++)
+            out[j] = -half_var * (i * u[j] + u[j] * u[j]);
+    }
+
+private:
+    T sigma;
+};
+
+/**
+ * \brief The HestonModel class is the Heston (1993) stochastic volatility model.
+ * \ingroup Finance
+ *
+ * \par
+ *      The variance follows \f$ dv = \kappa(\theta - v)dt + \sigma\sqrt{v}dW_{v} \f$ with correlation
+ *      \f$ \rho \f$ to the price. With \f$ \xi = \kappa - \rho\sigma iu \f$,
+ *      \f$ d = \sqrt{\xi^{2} + \sigma^{2}(iu + u^{2})} \f$ and \f$ g = (\xi - d)/(\xi + d) \f$:
+ *
+ *      \f$ \ln\phi(u) = \frac{\kappa\theta}{\sigma^{2}}\left\lbrack(\xi - d)t - 2\ln\frac{1 - ge^{-dt}}{1 - g}\right\rbrack + \frac{v_{0}}{\sigma^{2}}\frac{(\xi - d)(1 - e^{-dt})}{1 - ge^{-dt}} \f$
+ * \par
+ *      This is the formulation of Albrecher et al. (2007), which avoids the branch cut
+ *      discontinuity of the complex logarithm for long maturities.
+ */
+template <class T>
+class HestonModel
+{
+public:
+    /**
+     * \param v0        Initial variance.
+     * \param kappa     Mean reversion speed of the variance.
+     * \param theta     Long run variance.
+     * \param sigma     Volatility of the variance.
+     * \param rho       Correlation between the price and the variance.
+     */
+    HestonModel(const T v0,
+                const T kappa,
+                const T theta,
+                const T sigma,
+                const T rho)
+        : v0{v0},
+          kappa{kappa},
+          theta{theta},
+          sigma{sigma},
+          rho{rho}
+    {}
+
+    void log_characteristic(const std::vector<std::complex<T>>& u,
+                            const T t,
+                            std::vector<std::complex<T>>& out) const
+    {
+        typedef std::complex<T> complex;
+        const complex i(0, 1);
+        const T sigma2 = sigma * sigma;
+        const T a = kappa * theta / sigma2;
+        const T b = v0 / sigma2;
+
+        out.resize(u.size());
+        for (std::size_t j = 0; j < u.size(); j++) {
+            const complex iu = i * u[j];
+            const complex xi = kappa - rho * sigma * iu;
+            const complex d  = std::sqrt(xi * xi + sigma2 * (iu + u[j] * u[j]));
+            const complex g  = (xi - d) / (xi + d);
+            const complex e  = std::exp(-d * t);
+            const complex ge = T(1) - g * e;
+            out[j] = a * ((xi - d) * t - T(2) * std::log(ge / (T(1) - g)))
+                   + b * (xi - d) * (T(1) - e) / ge;
+        }
+    }
+
+private:
+    T v0;
+    T kappa;
+    T theta;
+    T sigma;
+    T rho;
+};
+
+/**
+ * \brief The VarianceGammaModel class is the variance gamma pure jump model of Madan, Carr and
+ *        Chang (1998).
+ * \ingroup Finance
+ *
+ * \par
+ *      \f$ \ln\phi(u) = iu\omega t - \frac{t}{\nu}\ln(1 - iu\theta\nu + \frac{1}{2}\sigma^{2}\nu u^{2}) \f$
+ *      with the martingale correction \f$ \omega = \frac{1}{\nu}\ln(1 - \theta\nu - \frac{1}{2}\sigma^{2}\nu) \f$.
+ */
+template <class T>
+class VarianceGammaModel
+{
+public:
+    VarianceGammaModel(const T sigma,
+                       const T nu,
+                       const T theta)
+        : sigma{sigma},
+          nu{nu},
+          theta{theta}
+    {}
+
+    void log_characteristic(const std::vector<std::complex<T>>& u,
+                            const T t,
+                            std::vector<std::complex<T>>& out) const
+    {
+        const std::complex<T> i(0, 1);
+        const T omega = log(T(1) - theta * nu - T(0.5) * sigma * sigma * nu) / nu;
+        out.resize(u.size());
+        for (std::size_t j = 0; j < u.size(); j++) {
+            const std::complex<T> iu = i * u[j];
+            out[j] = iu * omega * t
+                   - (t / nu) * std::log(T(1) - iu * theta * nu + T(0.5) * sigma * sigma * nu * u[j] * u[j]);
+        }
+    }
+
+private:
+    T sigma;
+    T nu;
+    T theta;
+};
+
+}
@@ -0,0 +1,64 @@
+/**
+ * \file
+ * Instruction set levels of the batch kernels, detected once from cpuid so one binary runs the
+ * best code path of each host.
+ */
+
+#pragma once
+
+/**
+ * Defined where kernels can be compiled for several levels: GCC and Clang on x86. Elsewhere only
+ * the Generic level exists.
+ */
+#if defined(__GNUC__) and (defined(__x86_64__) or defined(__i386__))
+#define FINANCE_ISA_DISPATCH 1
+#endif
+
+
+
+namespace finance {
+
+/**
+ * \brief Instruction set levels the batch kernels are compiled for, from the lowest.
+ * \ingroup Finance
+ *
+ * \par
+ *      Generic is the compiler's default target: SSE2 on x86-64 and the only level elsewhere.
+ *      Avx2 adds AVX2 and FMA (Haswell and later), Avx512 the AVX-512 foundation instructions.
+ */
+enum class Isa
+{
+    Generic,
+    Avx2,
+    Avx512
+};
+
+/**
+ * \brief Returns the highest level the processor and operating system support.
+ */
+Isa detected_isa();
+
+/**
+ * \brief Returns the level the batch kernels run at.
+ *
+ * \par
+ *      On first use it is the detected level, lowered to the one named by the environment
+ *      variable FINANCE_ISA if set: <tt>generic</tt>, <tt>avx2</tt> or <tt>avx512</tt>. Pinning the
+ *      level makes the results bitwise identical across hosts: sums are split in as many lanes as
+ *      a register holds and FMA rounds differently, so levels differ in the last bits.
+ */
+Isa active_isa();
+
+/**
+ * \brief Forces the level the batch kernels run at, for tests and comparisons.
+ *
+ * \return false, leaving the level unchanged, if \p isa is not supported by this host.
+ */
+bool set_isa(const Isa isa);
+
+/**
+ * \brief Returns the name of \p isa as FINANCE_ISA spells it.
+ */
+const char* isa_name(const Isa isa);
+
+}
@@ -0,0 +1,557 @@
+/**
+ * \file
+ * The finance::CreditDefaultSwap class prices the legs of a credit default swap and
+ * finance::CdsBootstrapper builds finance::HazardCurve objects from quoted par spreads.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include <hazard_curve.hpp>
+#include <latency_histogram.hpp>
+#include <present_value.hpp>
+#include <solver_statistics.hpp>
+#include <parallel.hpp>
+#include <trace.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief Builds the premium payment times of a CDS paying \p frequency times per year up to
+ *        \p maturity. The last period is a short stub if the maturity is not on the grid.
+ */
+template <class T>
+std::vector<T> cds_payment_times(const T maturity, const int frequency)
+{
+    if (maturity <= T(0) or frequency <= 0)
+        throw std::invalid_argument("maturity and frequency must be positive");
+
+    const T step = T(1) / frequency;
+    std::vector<T> times;
+    for (int j = 1; j * step < maturity - step * T(1e-6); j++)
+        times.push_back(j * step);
+    times.push_back(maturity);
+    return times;
+}
+
+/**
+ * \brief The CreditDefaultSwap class values the premium and protection legs of a credit default
+ *        swap given a finance::HazardCurve and a flat continuously compounded interest rate.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Premium leg.
+ *      The protection buyer pays a spread \f$ s \f$ at times \f$ t_{1},...,t_{n} \f$ while the name
+ *      survives. If default happens inside a period the accrued premium is paid, which we
+ *      approximate as half the period. With \f$ \Delta_{i} = t_{i} - t_{i-1} \f$ the leg is
+ *
+ *      \f$ PL = s \sum_{i=1}^{n}\Delta_{i}e^{-rt_{i}}\frac{S(t_{i-1})+S(t_{i})}{2} = s \cdot RPV01 \f$
+ * \par Protection leg.
+ *      On default the seller pays the loss \f$ 1-R \f$. Assuming defaults in the middle of each
+ *      period the leg is
+ *
+ *      \f$ DL = (1-R)\sum_{i=1}^{n}e^{-r\frac{t_{i-1}+t_{i}}{2}}(S(t_{i-1})-S(t_{i})) \f$
+ * \par
+ *      Both legs are discounted with finance::PresentValue::pv_continuous_cflow. The par spread is
+ *      the spread making both legs equal, \f$ s_{par} = DL / RPV01 \f$.
+ */
+template <class T>
+class CreditDefaultSwap
+{
+public:
+    /**
+     * \param maturity      Maturity of the contract in years.
+     * \param recovery_rate Expected recovery \f$ R \f$ on default.
+     * \param frequency     Number of premium payments per year.
+     */
+    CreditDefaultSwap(const T maturity,
+                      const T recovery_rate,
+                      const int frequency = 4)
+        : maturity{maturity},
+          recovery_rate{recovery_rate},
+          frequency{frequency},
+          payment_times(cds_payment_times(maturity, frequency)),
+          default_times(payment_times.size())
+    {
+        T t_prev = 0.0;
+        for (std::size_t i = 0; i < payment_times.size(); i++) {
+            default_times[i] = T(0.5) * (t_prev + payment_times[i]);
+            t_prev = payment_times[i];
+        }
+    }
+
+    T get_maturity() const
+    {
+        return maturity;
+    }
+
+    T get_recovery_rate() const
+    {
+        return recovery_rate;
+    }
+
+    int get_frequency() const
+    {
+        return frequency;
+    }
+
+    const std::vector<T>& get_payment_times() const
+    {
+        return payment_times;
+    }
+
+    /**
+     * \brief Calculates the risky annuity (the premium leg for a unit spread).
+     *
+     * \param curve         Survival curve of the reference name.
+     * \param r             Constant interest rate, continuously compounded.
+     * \param buffer        If not null, holds the discounted amounts instead of a temporary, so
+     *                      a caller repricing in a loop allocates nothing.
+     * \return              The calculated RPV01.
+     */
+    T risky_annuity(const HazardCurve<T>& curve,
+                    const T r,
+                    std::vector<T>* buffer = nullptr) const
+    {
+        std::vector<T> local;
+        std::vector<T>& amounts = buffer ? *buffer : local;
+        amounts.resize(payment_times.size());
+        T t_prev = 0.0;
+        T s_prev = 1.0;
+        for (std::size_t i = 0; i < amounts.size(); i++) {
+            const T s = curve.survival_probability(payment_times[i]);
+            amounts[i] = (payment_times[i] - t_prev) * T(0.5) * (s_prev + s);
+            t_prev = payment_times[i];
+            s_prev = s;
+        }
+        PresentValue<T> pv;
+        return pv.pv_continuous_cflow(payment_times, amounts, r);
+    }
+
+    /**
+     * \brief Calculates the present value of the premium leg paying \p spread per year.
+     */
+    T premium_leg(const HazardCurve<T>& curve,
+                  const T r,
+                  const T spread,
+                  std::vector<T>* buffer = nullptr) const
+    {
+        return spread * risky_annuity(curve, r, buffer);
+    }
+
+    /**
+     * \brief Calculates the present value of the protection (default) leg.
+     *
+     * \param curve         Survival curve of the reference name.
+     * \param r             Constant interest rate, continuously compounded.
+     * \param buffer        As in risky_annuity().
+     * \return              The calculated present value.
+     */
+    T protection_leg(const HazardCurve<T>& curve,
+                     const T r,
+                     std::vector<T>* buffer = nullptr) const
+    {
+        std::vector<T> local;
+        std::vector<T>& amounts = buffer ? *buffer : local;
+        amounts.resize(payment_times.size());
+        T s_prev = 1.0;
+        for (std::size_t i = 0; i < amounts.size(); i++) {
+            const T s = curve.survival_probability(payment_times[i]);
+            amounts[i] = (1 - recovery_rate) * (s_prev - s);
+            s_prev = s;
+        }
+        PresentValue<T> pv;
+        return pv.pv_continuous_cflow(default_times, amounts, r);
+    }
+
+    /**
+     * \brief Calculates the spread that makes the value of the contract zero.
+     */
+    T par_spread(const HazardCurve<T>& curve,
+                 const T r,
+                 std::vector<T>* buffer = nullptr) const
+    {
+        return protection_leg(curve, r, buffer) / risky_annuity(curve, r, buffer);
+    }
+
+    /**
+     * \brief Calculates the value of the contract for the protection buyer paying \p spread.
+     */
+    T value(const HazardCurve<T>& curve,
+            const T r,
+            const T spread,
+            std::vector<T>* buffer = nullptr) const
+    {
+        return protection_leg(curve, r, buffer) - premium_leg(curve, r, spread, buffer);
+    }
+
+private:
+    T maturity;
+    T recovery_rate;
+    int frequency;
+    std::vector<T> payment_times;
+    std::vector<T> default_times;
+};
+
+/**
+ * \brief The CdsBootstrapper class builds the hazard curve of one name from the par spreads of
+ *        CDS quoted at a set of tenors.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Bootstrapping.
+ *      The curve has one pillar per tenor. Pillar \f$ k \f$ is solved so the CDS maturing at
+ *      \f$ T_{k} \f$ reprices to its quoted spread, with pillars \f$ 1..k-1 \f$ already fixed. Payment
+ *      periods ending before \f$ T_{k-1} \f$ do not depend on \f$ \lambda_{k} \f$, so their
+ *      contribution to both legs is summed once per pillar and only the periods after
+ *      \f$ T_{k-1} \f$ are evaluated inside the root finder. Discount factors of every schedule are
+ *      computed once per interest rate.
+ * \par Incremental updates.
+ *      Pillar \f$ k \f$ depends only on the quotes of tenors \f$ \le T_{k} \f$, so when a quote
+ *      changes only that pillar and the ones after it are solved again. Unchanged quotes cost
+ *      nothing.
+ */
+template <class T>
+class CdsBootstrapper
+{
+public:
+    /**
+     * \param tenors        Increasing maturities of the quoted contracts.
+     * \param recovery_rate Expected recovery \f$ R \f$ on default.
+     * \param r             Constant interest rate, continuously compounded.
+     * \param frequency     Number of premium payments per year.
+     */
+    CdsBootstrapper(const std::vector<T>& tenors,
+                    const T recovery_rate,
+                    const T r,
+                    const int frequency = 4)
+        : tenors{tenors},
+          recovery_rate{recovery_rate},
+          rate{r},
+          frequency{frequency},
+          solved_pillars{0}
+    {
+        if (tenors.empty())
+            throw std::invalid_argument("no tenors");
+        for (std::size_t k = 1; k < tenors.size(); k++)
+            if (tenors[k] <= tenors[k-1])
+                throw std::invalid_argument("tenors must be increasing");
+        build_schedules();
+    }
+
+    const HazardCurve<T>& get_curve() const
+    {
+        return curve;
+    }
+
+    const std::vector<T>& get_par_spreads() const
+    {
+        return spreads;
+    }
+
+    const std::vector<T>& get_tenors() const
+    {
+        return tenors;
+    }
+
+    /**
+     * \brief Number of pillars solved by the last call to bootstrap() or update_spread().
+     */
+    int get_last_resolved() const
+    {
+        return last_resolved;
+    }
+
+    /**
+     * \brief Convergence statistics of each pillar solved by the last call to bootstrap() or
+     *        update_spread(), in pillar order.
+     */
+    const std::vector<SolverStatistics>& get_solver_statistics() const
+    {
+        return statistics;
+    }
+
+    /**
+     * \brief Changes the interest rate. Every pillar is solved again on the next bootstrap().
+     */
+    void set_rate(const T r)
+    {
+        if (r == rate) return;
+        rate = r;
+        build_schedules();
+        solved_pillars = 0;
+    }
+
+    /**
+     * \brief Builds the curve from \p par_spreads, one per tenor.
+     *
+     * \exception std::invalid_argument if there is not one spread per tenor.
+     * \exception std::domain_error if a pillar cannot be solved.
+     *
+     * \par
+     *      Only the pillars from the first changed quote onwards are solved again.
+     */
+    void bootstrap(const std::vector<T>& par_spreads)
+    {
+        if (par_spreads.size() != tenors.size())
+            throw std::invalid_argument("sizes differ");
+
+        int first = 0;
+        while (first < solved_pillars and par_spreads[first] == spreads[first])
+            first++;
+        spreads = par_spreads;
+        solve_from(first);
+    }
+
+    /**
+     * \brief Changes the quote of one tenor and solves the affected pillars.
+     */
+    void update_spread(const int pillar,
+                       const T spread)
+    {
+        if (pillar < 0 or pillar >= static_cast<int>(tenors.size()))
+            throw std::out_of_range("pillar out of range");
+        if (pillar < solved_pillars and spreads[pillar] == spread) {
+            last_resolved = 0;
+            statistics.clear();
+            return;
+        }
+        spreads.resize(tenors.size(), T(0));
+        spreads[pillar] = spread;
+        solve_from(std::min(pillar, solved_pillars));
+    }
+
+private:
+    struct Period
+    {
+        T start;
+        T end;
+        T accrual;
+        T df_end;
+        T df_mid;
+    };
+
+    /**
+     * Discount factors come from PresentValue, as in the legs of CreditDefaultSwap, so a
+     * bootstrapped curve reprices its quotes there exactly.
+     */
+    void build_schedules()
+    {
+        PresentValue<T> pv;
+        std::vector<T> mid_times;
+        std::vector<T> df_end;
+        std::vector<T> df_mid;
+        schedules.assign(tenors.size(), std::vector<Period>());
+        for (std::size_t k = 0; k < tenors.size(); k++) {
+            const std::vector<T> times = cds_payment_times(tenors[k], frequency);
+            mid_times.resize(times.size());
+            T t_prev = 0.0;
+            for (std::size_t i = 0; i < times.size(); i++) {
+                mid_times[i] = T(0.5) * (t_prev + times[i]);
+                t_prev = times[i];
+            }
+            pv.discount_factors_continuous(times, rate, df_end);
+            pv.discount_factors_continuous(mid_times, rate, df_mid);
+            t_prev = 0.0;
+            for (std::size_t i = 0; i < times.size(); i++) {
+                Period p;
+                p.start   = t_prev;
+                p.end     = times[i];
+                p.accrual = times[i] - t_prev;
+                p.df_end  = df_end[i];
+                p.df_mid  = df_mid[i];
+                schedules[k].push_back(p);
+                t_prev = times[i];
+            }
+        }
+    }
+
+    void solve_from(const int first)
+    {
+        if (curve.size() != static_cast<int>(tenors.size()))
+            curve = HazardCurve<T>(tenors, std::vector<T>(tenors.size(), T(0)));
+        statistics.clear();
+        for (int k = first; k < static_cast<int>(tenors.size()); k++)
+            curve.set_hazard_rate(k, solve_pillar(k));
+        last_resolved  = static_cast<int>(tenors.size()) - first;
+        solved_pillars = static_cast<int>(tenors.size());
+    }
+
+    T solve_pillar(const int k)
+    {
+        const T t_prev = (k == 0) ? T(0) : tenors[k-1];
+        const T s_prev = curve.survival_probability(t_prev);
+        const T loss   = 1 - recovery_rate;
+        const T spread = spreads[k];
+
+        // Periods fully inside already solved pillars are fixed.
+        T fixed_annuity = 0.0;
+        T fixed_protection = 0.0;
+        dynamic.clear();
+        for (const Period& p : schedules[k]) {
+            const T s_start = curve.survival_probability(p.start);
+            if (p.end <= t_prev) {
+                const T s_end = curve.survival_probability(p.end);
+                fixed_annuity    += p.accrual * p.df_end * T(0.5) * (s_start + s_end);
+                fixed_protection += p.df_mid * (s_start - s_end);
+            } else {
+                Dynamic d;
+                d.base_start = (p.start <= t_prev) ? s_start : s_prev;
+                d.tau_start  = std::max(T(0), p.start - t_prev);
+                d.tau_end    = p.end - t_prev;
+                d.accrual    = p.accrual;
+                d.df_end     = p.df_end;
+                d.df_mid     = p.df_mid;
+                dynamic.push_back(d);
+            }
+        }
+
+        // Survival inside the pillar under the flat trial hazard h, as HazardCurve computes it.
+        auto objective = [&](const T h) {
+            T annuity = fixed_annuity;
+            T protection = fixed_protection;
+            for (const Dynamic& d : dynamic) {
+                const T s_start = d.base_start * exp(-h * d.tau_start);
+                const T s_end   = s_prev * exp(-h * d.tau_end);
+                annuity    += d.accrual * d.df_end * T(0.5) * (s_start + s_end);
+                protection += d.df_mid * (s_start - s_end);
+            }
+            return loss * protection - spread * annuity;
+        };
+
+        const int MAX_ITERATIONS = 100;
+        const T ACCURACY = 4 * std::numeric_limits<T>::epsilon();
+        SolverStatistics stats;
+
+        // The value is increasing in the hazard, bracket the root between zero and twice the
+        // credit triangle estimate s / (1 - R), which holds it unless the curve is steep.
+        T x1 = 0.0;
+        T f1 = objective(x1);
+        stats.function_evaluations = 1;
+        if (f1 >= 0.0) {
+            stats.bracket_width = 0.0;
+            statistics.push_back(stats);
+            return x1;
+        }
+        T x2 = std::max(T(2) * spread / loss, T(1e-4));
+        T f2 = objective(x2);
+        stats.function_evaluations++;
+        for (int i = 0; i < MAX_ITERATIONS and f2 < 0.0; i++) {
+            x1 = x2;
+            f1 = f2;
+            x2 *= 2;
+            f2 = objective(x2);
+            stats.bracket_iterations++;
+            stats.function_evaluations++;
+        }
+        stats.bracket_lower = x1;
+        stats.bracket_upper = x2;
+        stats.bracket_width = x2 - x1;
+        if (f2 < 0.0) {
+            stats.failure = SolverStatistics::NoBracket;
+            statistics.push_back(stats);
+            throw std::domain_error("hazard rate not bracketed");
+        }
+
+        // Illinois variant of the false position method.
+        int side = 0;
+        for (int i = 0; i < MAX_ITERATIONS; i++) {
+            const T x = (x1 * f2 - x2 * f1) / (f2 - f1);
+            const T f = objective(x);
+            stats.iterations++;
+            stats.function_evaluations++;
+            stats.bracket_width = x2 - x1;
+            if (f == 0.0 or std::fabs(x2 - x1) < ACCURACY * std::max(T(1), std::fabs(x))) {
+                statistics.push_back(stats);
+                return x;
+            }
+            if (f < 0.0) {
+                x1 = x;
+                f1 = f;
+                if (side == -1) f2 *= T(0.5);
+                side = -1;
+            } else {
+                x2 = x;
+                f2 = f;
+                if (side == +1) f1 *= T(0.5);
+                side = +1;
+            }
+            if (std::fabs(f) < ACCURACY * spread) {
+                stats.bracket_width = x2 - x1;
+                statistics.push_back(stats);
+                return x;
+            }
+        }
+        stats.bracket_width = x2 - x1;
+        stats.failure = SolverStatistics::NotConverged;
+        statistics.push_back(stats);
+        throw std::domain_error("Solution not found");
+    }
+
+    struct Dynamic
+    {
+        T base_start;
+        T tau_start;
+        T tau_end;
+        T accrual;
+        T df_end;
+        T df_mid;
+    };
+
+    std::vector<T> tenors;
+    T recovery_rate;
+    T rate;
+    int frequency;
+    int solved_pillars;
+    int last_resolved = 0;
+    std::vector<T> spreads;
+    std::vector<std::vector<Period>> schedules;
+    std::vector<Dynamic> dynamic;
+    HazardCurve<T> curve;
+    std::vector<SolverStatistics> statistics;
+};
+
+/**
+ * \brief Bootstraps every name of a universe in parallel.
+ *
+ * \param names         One bootstrapper per name. Each keeps its previous quotes so only
+ *                      changed pillars are solved again.
+ * \param par_spreads   Quotes of each name, one per tenor.
+ * \param telemetry     If not null, receives the convergence statistics of every pillar
+ *                      solved by this batch.
+ * \exception std::invalid_argument if parameter sizes differ.
+ */
+template <class T>
+void bootstrap_universe(std::vector<CdsBootstrapper<T>>& names,
+                        const std::vector<std::vector<T>>& par_spreads,
+                        SolverTelemetry* telemetry = nullptr)
+{
+    if (names.size() != par_spreads.size())
+        throw std::invalid_argument("sizes differ");
+    FINANCE_LATENCY_SCOPE("bootstrap_universe");
+    FINANCE_TRACE_SCOPE("bootstrap_universe");
+
+    parallel_for(0, static_cast<int>(names.size()), [&](const int i) {
+        FINANCE_LATENCY_SCOPE("cds_bootstrap");
+        FINANCE_TRACE_SCOPE("cds_bootstrap");
+        names[i].bootstrap(par_spreads[i]);
+    });
+
+    if (telemetry) {
+        telemetry->clear();
+        for (const CdsBootstrapper<T>& name : names)
+            for (const SolverStatistics& s : name.get_solver_statistics())
+                telemetry->record(s);
+    }
+}
+
+}
@@ -1,7 +1,13 @@
 #pragma once
 
 #include <vector>
+#include <string>
+#include <cstdio>
 #include <utility>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
 #include <date.hpp>
 
 
@@ -10,6 +16,7 @@ class Dated
 {
 public:
     Dated();
+    Dated(const std::vector<Date>& dates, const std::vector<T>& elements);
     ~Dated();
 
     Dated(const Dated<T>& rhs);
@@ -27,13 +34,16 @@ public:
     bool contains(const Date& d) const;
     //T current_element_at(const Date& d) const;
 
-    std::vector<Date>::iterator first_date() const;
-    std::vector<Date>::iterator last_date() const;
-    typename std::vector<T>::iterator first_element() const;
-    typename std::vector<T>::iterator last_element() const;
+    void append(const Date& d, const T& element);
+    void reserve(const int n);
 
-    const std::vector<Date>& get_dates();
-    const std::vector<T>& get_elements();
+    std::vector<Date>::const_iterator first_date() const;
+    std::vector<Date>::const_iterator last_date() const;
+    typename std::vector<T>::const_iterator first_element() const;
+    typename std::vector<T>::const_iterator last_element() const;
+
+    const std::vector<Date>& get_dates() const;
+    const std::vector<T>& get_elements() const;
 
     int index_of_date(const Date& d) const;
     //int index_of_last_date_before(const date& d) const; // these are useful functions
@@ -54,6 +64,18 @@ template <typename T>
 Dated<T>::Dated()
 {}
 
+template <typename T>
+Dated<T>::Dated(const std::vector<Date>& dates, const std::vector<T>& elements)
+    : dates{dates},
+      elements{elements}
+{
+    if (dates.size() != elements.size())
+        throw std::invalid_argument("sizes differ");
+    for (int t = 1; t < size(); ++t)
+        if (not (dates[t-1] < dates[t]))
+            throw std::invalid_argument("dates not increasing");
+}
+
 template <typename T>
 Dated<T>::~Dated()
 {}
@@ -137,37 +159,53 @@ bool Dated<T>::contains(const Date &d) const
 }
 
 template <typename T>
-std::vector<Date>::iterator Dated<T>::first_date() const
+void Dated<T>::append(const Date& d, const T& element)
+{
+    if (not empty() and not (dates.back() < d))
+        throw std::invalid_argument("Date 'd' not after the last date");
+    dates.push_back(d);
+    elements.push_back(element);
+}
+
+template <typename T>
+void Dated<T>::reserve(const int n)
+{
+    dates.reserve(n);
+    elements.reserve(n);
+}
+
+template <typename T>
+std::vector<Date>::const_iterator Dated<T>::first_date() const
 {
     return dates.begin();
 }
 
 template <typename T>
-std::vector<Date>::iterator Dated<T>::last_date() const
+std::vector<Date>::const_iterator Dated<T>::last_date() const
 {
     return dates.end();
 }
 
 template <typename T>
-typename std::vector<T>::iterator Dated<T>::first_element() const
+typename std::vector<T>::const_iterator Dated<T>::first_element() const
 {
     return elements.begin();
 }
 
 template <typename T>
-typename std::vector<T>::iterator Dated<T>::last_element() const
+typename std::vector<T>::const_iterator Dated<T>::last_element() const
 {
     return elements.end();
 }
 
 template <typename T>
-const std::vector<Date>& Dated<T>::get_dates()
+const std::vector<Date>& Dated<T>::get_dates() const
 {
     return dates;
 }
 
 template <typename T>
-const std::vector<T>& Dated<T>::get_elements()
+const std::vector<T>& Dated<T>::get_elements() const
 {
     return elements;
 }
@@ -184,3 +222,42 @@ int Dated<T>::index_of_date(const Date& d) const
 
 
 // Out of class functions:
+
+/**
+ * \brief read_dated Reads a series written by write_dated().
+ * \param is Stream with one "year-month-day,element" line per date, in increasing date order.
+ * \exception std::invalid_argument if a line is malformed or dates are not increasing.
+ * \return The series read.
+ */
+template <typename T>
+Dated<T> read_dated(std::istream& is)
+{
+    Dated<T> series;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(is, line)) {
+        line_number++;
+        if (line.empty() or line[0] == '#')
+            continue;
+        int y, m, d;
+        double value;
+        if (std::sscanf(line.c_str(), "%d-%d-%d,%lf", &y, &m, &d, &value) != 4)
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": malformed");
+        series.append(Date(d, m, y), static_cast<T>(value));
+    }
+    return series;
+}
+
+/**
+ * \brief write_dated Writes \p series with one "year-month-day,element" line per date.
+ */
+template <typename T>
+void write_dated(std::ostream& os, const Dated<T>& series)
+{
+    const std::streamsize precision = os.precision(std::numeric_limits<T>::max_digits10);
+    for (int t = 0; t < series.size(); ++t) {
+        const Date d = series.date_at(t);
+        os << d.get_year() << '-' << d.get_month() << '-' << d.get_day() << ',' << series.element_at(t) << '\n';
+    }
+    os.precision(precision);
+}
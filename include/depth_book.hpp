@@ -0,0 +1,184 @@
+/**
+ * \file
+ * The finance::DepthBook class keeps the price levels of an order book updated by incremental
+ * deltas.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <market_update.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief The DepthBook class is an order book aggregated by price level on a dense tick grid.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of the quantities.
+ *
+ * \par
+ *      Prices are mapped to ticks \f$ k = (p - p_{min})/\delta \f$ on a fixed grid of \f$ n \f$ ticks,
+ *      and the quantity of each side is stored in a flat array indexed by tick. Applying a
+ *      BookDelta is one store, and the best bid and ask move incrementally: they only scan
+ *      when their own level is emptied, and then only up to the next resting level.
+ * \par
+ *      The book also records the range of ticks changed since the last call to
+ *      take_changes(), so a view redraws only the levels that moved.
+ */
+template <class T>
+class DepthBook
+{
+public:
+    /**
+     * \param min_price     Price \f$ p_{min} \f$ of tick 0.
+     * \param tick_size     Tick size \f$ \delta \f$.
+     * \param num_ticks     Number of ticks \f$ n \f$ of the grid.
+     * \exception std::invalid_argument if \p tick_size or \p num_ticks is not positive.
+     */
+    DepthBook(const double min_price,
+              const double tick_size,
+              const int num_ticks)
+        : min_price{min_price},
+          tick_size{tick_size},
+          bids(num_ticks > 0 ? num_ticks : 0),
+          asks(num_ticks > 0 ? num_ticks : 0)
+    {
+        if (tick_size <= 0.0 or num_ticks <= 0)
+            throw std::invalid_argument("tick_size and num_ticks must be positive");
+        clear();
+    }
+
+    int size() const
+    {
+        return static_cast<int>(bids.size());
+    }
+
+    double get_tick_size() const
+    {
+        return tick_size;
+    }
+
+    /**
+     * \brief Returns the tick nearest to \p price, or -1 if it is outside the grid.
+     */
+    int tick_of(const double price) const
+    {
+        const double k = std::floor((price - min_price) / tick_size + 0.5);
+        return (k >= 0.0 and k < size()) ? static_cast<int>(k) : -1;
+    }
+
+    double price_of(const int tick) const
+    {
+        return min_price + tick * tick_size;
+    }
+
+    T bid_quantity(const int tick) const
+    {
+        return bids[tick];
+    }
+
+    T ask_quantity(const int tick) const
+    {
+        return asks[tick];
+    }
+
+    /**
+     * \brief Returns the tick of the best bid, -1 if there is no bid.
+     */
+    int best_bid() const
+    {
+        return best_bid_tick;
+    }
+
+    /**
+     * \brief Returns the tick of the best ask, size() if there is no ask.
+     */
+    int best_ask() const
+    {
+        return best_ask_tick;
+    }
+
+    /**
+     * \brief Applies \p delta.
+     * \return false if the price of \p delta is outside the grid.
+     */
+    bool apply(const BookDelta& delta)
+    {
+        const int k = tick_of(delta.price);
+        if (k < 0)
+            return false;
+
+        const T quantity = std::max(T(0), static_cast<T>(delta.quantity));
+        if (delta.side == BookDelta::Bid) {
+            bids[k] = quantity;
+            if (quantity > T(0)) {
+                best_bid_tick = std::max(best_bid_tick, k);
+            } else if (k == best_bid_tick) {
+                while (best_bid_tick >= 0 and bids[best_bid_tick] == T(0))
+                    best_bid_tick--;
+            }
+        } else {
+            asks[k] = quantity;
+            if (quantity > T(0)) {
+                best_ask_tick = std::min(best_ask_tick, k);
+            } else if (k == best_ask_tick) {
+                while (best_ask_tick < size() and asks[best_ask_tick] == T(0))
+                    best_ask_tick++;
+            }
+        }
+
+        first_changed = std::min(first_changed, k);
+        last_changed  = std::max(last_changed, k);
+        return true;
+    }
+
+    /**
+     * \brief Returns the range of ticks changed since the last call and resets it.
+     *
+     * \param first     First changed tick.
+     * \param last      Last changed tick.
+     * \return          false if nothing changed.
+     */
+    bool take_changes(int& first, int& last)
+    {
+        if (first_changed > last_changed)
+            return false;
+        first = first_changed;
+        last  = last_changed;
+        first_changed = size();
+        last_changed  = -1;
+        return true;
+    }
+
+    /**
+     * \brief Removes every level.
+     */
+    void clear()
+    {
+        std::fill(bids.begin(), bids.end(), T(0));
+        std::fill(asks.begin(), asks.end(), T(0));
+        best_bid_tick = -1;
+        best_ask_tick = size();
+        first_changed = 0;
+        last_changed  = size() - 1;
+    }
+
+private:
+    double min_price;
+    double tick_size;
+    std::vector<T> bids;
+    std::vector<T> asks;
+    int best_bid_tick;
+    int best_ask_tick;
+    int first_changed;
+    int last_changed;
+};
+
+}
@@ -0,0 +1,230 @@
+/**
+ * \file
+ * A binary event log: the logging thread stores a format id and the raw arguments into its own
+ * ring buffer, a background thread writes the rings to a file in large blocks and
+ * write_event_log_text() renders the file as text afterwards.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <iostream>
+#include <type_traits>
+
+
+
+namespace finance {
+
+/**
+ * \brief Opens the event log \p path and starts the thread writing it. Events are recorded from
+ *        then on until event_log_close().
+ *
+ * \return false if a log is already open or \p path cannot be created.
+ */
+bool event_log_open(const std::string& path);
+
+/**
+ * \brief Stops recording, writes every event still buffered and closes the log.
+ *
+ * \return false if writing the file failed.
+ */
+bool event_log_close();
+
+/**
+ * \brief Returns true while a log is open.
+ */
+inline bool event_log_enabled();
+
+/**
+ * \brief Renders the log read from \p is as text, one event per line:
+ *
+ *          0.000012345 [1] book 0 bid 101.25 x 300
+ *
+ *      The time is in seconds since the log was opened and the number in brackets identifies
+ *      the logging thread. Events are ordered by time within each block the log thread wrote.
+ *
+ * \exception std::invalid_argument if \p is is not an event log or is truncated.
+ */
+void write_event_log_text(std::istream& is, std::ostream& os);
+
+namespace detail {
+
+extern std::atomic<bool> event_logging;
+
+/**
+ * Codes of the argument types stored in a record: 'i' signed and 'u' unsigned integers and 'b'
+ * booleans on 8 bytes, 'd' doubles, 's' strings as a 4 byte length and the bytes.
+ */
+template <class T, class Enable = void> struct LogArgument;
+
+template <class T>
+struct LogArgument<T, typename std::enable_if<std::is_integral<T>::value and std::is_signed<T>::value>::type>
+{
+    static const char code = 'i';
+    static std::size_t size(const T&) { return 8; }
+    static char* put(char* p, const T& v) { const std::int64_t x = v; std::memcpy(p, &x, 8); return p + 8; }
+};
+
+template <class T>
+struct LogArgument<T, typename std::enable_if<std::is_integral<T>::value and std::is_unsigned<T>::value
+                                              and not std::is_same<T, bool>::value>::type>
+{
+    static const char code = 'u';
+    static std::size_t size(const T&) { return 8; }
+    static char* put(char* p, const T& v) { const std::uint64_t x = v; std::memcpy(p, &x, 8); return p + 8; }
+};
+
+template <>
+struct LogArgument<bool>
+{
+    static const char code = 'b';
+    static std::size_t size(const bool&) { return 8; }
+    static char* put(char* p, const bool& v) { const std::uint64_t x = v; std::memcpy(p, &x, 8); return p + 8; }
+};
+
+template <class T>
+struct LogArgument<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static const char code = 'd';
+    static std::size_t size(const T&) { return 8; }
+    static char* put(char* p, const T& v) { const double x = v; std::memcpy(p, &x, 8); return p + 8; }
+};
+
+/**
+ * Strings are copied, up to MaxLength bytes.
+ */
+struct LogString
+{
+    static const char code = 's';
+    static const std::size_t MaxLength = 1024;
+
+    static std::size_t length(const std::size_t n)
+    {
+        if (n < MaxLength)
+            return n;
+        return MaxLength;
+    }
+
+    static char* put(char* p, const char* s, const std::size_t n)
+    {
+        const std::uint32_t length = static_cast<std::uint32_t>(LogString::length(n));
+        std::memcpy(p, &length, 4);
+        std::memcpy(p + 4, s, length);
+        return p + 4 + length;
+    }
+};
+
+template <>
+struct LogArgument<const char*> : LogString
+{
+    static std::size_t size(const char* const& s) { return 4 + length(std::strlen(s)); }
+    static char* put(char* p, const char* const& s) { return LogString::put(p, s, std::strlen(s)); }
+};
+
+template <>
+struct LogArgument<char*> : LogArgument<const char*>
+{};
+
+template <>
+struct LogArgument<std::string> : LogString
+{
+    static std::size_t size(const std::string& s) { return 4 + length(s.size()); }
+    static char* put(char* p, const std::string& s) { return LogString::put(p, s.data(), s.size()); }
+};
+
+template <class T>
+using LogArgumentOf = LogArgument<typename std::decay<T>::type>;
+
+inline std::size_t log_size()
+{
+    return 0;
+}
+
+template <class T, class... Rest>
+std::size_t log_size(const T& first, const Rest&... rest)
+{
+    return LogArgumentOf<T>::size(first) + log_size(rest...);
+}
+
+inline char* log_put(char* p)
+{
+    return p;
+}
+
+template <class T, class... Rest>
+char* log_put(char* p, const T& first, const Rest&... rest)
+{
+    return log_put(LogArgumentOf<T>::put(p, first), rest...);
+}
+
+/**
+ * Registers \p format with the argument codes \p signature and returns its id.
+ */
+std::uint32_t log_register_format(const char* format, const std::string& signature);
+
+template <class... Args>
+std::uint32_t log_register(const char* format, const Args&...)
+{
+    const char codes[] = { LogArgumentOf<Args>::code..., '\0' };
+    return log_register_format(format, std::string(codes));
+}
+
+/**
+ * Returns room for a record of \p size bytes, a multiple of 8, in the ring of the calling
+ * thread, or null if the ring is full and the record must be dropped.
+ */
+char* log_reserve(const std::size_t size);
+
+/**
+ * Publishes the record of \p size bytes written in the room returned by log_reserve().
+ */
+void log_commit(const std::size_t size);
+
+std::uint64_t log_timestamp();
+
+/**
+ * A record is its format id and size on 4 bytes each, a timestamp in nanoseconds on 8 bytes
+ * and the arguments, padded to a multiple of 8 bytes.
+ */
+template <class... Args>
+void log_write(const std::uint32_t id, const char*, const Args&... args)
+{
+    const std::size_t size = (16 + log_size(args...) + 7) & ~std::size_t(7);
+    char* p = log_reserve(size);
+    if (p == nullptr)
+        return;
+    const std::uint32_t header[2] = { id, static_cast<std::uint32_t>(size) };
+    const std::uint64_t timestamp = log_timestamp();
+    std::memcpy(p, header, 8);
+    std::memcpy(p + 8, &timestamp, 8);
+    log_put(p + 16, args...);
+    log_commit(size);
+}
+
+}
+
+inline bool event_log_enabled()
+{
+    return detail::event_logging.load(std::memory_order_relaxed);
+}
+
+}
+
+/**
+ * \brief Logs an event while a log is open. The first argument is a string literal where each
+ *        <tt>{}</tt> stands for one of the following arguments: integers, booleans, floating
+ *        point numbers or strings. Only the arguments are stored; the text is built by
+ *        write_event_log_text().
+ *
+ *          FINANCE_LOG("book {} bid {} x {}", instrument, price, quantity);
+ */
+#define FINANCE_LOG(...) \
+    do { \
+        if (::finance::event_log_enabled()) { \
+            static const std::uint32_t finance_log_format = ::finance::detail::log_register(__VA_ARGS__); \
+            ::finance::detail::log_write(finance_log_format, __VA_ARGS__); \
+        } \
+    } while (false)
@@ -0,0 +1,103 @@
+/**
+ * \file
+ * The finance::Fft class provides an in-place radix-2 fast Fourier transform.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <complex>
+#include <utility>
+#include <stdexcept>
+
+
+
+namespace finance {
+
+/**
+ * \brief The Fft class computes discrete Fourier transforms of a fixed power of two size.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Discrete Fourier transform.
+ *      The forward transform of \f$ x_{0},...,x_{N-1} \f$ is
+ *
+ *      \f$ X_{k} = \sum_{j=0}^{N-1}e^{-i\frac{2\pi}{N}jk}x_{j} \f$
+ * \par
+ *      It is computed with the iterative Cooley-Tukey radix-2 algorithm in
+ *      \f$ O(N\log N) \f$. The bit reversal permutation and the twiddle factors are computed once
+ *      per size, so an instance should be kept and reused for every transform of that size.
+ */
+template <class T>
+class Fft
+{
+public:
+    /**
+     * \param n     Size of the transforms.
+     * \exception std::invalid_argument if \p n is not a power of two.
+     */
+    explicit Fft(const int n)
+        : n{n},
+          twiddles(n / 2),
+          reversed(n)
+    {
+        if (n < 2 or (n & (n - 1)) != 0)
+            throw std::invalid_argument("size must be a power of two");
+
+        const T pi = acos(T(-1));
+        for (int k = 0; k < n / 2; k++)
+            twiddles[k] = std::complex<T>(cos(2 * pi * k / n), -sin(2 * pi * k / n));
+
+        int bits = 0;
+        while ((1 << bits) < n) bits++;
+        for (int i = 0; i < n; i++) {
+            int r = 0;
+            for (int b = 0; b < bits; b++)
+                if (i & (1 << b)) r |= 1 << (bits - 1 - b);
+            reversed[i] = r;
+        }
+    }
+
+    int size() const
+    {
+        return n;
+    }
+
+    /**
+     * \brief Transforms \p data in place.
+     * \exception std::invalid_argument if \p data does not have size() elements.
+     */
+    void forward(std::vector<std::complex<T>>& data) const
+    {
+        if (data.size() != static_cast<std::size_t>(n))
+            throw std::invalid_argument("sizes differ");
+
+        for (int i = 0; i < n; i++)
+            if (i < reversed[i]) std::swap(data[i], data[reversed[i]]);
+
+        for (int len = 2; len <= n; len <<= 1) {
+            const int half = len / 2;
+            const int stride = n / len;
+            for (int start = 0; start < n; start += len) {
+                std::complex<T>* lo = &data[start];
+                std::complex<T>* hi = &data[start + half];
+                for (int k = 0; k < half; k++) {
+                    const std::complex<T> w = twiddles[k * stride];
+                    const T re = hi[k].real() * w.real() - hi[k].imag() * w.imag();
+                    const T im = hi[k].real() * w.imag() + hi[k].imag() * w.real();
+                    hi[k] = std::complex<T>(lo[k].real() - re, lo[k].imag() - im);
+                    lo[k] = std::complex<T>(lo[k].real() + re, lo[k].imag() + im);
+                }
+            }
+        }
+    }
+
+private:
+    int n;
+    std::vector<std::complex<T>> twiddles;
+    std::vector<int> reversed;
+};
+
+}
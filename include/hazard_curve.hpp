@@ -0,0 +1,168 @@
+/**
+ * \file
+ * The finance::HazardCurve class provides a piecewise-constant hazard-rate (survival) curve.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+
+
+namespace finance {
+
+/**
+ * \brief The HazardCurve class models the default intensity of a credit as a piecewise-constant
+ *        hazard rate.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Hazard rate and survival probability.
+ *      Let \f$ \lambda(t) \f$ be the instantaneous default intensity of a name. The probability
+ *      of surviving up to time \f$ t \f$ is
+ *
+ *      \f$ S(t) = e^{-\Lambda(t)}, \quad \Lambda(t) = \int_{0}^{t}\lambda(u)du \f$
+ * \par
+ *      The curve is defined by pillars \f$ T_{1} < T_{2} < ... < T_{n} \f$ and a constant hazard
+ *      \f$ \lambda_{i} \f$ on each interval \f$ (T_{i-1}, T_{i}] \f$ with \f$ T_{0} = 0 \f$. The last
+ *      hazard is extrapolated flat. The integrated hazard \f$ \Lambda(T_{i}) \f$ is cached at every
+ *      pillar, so a survival probability costs one binary search and one exponential.
+ */
+template <class T>
+class HazardCurve
+{
+public:
+    HazardCurve()
+    {}
+
+    /**
+     * \param pillar_times  Increasing pillar times \f$ T_{i} \f$.
+     * \param hazard_rates  Hazard \f$ \lambda_{i} \f$ on \f$ (T_{i-1}, T_{i}] \f$.
+     * \exception std::invalid_argument if parameter sizes differ or times are not increasing.
+     */
+    HazardCurve(const std::vector<T>& pillar_times,
+                const std::vector<T>& hazard_rates)
+        : times{pillar_times},
+          hazards{hazard_rates},
+          integrated(pillar_times.size())
+    {
+        if (times.size() != hazards.size())
+            throw std::invalid_argument("sizes differ");
+        for (int i = 0; i < size(); i++) {
+            if (times[i] <= (i == 0 ? T(0) : times[i-1]))
+                throw std::invalid_argument("pillar times must be positive and increasing");
+        }
+        update_integrated(0);
+    }
+
+    bool empty() const
+    {
+        return times.empty();
+    }
+
+    int size() const
+    {
+        return static_cast<int>(times.size());
+    }
+
+    T pillar_time(const int i) const
+    {
+        return times.at(i);
+    }
+
+    T pillar_hazard_rate(const int i) const
+    {
+        return hazards.at(i);
+    }
+
+    /**
+     * \brief Sets the hazard rate of pillar \p i.
+     *
+     * \par
+     *      The cached integrated hazards from pillar \p i onwards are recomputed, which costs
+     *      \f$ O(n - i) \f$ for \f$ n \f$ pillars: \f$ O(1) \f$ only for the last one. append()
+     *      builds a curve pillar by pillar at \f$ O(1) \f$ per pillar.
+     */
+    void set_hazard_rate(const int i, const T h)
+    {
+        hazards.at(i) = h;
+        update_integrated(i);
+    }
+
+    /**
+     * \brief Appends a pillar at the end of the curve.
+     * \exception std::invalid_argument if \p t is not beyond the last pillar.
+     */
+    void append(const T t, const T h)
+    {
+        if (t <= (empty() ? T(0) : times.back()))
+            throw std::invalid_argument("pillar times must be positive and increasing");
+        times.push_back(t);
+        hazards.push_back(h);
+        integrated.push_back(T(0));
+        update_integrated(size() - 1);
+    }
+
+    /**
+     * \brief Returns the instantaneous hazard rate \f$ \lambda(t) \f$.
+     */
+    T hazard_rate(const T t) const
+    {
+        if (empty()) return T(0);
+        return hazards[segment(t)];
+    }
+
+    /**
+     * \brief Returns the integrated hazard \f$ \Lambda(t) \f$.
+     */
+    T integrated_hazard(const T t) const
+    {
+        if (empty() or t <= T(0)) return T(0);
+        const int k = segment(t);
+        const T t_prev = (k == 0) ? T(0) : times[k-1];
+        const T l_prev = (k == 0) ? T(0) : integrated[k-1];
+        return l_prev + hazards[k] * (t - t_prev);
+    }
+
+    /**
+     * \brief Returns the survival probability \f$ S(t) = e^{-\Lambda(t)} \f$.
+     */
+    T survival_probability(const T t) const
+    {
+        return exp(-integrated_hazard(t));
+    }
+
+    /**
+     * \brief Returns the probability of defaulting in \f$ (t_{1}, t_{2}] \f$ as seen today.
+     */
+    T default_probability(const T t1, const T t2) const
+    {
+        return survival_probability(t1) - survival_probability(t2);
+    }
+
+private:
+    int segment(const T t) const
+    {
+        const int k = static_cast<int>(std::lower_bound(times.begin(), times.end(), t) - times.begin());
+        return std::min(k, size() - 1);
+    }
+
+    void update_integrated(const int from)
+    {
+        for (int i = from; i < size(); i++) {
+            const T t_prev = (i == 0) ? T(0) : times[i-1];
+            const T l_prev = (i == 0) ? T(0) : integrated[i-1];
+            integrated[i] = l_prev + hazards[i] * (times[i] - t_prev);
+        }
+    }
+
+    std::vector<T> times;
+    std::vector<T> hazards;
+    std::vector<T> integrated;
+};
+
+}
@@ -0,0 +1,479 @@
+/**
+ * \file
+ * The finance::HullWhiteTree class provides a trinomial short-rate lattice calibrated to a zero
+ * curve, and the lattice instruments finance::CallableBond and finance::BermudanSwaption.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <parallel.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief The HullWhiteTree class is a recombining trinomial tree for the Hull-White one factor
+ *        short-rate model.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par The Hull-White model.
+ *      The short rate follows \f$ dr = (\theta(t) - ar)dt + \sigma dW \f$. The tree is built in two
+ *      stages (Hull & White, 1994). First a symmetric tree for \f$ x = r - \alpha(t) \f$ with node
+ *      spacing \f$ \Delta x = \sigma\sqrt{3\Delta t} \f$ and branching truncated at
+ *      \f$ j_{max} = \lceil 0.184 / (a\Delta t) \rceil \f$. Then the shifts \f$ \alpha_{m} \f$ are
+ *      found by forward induction with Arrow-Debreu prices \f$ Q_{m,j} \f$ so that the tree
+ *      reprices every discount bond of the input curve:
+ *
+ *      \f$ \alpha_{m} = \frac{1}{\Delta t}\left\lbrack\ln\sum_{j}Q_{m,j}e^{-j\Delta x\Delta t} - \ln P(0,(m+1)\Delta t)\right\rbrack \f$
+ * \par
+ *      Each node discounts one step with continuous compounding, \f$ e^{-r_{m,j}\Delta t} \f$, as in
+ *      finance::PresentValue::pv_continuous_cflow. The node discount factors and branching
+ *      probabilities are computed once at construction; afterwards the tree is read only and one
+ *      instance can be shared by every trade priced on the same curve, from any number of
+ *      threads.
+ */
+template <class T>
+class HullWhiteTree
+{
+public:
+    /**
+     * \param curve_times   Increasing times of the zero curve.
+     * \param zero_rates    Continuously compounded zero rates, linearly interpolated and
+     *                      extrapolated flat.
+     * \param a             Mean reversion speed.
+     * \param sigma         Short-rate volatility.
+     * \param maturity      Last time covered by the tree.
+     * \param num_steps     Number of time steps.
+     * \exception std::invalid_argument if parameter sizes differ or a parameter is not positive.
+     */
+    HullWhiteTree(const std::vector<T>& curve_times,
+                  const std::vector<T>& zero_rates,
+                  const T a,
+                  const T sigma,
+                  const T maturity,
+                  const int num_steps)
+        : curve_times{curve_times},
+          zero_rates{zero_rates},
+          a{a},
+          sigma{sigma},
+          num_steps{num_steps}
+    {
+        if (curve_times.size() != zero_rates.size() or curve_times.empty())
+            throw std::invalid_argument("sizes differ");
+        if (a <= T(0) or sigma <= T(0) or maturity <= T(0) or num_steps <= 0)
+            throw std::invalid_argument("parameters must be positive");
+
+        dt = maturity / num_steps;
+        dx = sigma * sqrt(3 * dt);
+        jmax = static_cast<int>(ceil(T(0.184) / (a * dt)));
+        build_branching();
+        calibrate();
+    }
+
+    int get_num_steps() const
+    {
+        return num_steps;
+    }
+
+    T get_dt() const
+    {
+        return dt;
+    }
+
+    int get_jmax() const
+    {
+        return jmax;
+    }
+
+    /**
+     * \brief Returns the time of step \p m.
+     */
+    T time_at(const int m) const
+    {
+        return m * dt;
+    }
+
+    /**
+     * \brief Returns the step closest to time \p t.
+     * \exception std::out_of_range if \p t is beyond the tree.
+     */
+    int step_of(const T t) const
+    {
+        const int m = static_cast<int>(floor(t / dt + T(0.5)));
+        if (m < 0 or m > num_steps)
+            throw std::out_of_range("time 't' out of the tree");
+        return m;
+    }
+
+    /**
+     * \brief Returns the half width \f$ \min(m, j_{max}) \f$ of step \p m.
+     */
+    int half_width(const int m) const
+    {
+        return std::min(m, jmax);
+    }
+
+    /**
+     * \brief Returns the number of nodes of step \p m.
+     */
+    int width(const int m) const
+    {
+        return 2 * half_width(m) + 1;
+    }
+
+    /**
+     * \brief Returns the short rate at node \f$ (m, j) \f$.
+     */
+    T short_rate(const int m, const int j) const
+    {
+        return alpha[m] + j * dx;
+    }
+
+    /**
+     * \brief Returns the discount factor of the input curve, \f$ P(0,t) = e^{-z(t)t} \f$.
+     */
+    T discount_factor(const T t) const
+    {
+        return exp(-zero_rate(t) * t);
+    }
+
+    /**
+     * \brief Rolls values back one step, from step \p m + 1 to step \p m.
+     *
+     * \param m             Step to roll back to.
+     * \param next          Values at the nodes of step \p m + 1.
+     * \param values        Output values at the nodes of step \p m.
+     *
+     * \par
+     *      Nodes with normal branching share the same three children offsets, so the
+     *      interior is one branch free loop over contiguous arrays. Only the two edge nodes
+     *      with truncated branching are handled apart.
+     */
+    void rollback(const int m,
+                  const std::vector<T>& next,
+                  std::vector<T>& values) const
+    {
+        const int hw = half_width(m);
+        const int hw_next = half_width(m + 1);
+        values.resize(2 * hw + 1);
+
+        const T* df = &node_discount[offsets[m]];
+        const T* pu = &prob_up[jmax - hw];
+        const T* pm = &prob_mid[jmax - hw];
+        const T* pd = &prob_down[jmax - hw];
+        const T* vn = &next[hw_next - hw];
+        T* v = values.data();
+
+        const int first = (hw == jmax) ? 1 : 0;
+        const int last  = (hw == jmax) ? 2 * hw : 2 * hw + 1;
+        for (int i = first; i < last; i++)
+            v[i] = df[i] * (pu[i] * vn[i+1] + pm[i] * vn[i] + pd[i] * vn[i-1]);
+
+        if (hw == jmax) {
+            // j = -jmax branches up to j, j+1, j+2 and j = +jmax down to j, j-1, j-2.
+            const int top = 2 * hw;
+            v[0]   = df[0]   * (pu[0]   * vn[2]       + pm[0]   * vn[1]       + pd[0]   * vn[0]);
+            v[top] = df[top] * (pu[top] * vn[top]     + pm[top] * vn[top - 1] + pd[top] * vn[top - 2]);
+        }
+    }
+
+private:
+    T zero_rate(const T t) const
+    {
+        if (t <= curve_times.front()) return zero_rates.front();
+        if (t >= curve_times.back()) return zero_rates.back();
+        const int k = static_cast<int>(std::upper_bound(curve_times.begin(), curve_times.end(), t) - curve_times.begin());
+        const T w = (t - curve_times[k-1]) / (curve_times[k] - curve_times[k-1]);
+        return zero_rates[k-1] + w * (zero_rates[k] - zero_rates[k-1]);
+    }
+
+    void build_branching()
+    {
+        const int n = 2 * jmax + 1;
+        prob_up.resize(n);
+        prob_mid.resize(n);
+        prob_down.resize(n);
+
+        const T M = -a * dt;
+        for (int i = 0; i < n; i++) {
+            const int j = i - jmax;
+            const T jm  = j * M;
+            const T jm2 = jm * jm;
+            if (j == jmax) {
+                prob_up[i]   = T(7) / 6 + (jm2 + 3 * jm) / 2;
+                prob_mid[i]  = -T(1) / 3 - jm2 - 2 * jm;
+                prob_down[i] = T(1) / 6 + (jm2 + jm) / 2;
+            } else if (j == -jmax) {
+                prob_up[i]   = T(1) / 6 + (jm2 - jm) / 2;
+                prob_mid[i]  = -T(1) / 3 - jm2 + 2 * jm;
+                prob_down[i] = T(7) / 6 + (jm2 - 3 * jm) / 2;
+            } else {
+                prob_up[i]   = T(1) / 6 + (jm2 + jm) / 2;
+                prob_mid[i]  = T(2) / 3 - jm2;
+                prob_down[i] = T(1) / 6 + (jm2 - jm) / 2;
+            }
+        }
+    }
+
+    // Child of node j reached by the middle branch.
+    int middle_child(const int j) const
+    {
+        if (j == jmax) return j - 1;
+        if (j == -jmax) return j + 1;
+        return j;
+    }
+
+    void calibrate()
+    {
+        alpha.resize(num_steps);
+        offsets.resize(num_steps + 1);
+        offsets[0] = 0;
+        for (int m = 0; m < num_steps; m++)
+            offsets[m+1] = offsets[m] + width(m);
+        node_discount.resize(offsets[num_steps]);
+
+        std::vector<T> q(1, T(1));
+        std::vector<T> q_next;
+        for (int m = 0; m < num_steps; m++) {
+            const int hw = half_width(m);
+            T sum = 0.0;
+            for (int j = -hw; j <= hw; j++)
+                sum += q[j + hw] * exp(-j * dx * dt);
+            alpha[m] = (log(sum) + zero_rate((m + 1) * dt) * (m + 1) * dt) / dt;
+
+            T* df = &node_discount[offsets[m]];
+            for (int j = -hw; j <= hw; j++)
+                df[j + hw] = exp(-(alpha[m] + j * dx) * dt);
+
+            const int hw_next = half_width(m + 1);
+            q_next.assign(2 * hw_next + 1, T(0));
+            for (int j = -hw; j <= hw; j++) {
+                const int i = j + jmax;
+                const int k = middle_child(j) + hw_next;
+                const T qd = q[j + hw] * df[j + hw];
+                q_next[k+1] += qd * prob_up[i];
+                q_next[k]   += qd * prob_mid[i];
+                q_next[k-1] += qd * prob_down[i];
+            }
+            q.swap(q_next);
+        }
+    }
+
+    std::vector<T> curve_times;
+    std::vector<T> zero_rates;
+    T a;
+    T sigma;
+    int num_steps;
+    T dt;
+    T dx;
+    int jmax;
+
+    std::vector<T> prob_up;
+    std::vector<T> prob_mid;
+    std::vector<T> prob_down;
+    std::vector<T> alpha;
+    std::vector<int> offsets;
+    std::vector<T> node_discount;
+};
+
+/**
+ * \brief The CallableBond class prices a fixed coupon bond the issuer can redeem early.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par
+ *      Coupons are paid at \p coupon_times and the principal at the last coupon time. On each
+ *      call date the issuer redeems at the call price if that is cheaper than the continuation
+ *      value, so the bond is worth \f$ \min(V, K) \f$ ex-coupon. Event times are mapped to the
+ *      nearest step of the tree.
+ */
+template <class T>
+class CallableBond
+{
+public:
+    CallableBond(const std::vector<T>& coupon_times,
+                 const std::vector<T>& coupon_amounts,
+                 const T principal,
+                 const std::vector<T>& call_times,
+                 const std::vector<T>& call_prices)
+        : coupon_times{coupon_times},
+          coupon_amounts{coupon_amounts},
+          principal{principal},
+          call_times{call_times},
+          call_prices{call_prices}
+    {
+        if (coupon_times.size() != coupon_amounts.size() or call_times.size() != call_prices.size())
+            throw std::invalid_argument("sizes differ");
+        if (coupon_times.empty())
+            throw std::invalid_argument("no coupons");
+    }
+
+    /**
+     * \brief Calculates the present value of the bond on \p tree.
+     */
+    T price(const HullWhiteTree<T>& tree) const
+    {
+        const int last = tree.step_of(coupon_times.back());
+        std::vector<T> cashflow(last + 1, T(0));
+        std::vector<T> call(last + 1, T(-1));
+        for (std::size_t i = 0; i < coupon_times.size(); i++)
+            cashflow[tree.step_of(coupon_times[i])] += coupon_amounts[i];
+        cashflow[last] += principal;
+        for (std::size_t i = 0; i < call_times.size(); i++) {
+            const int m = tree.step_of(call_times[i]);
+            if (m <= last) call[m] = call_prices[i];
+        }
+
+        std::vector<T> values(tree.width(last), cashflow[last]);
+        std::vector<T> next;
+        for (int m = last - 1; m >= 0; m--) {
+            values.swap(next);
+            tree.rollback(m, next, values);
+            if (call[m] >= T(0))
+                for (T& v : values) v = std::min(v, call[m]);
+            if (cashflow[m] != T(0))
+                for (T& v : values) v += cashflow[m];
+        }
+        return values[0];
+    }
+
+private:
+    std::vector<T> coupon_times;
+    std::vector<T> coupon_amounts;
+    T principal;
+    std::vector<T> call_times;
+    std::vector<T> call_prices;
+};
+
+/**
+ * \brief The BermudanSwaption class prices the right to enter a fixed/floating swap on any of a
+ *        set of exercise dates.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par
+ *      The swap accrues from \f$ t_{s} \f$ and its fixed leg pays at \f$ t_{1} < ... < t_{n} \f$,
+ *      the first coupon accruing over \f$ (t_{s}, t_{1}] \f$. Entering it at \f$ t_{e} \f$ is worth
+ *      \f$ N(D(t_{e}) - B(t_{e})) \f$ for the payer of the fixed rate, where \f$ B \f$ is a bond paying
+ *      the fixed coupons after \f$ t_{e} \f$ and the unit principal at \f$ t_{n} \f$, and \f$ D \f$ is
+ *      the zero coupon bond maturing at \f$ t_{s} \f$ before the start, one afterwards. The
+ *      bonds and the option are rolled back together through the tree and the option takes
+ *      \f$ \max(O, \pm N(D - B)) \f$ on every exercise step. Exercise dates after the start are
+ *      expected on payment dates, where a full period of the floating leg remains.
+ */
+template <class T>
+class BermudanSwaption
+{
+public:
+    /**
+     * \param payment_times  Increasing payment times of the fixed leg.
+     * \param start          Accrual start \f$ t_{s} \f$ of the swap, before the first payment.
+     * \param fixed_rate     Annual fixed rate.
+     * \param exercise_times Times at which the swap can be entered.
+     * \param notional       Notional \f$ N \f$.
+     * \param payer          True to pay the fixed rate, false to receive it.
+     * \exception std::invalid_argument if there are no payments or exercise dates, or the start
+     *            is negative or not before the first payment.
+     */
+    BermudanSwaption(const std::vector<T>& payment_times,
+                     const T start,
+                     const T fixed_rate,
+                     const std::vector<T>& exercise_times,
+                     const T notional,
+                     const bool payer)
+        : payment_times{payment_times},
+          start{start},
+          fixed_rate{fixed_rate},
+          exercise_times{exercise_times},
+          notional{notional},
+          payer{payer}
+    {
+        if (payment_times.empty() or exercise_times.empty())
+            throw std::invalid_argument("no payments or exercise dates");
+        if (start < T(0) or start >= payment_times.front())
+            throw std::invalid_argument("start must be before the first payment");
+    }
+
+    /**
+     * \brief Calculates the present value of the swaption on \p tree.
+     */
+    T price(const HullWhiteTree<T>& tree) const
+    {
+        const int last = tree.step_of(payment_times.back());
+        std::vector<T> coupon(last + 1, T(0));
+        std::vector<bool> exercise(last + 1, false);
+        T t_prev = start;
+        for (std::size_t i = 0; i < payment_times.size(); i++) {
+            coupon[tree.step_of(payment_times[i])] += fixed_rate * (payment_times[i] - t_prev);
+            t_prev = payment_times[i];
+        }
+        for (std::size_t i = 0; i < exercise_times.size(); i++) {
+            const int m = tree.step_of(exercise_times[i]);
+            if (m < last) exercise[m] = true;
+        }
+
+        const int first = tree.step_of(start);
+        const T sign = payer ? T(1) : T(-1);
+        std::vector<T> bond(tree.width(last), T(1) + coupon[last]);
+        std::vector<T> option(tree.width(last), T(0));
+        std::vector<T> floating;
+        std::vector<T> next;
+        for (int m = last - 1; m >= 0; m--) {
+            bond.swap(next);
+            tree.rollback(m, next, bond);
+            option.swap(next);
+            tree.rollback(m, next, option);
+            if (m >= first) {
+                floating.assign(bond.size(), T(1));
+            } else {
+                floating.swap(next);
+                tree.rollback(m, next, floating);
+            }
+            if (exercise[m])
+                for (std::size_t j = 0; j < bond.size(); j++)
+                    option[j] = std::max(option[j], sign * notional * (floating[j] - bond[j]));
+            if (coupon[m] != T(0))
+                for (T& b : bond) b += coupon[m];
+        }
+        return option[0];
+    }
+
+private:
+    std::vector<T> payment_times;
+    T start;
+    T fixed_rate;
+    std::vector<T> exercise_times;
+    T notional;
+    bool payer;
+};
+
+/**
+ * \brief Prices every instrument on the same calibrated \p tree in parallel.
+ *
+ * \tparam Instrument   Any type with a <tt>T price(const HullWhiteTree<T>&) const</tt> method.
+ * \param tree          Calibrated lattice, shared read only by all the trades.
+ * \param instruments   Trades to price.
+ * \param prices        Output prices, one per instrument.
+ */
+template <class T, class Instrument>
+void price_all(const HullWhiteTree<T>& tree,
+               const std::vector<Instrument>& instruments,
+               std::vector<T>& prices)
+{
+    prices.resize(instruments.size());
+    parallel_for(0, static_cast<int>(instruments.size()), [&](const int i) {
+        prices[i] = instruments[i].price(tree);
+    });
+}
+
+}
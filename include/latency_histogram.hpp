@@ -0,0 +1,227 @@
+/**
+ * \file
+ * Latency distributions: finance::LatencyHistogram counts durations in log-linear buckets and
+ * finance::LatencyRecorder records them from any number of threads without locking.
+ *
+ * Recording is off at startup; latency_enable() turns it on for every FINANCE_LATENCY_SCOPE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <iosfwd>
+
+
+
+namespace finance {
+
+namespace detail {
+
+struct LatencyShard;
+
+}
+
+/**
+ * \brief The LatencyHistogram class counts values, durations in nanoseconds, in log-linear
+ *        buckets and answers percentile queries.
+ * \ingroup Finance
+ *
+ * \par
+ *      Values below 256 have a bucket each. Above, every power of two is split into 128 equal
+ *      buckets, so a value is known within 1/128 (0.8%) of itself whatever its magnitude, as in
+ *      HdrHistogram with two significant digits. Values up to 2<sup>40</sup> ns (about 18
+ *      minutes) are tracked; larger ones are counted in the last bucket. The exact minimum and
+ *      maximum are kept apart.
+ * \par
+ *      Histograms are mergeable: merging the histograms of several threads or runs gives the
+ *      histogram of all their values.
+ */
+class LatencyHistogram
+{
+public:
+    static const int SUB_BUCKET_BITS = 8;
+    static const int MAX_VALUE_BITS = 40;
+    static const int NUM_BUCKETS = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) << (SUB_BUCKET_BITS - 1);
+
+    LatencyHistogram();
+
+    void record(const std::uint64_t value,
+                const std::uint64_t count = 1);
+
+    void merge(const LatencyHistogram& other);
+
+    void clear();
+
+    std::uint64_t get_count() const;
+
+    std::uint64_t get_min() const;
+
+    std::uint64_t get_max() const;
+
+    double mean() const;
+
+    /**
+     * \brief Returns the smallest value not exceeded by a fraction \p q of the values,
+     *        0 <= q <= 1, as the highest value of its bucket (or the exact maximum).
+     *        Returns 0 for an empty histogram.
+     */
+    std::uint64_t percentile(const double q) const;
+
+    /**
+     * \brief Writes a percentile table, one row per percentile from the median to the maximum:
+     *
+     *          percentile       value     count
+     *              50.000        1271     50012
+     *              99.900        4863     99901
+     *             100.000       18431    100000
+     */
+    void write_percentiles(std::ostream& os) const;
+
+    /**
+     * \brief Returns the bucket of \p value.
+     */
+    static int bucket_of(const std::uint64_t value);
+
+    /**
+     * \brief Returns the smallest and largest values of \p bucket.
+     */
+    static std::uint64_t lowest_value(const int bucket);
+    static std::uint64_t highest_value(const int bucket);
+
+    const std::vector<std::uint64_t>& get_buckets() const;
+
+private:
+    friend class LatencyRecorder;
+
+    void add(const detail::LatencyShard& shard);
+
+    std::vector<std::uint64_t> buckets;
+    std::uint64_t count;
+    std::uint64_t min;
+    std::uint64_t max;
+    double sum;
+};
+
+/**
+ * \brief The LatencyRecorder class records latencies of one named operation from any thread.
+ * \ingroup Finance
+ *
+ * \par
+ *      Each thread records into its own shard of buckets with relaxed atomic stores: recording
+ *      takes no lock, does no read-modify-write and never waits on another thread. snapshot()
+ *      merges the shards; taken while threads record, it is a consistent enough view for
+ *      monitoring, every value being counted once it is visible. Shards of exited threads are
+ *      kept, with their counts, and reused by the next thread.
+ * \par
+ *      Recorders are usually obtained from latency_recorder(), which keeps them for the life of
+ *      the program. A recorder built directly must outlive the threads recording into it.
+ */
+class LatencyRecorder
+{
+public:
+    explicit LatencyRecorder(const char* name);
+    ~LatencyRecorder();
+
+    LatencyRecorder(const LatencyRecorder&) = delete;
+    LatencyRecorder& operator =(const LatencyRecorder&) = delete;
+
+    const char* get_name() const;
+
+    void record(const std::uint64_t value);
+
+    /**
+     * \brief Returns the merged histogram of every thread.
+     */
+    LatencyHistogram snapshot() const;
+
+    /**
+     * \brief Discards the recorded values. No thread may be recording.
+     */
+    void clear();
+
+private:
+    detail::LatencyShard* shard();
+
+    const char* name;
+    int id;
+};
+
+/**
+ * \brief Starts or stops the FINANCE_LATENCY_SCOPE measurements. Recording is off at startup.
+ */
+void latency_enable(const bool on);
+
+/**
+ * \brief Returns true while FINANCE_LATENCY_SCOPE measurements are recorded.
+ */
+inline bool latency_enabled();
+
+/**
+ * \brief Returns the recorder named \p name, creating it on first use. \p name must be a string
+ *        with static storage (a literal). The recorder lives until the program ends.
+ */
+LatencyRecorder& latency_recorder(const char* name);
+
+/**
+ * \brief Writes the percentile table of every recorder returned by latency_recorder() that
+ *        recorded values, each under a line with its name, count, mean and maximum.
+ */
+void write_latency_report(std::ostream& os);
+
+/**
+ * \brief The LatencyScope class records the time from its construction to its destruction, in
+ *        nanoseconds, if recording was on at construction.
+ */
+class LatencyScope
+{
+public:
+    explicit LatencyScope(LatencyRecorder& recorder)
+        : recorder{latency_enabled() ? &recorder : nullptr}
+    {
+        if (this->recorder != nullptr)
+            start = std::chrono::steady_clock::now();
+    }
+
+    ~LatencyScope()
+    {
+        if (recorder != nullptr)
+            recorder->record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - start).count());
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator =(const LatencyScope&) = delete;
+
+private:
+    LatencyRecorder* recorder;
+    std::chrono::steady_clock::time_point start;
+};
+
+namespace detail {
+
+extern std::atomic<bool> latency_recording;
+
+}
+
+inline bool latency_enabled()
+{
+    return detail::latency_recording.load(std::memory_order_relaxed);
+}
+
+}
+
+#define FINANCE_LATENCY_CONCAT_(a, b) a##b
+#define FINANCE_LATENCY_CONCAT(a, b) FINANCE_LATENCY_CONCAT_(a, b)
+
+/**
+ * \brief Records the latency of the enclosing scope into latency_recorder(\p name) while
+ *        latency_enabled(). \p name must be a string literal.
+ */
+#define FINANCE_LATENCY_SCOPE(name) \
+    static ::finance::LatencyRecorder& FINANCE_LATENCY_CONCAT(finance_latency_recorder_, __LINE__) = \
+        ::finance::latency_recorder(name); \
+    ::finance::LatencyScope FINANCE_LATENCY_CONCAT(finance_latency_scope_, __LINE__)( \
+        FINANCE_LATENCY_CONCAT(finance_latency_recorder_, __LINE__))
@@ -0,0 +1,56 @@
+/**
+ * \file
+ * Messages published by the simulation engines to the front ends.
+ */
+
+#pragma once
+
+
+
+namespace finance {
+
+/**
+ * \brief The latest market and book state of one instrument.
+ * \ingroup Finance
+ *
+ * \par
+ *      Every update carries the full state of the instrument, so a consumer that falls behind
+ *      only needs the most recent update of each instrument.
+ */
+struct InstrumentUpdate
+{
+    int instrument;
+    double bid;
+    double ask;
+    double last;
+    double position;
+    double pnl;
+};
+
+/**
+ * \brief A change of one price level of the order book of one instrument.
+ * \ingroup Finance
+ *
+ * \par
+ *      \p quantity is the new total quantity resting at \p price on \p side, zero when the level
+ *      is emptied. Applying the deltas in order rebuilds the book without ever sending a full
+ *      snapshot.
+ * \par Recovery.
+ *      The producer numbers the deltas of each instrument consecutively in \p sequence, counting
+ *      the deltas it failed to publish too, so a consumer sees a gap whenever one was lost.
+ *      A snapshot is a delta with \p reset set, which empties the book before it is applied,
+ *      followed by one delta per resting level; it continues the sequence like any delta.
+ */
+struct BookDelta
+{
+    enum Side { Bid, Ask };
+
+    int instrument;
+    Side side;
+    double price;
+    double quantity;
+    unsigned long long sequence;
+    bool reset;
+};
+
+}
@@ -0,0 +1,120 @@
+/**
+ * \file
+ * The finance::MinMaxPyramid class answers min/max queries over any index range of a series in
+ * logarithmic time.
+ */
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+
+
+namespace finance {
+
+/**
+ * \brief The MinMaxPyramid class keeps the minimum and maximum of every aligned block of
+ *        \f$ 2^{l} \f$ samples of a series.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of the samples.
+ *
+ * \par
+ *      Level 0 is the series itself, which is referenced and not copied, so it must outlive
+ *      the pyramid. Level \f$ l \f$ holds \f$ \lceil n/2^{l} \rceil \f$ min/max pairs, so all levels
+ *      together need about \f$ 2n \f$ extra samples. A query over \f$ [first, last) \f$ combines at
+ *      most two blocks per level, \f$ O(\log n) \f$ whatever the length of the range. A chart
+ *      showing \f$ W \f$ pixel columns over any zoom level then costs \f$ O(W\log n) \f$.
+ */
+template <class T>
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid()
+        : values{nullptr}, count{0}
+    {}
+
+    /**
+     * \brief Builds the pyramid over \p series.
+     */
+    void build(const std::vector<T>& series)
+    {
+        values = series.data();
+        count = static_cast<int>(series.size());
+        minima.clear();
+        maxima.clear();
+
+        int n = count;
+        int level = 0;
+        while (n > 1) {
+            const int m = (n + 1) / 2;
+            std::vector<T> lo(m);
+            std::vector<T> hi(m);
+            for (int i = 0; i < m; i++) {
+                const int a = 2 * i;
+                const int b = std::min(2 * i + 1, n - 1);
+                lo[i] = std::min(min_at(level, a), min_at(level, b));
+                hi[i] = std::max(max_at(level, a), max_at(level, b));
+            }
+            minima.push_back(std::move(lo));
+            maxima.push_back(std::move(hi));
+            n = m;
+            level++;
+        }
+    }
+
+    int size() const
+    {
+        return count;
+    }
+
+    /**
+     * \brief Computes the minimum and maximum of the samples in [\p first, \p last).
+     * \return false if the range is empty.
+     */
+    bool range(int first, int last, T& minimum, T& maximum) const
+    {
+        first = std::max(first, 0);
+        last = std::min(last, count);
+        if (first >= last)
+            return false;
+
+        minimum = std::numeric_limits<T>::max();
+        maximum = std::numeric_limits<T>::lowest();
+        for (int level = 0; first < last; level++) {
+            if (first & 1) {
+                minimum = std::min(minimum, min_at(level, first));
+                maximum = std::max(maximum, max_at(level, first));
+                first++;
+            }
+            if (last & 1) {
+                last--;
+                minimum = std::min(minimum, min_at(level, last));
+                maximum = std::max(maximum, max_at(level, last));
+            }
+            first >>= 1;
+            last >>= 1;
+        }
+        return true;
+    }
+
+private:
+    T min_at(const int level, const int i) const
+    {
+        return level == 0 ? values[i] : minima[level - 1][i];
+    }
+
+    T max_at(const int level, const int i) const
+    {
+        return level == 0 ? values[i] : maxima[level - 1][i];
+    }
+
+    const T* values;
+    int count;
+    std::vector<std::vector<T>> minima;
+    std::vector<std::vector<T>> maxima;
+};
+
+}
@@ -0,0 +1,195 @@
+/**
+ * \file
+ * The finance::MonteCarloEngine class simulates geometric Brownian motion paths and feeds them,
+ * step by step, to streaming payoff accumulators.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <batch_kernels.hpp>
+#include <parallel.hpp>
+#include <random.hpp>
+#include <reproducible_sum.hpp>
+#include <trace.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief Result of a Monte Carlo valuation.
+ */
+template <class T>
+struct MonteCarloResult
+{
+    T price;
+    T standard_error;
+    int num_paths;
+};
+
+/**
+ * \brief The MonteCarloEngine class values path dependent payoffs under geometric Brownian
+ *        motion.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (float or double, the types of the batch kernels).
+ *
+ * \par Path generation.
+ *      Each step of a path is generated exactly with
+ *
+ *      \f$ S_{t+\Delta t} = S_{t}e^{(r - q - \frac{1}{2}\sigma^{2})\Delta t + \sigma\sqrt{\Delta t}Z} \f$
+ * \par
+ *      and handed to the payoff as soon as it is generated, so paths are never stored and the
+ *      memory used does not depend on the number of steps. A payoff is any copyable and
+ *      assignable type with
+ *
+ *      - <tt>void start(const T spot, const T sigma, const T dt)</tt>, called before each path,
+ *      - <tt>void step(const T s_prev, const T s_next)</tt>, called once per time step,
+ *      - <tt>T value() const</tt>, the undiscounted payoff of the path.
+ * \par
+ *      Path \f$ p \f$ of instrument \f$ i \f$ draws the normals normal_batch() gives on the
+ *      Philox stream StreamId(seed, i, p), so every path is the same whichever thread simulates
+ *      it and whichever paths are simulated with it. Normals and growth factors are computed in
+ *      chunks by the batch kernels. Paths are simulated in fixed blocks whose results are
+ *      combined in block order, so the price does not depend on the number of threads either.
+ */
+template <class T>
+class MonteCarloEngine
+{
+public:
+    /**
+     * \param spot      Spot price \f$ S_{0} \f$.
+     * \param r         Constant interest rate, continuously compounded.
+     * \param q         Constant dividend yield, continuously compounded.
+     * \param sigma     Constant volatility.
+     * \param maturity  Maturity of the payoff.
+     * \param num_steps Number of time steps per path.
+     */
+    MonteCarloEngine(const T spot,
+                     const T r,
+                     const T q,
+                     const T sigma,
+                     const T maturity,
+                     const int num_steps)
+        : spot{spot},
+          r{r},
+          q{q},
+          sigma{sigma},
+          maturity{maturity},
+          num_steps{num_steps}
+    {
+        if (spot <= T(0) or sigma <= T(0) or maturity <= T(0) or num_steps <= 0)
+            throw std::invalid_argument("parameters must be positive");
+    }
+
+    /**
+     * \brief Values \p payoff over \p num_paths paths.
+     *
+     * \param payoff    Prototype of the payoff accumulator, copied for every path.
+     * \param num_paths Number of simulated paths.
+     * \param seed      Seed of the simulation: the run of the random streams.
+     * \param instrument Index of the instrument, so that the instruments valued in one run draw
+     *                  independent paths.
+     * \return          Discounted mean payoff and its standard error.
+     */
+    template <class Payoff>
+    MonteCarloResult<T> price(const Payoff& payoff,
+                              const int num_paths,
+                              const unsigned long seed = 1,
+                              const unsigned instrument = 0) const
+    {
+        if (num_paths <= 0)
+            throw std::invalid_argument("num_paths must be positive");
+
+        const int BLOCK_SIZE = 4096;
+        const int CHUNK_SIZE = 256;
+        const int num_blocks = (num_paths + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        std::vector<double> sums(num_blocks);
+        std::vector<double> squares(num_blocks);
+
+        const T dt = maturity / num_steps;
+        const T drift = (r - q - T(0.5) * sigma * sigma) * dt;
+        const T vol = sigma * sqrt(dt);
+
+        // A chunk holds CHUNK_SIZE steps: up to that many steps of one path, or all the steps of
+        // several short paths, so the batch kernels always run over enough values to vectorize
+        // and memory does not grow with the number of steps.
+        const int paths_per_chunk = std::max(1, CHUNK_SIZE / num_steps);
+        const int steps_per_chunk = std::min(num_steps, CHUNK_SIZE);
+
+        parallel_for(0, num_blocks, [&](const int b) {
+            FINANCE_TRACE_SCOPE("monte_carlo_block");
+            std::vector<T> growth(paths_per_chunk * steps_per_chunk);
+            std::vector<Payoff> paths(paths_per_chunk, payoff);
+            std::vector<T> prices(paths_per_chunk);
+
+            const int first = b * BLOCK_SIZE;
+            const int last  = std::min(num_paths, first + BLOCK_SIZE);
+            double sum = 0.0;
+            double square = 0.0;
+            for (int p = first; p < last; p += paths_per_chunk) {
+                const int g = std::min(paths_per_chunk, last - p);
+                for (int k = 0; k < g; k++) {
+                    paths[k] = payoff;
+                    paths[k].start(spot, sigma, dt);
+                    prices[k] = spot;
+                }
+                for (int i = 0; i < num_steps; i += steps_per_chunk) {
+                    const int m = std::min(steps_per_chunk, num_steps - i);
+                    for (int k = 0; k < g; k++) {
+                        const StreamId stream(seed, instrument, static_cast<std::uint32_t>(p + k));
+                        uniform_batch(stream, i, growth.data() + k * m, m);
+                    }
+                    normals_batch(growth.data(), growth.data(), g * m);
+                    for (int j = 0; j < g * m; j++)
+                        growth[j] = drift + vol * growth[j];
+                    exp_batch(growth.data(), growth.data(), g * m);
+                    for (int k = 0; k < g; k++) {
+                        T s = prices[k];
+                        for (int j = 0; j < m; j++) {
+                            const T s_next = s * growth[k * m + j];
+                            paths[k].step(s, s_next);
+                            s = s_next;
+                        }
+                        prices[k] = s;
+                    }
+                }
+                for (int k = 0; k < g; k++) {
+                    const double v = paths[k].value();
+                    sum    += v;
+                    square += v * v;
+                }
+            }
+            sums[b]    = sum;
+            squares[b] = square;
+        });
+
+        // Blocks are fixed and summed along a fixed tree: the price does not depend on threads.
+        const double sum    = pairwise_sum(sums.data(), num_blocks);
+        const double square = pairwise_sum(squares.data(), num_blocks);
+        const double mean = sum / num_paths;
+        const double variance = std::max(0.0, square / num_paths - mean * mean);
+        const double discount = exp(-r * maturity);
+
+        MonteCarloResult<T> result;
+        result.price = static_cast<T>(discount * mean);
+        result.standard_error = static_cast<T>(discount * sqrt(variance / num_paths));
+        result.num_paths = num_paths;
+        return result;
+    }
+
+private:
+    T spot;
+    T r;
+    T q;
+    T sigma;
+    T maturity;
+    int num_steps;
+};
+
+}
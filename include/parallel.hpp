@@ -0,0 +1,137 @@
+/**
+ * \file
+ * Minimal data-parallel helpers shared by the finance engines, run on the shared
+ * finance::TaskScheduler.
+ */
+
+#pragma once
+
+#include <algorithm>
+
+#include <task_scheduler.hpp>
+
+
+
+namespace finance {
+
+namespace detail {
+
+/**
+ * A range of indices that splits itself in halves, spawning the upper half, while it has budget
+ * left. A range stolen from the worker it was queued for means the load is uneven so it gets
+ * more budget, never more than the root had: the number of chunks stays proportional to the
+ * number of threads.
+ */
+template <class Function>
+class RangeTask : public Task
+{
+public:
+    RangeTask(const int begin, const int end, const int depth, const int max_depth, Function& func,
+              TaskGroup& group, const int first, const int count)
+        : begin(begin),
+          end(end),
+          depth(depth),
+          max_depth(max_depth),
+          func(func),
+          group(group),
+          first(first),
+          count(count)
+    {}
+
+    void execute() override
+    {
+        int last = end;
+        // Halves are never shorter than half the root's chunks, however often ranges are stolen.
+        const int grain = std::max(1, count >> (max_depth + 1));
+        int budget = stolen() ? std::min(depth + 2, max_depth) : depth;
+        while (last - begin >= 2 * grain and budget > 0) {
+            const int middle = begin + (last - begin) / 2;
+            budget--;
+            group.spawn(new RangeTask(middle, last, budget, max_depth, func, group, first, count),
+                        worker_of(middle));
+            last = middle;
+        }
+        for (int i = begin; i < last and not group.is_cancelled(); i++)
+            func(i);
+    }
+
+private:
+    /**
+     * Maps the index to a worker so the same part of a range goes to the same worker from one
+     * call to the next, where its data may still be cached.
+     */
+    int worker_of(const int i) const
+    {
+        const int num_workers = group.get_scheduler().get_num_workers();
+        if (num_workers == 0)
+            return -1;
+        return static_cast<int>(static_cast<long long>(i - first) * num_workers / count);
+    }
+
+    const int begin;
+    const int end;
+    const int depth;
+    const int max_depth;
+    Function& func;
+    TaskGroup& group;
+    const int first;
+    const int count;
+};
+
+}
+
+/**
+ * \brief Runs \p func(i) for every \p i in [\p begin, \p end) as tasks of \p group, and waits for
+ *        the group.
+ * \ingroup Finance
+ *
+ * \par
+ *      The range is split in halves recursively, into about four chunks per thread of the
+ *      scheduler; chunks stolen by idle threads are split further, down to half that size, so
+ *      uneven indices balance without fine chunks when the load is even. Cancelling \p group
+ *      stops the loop before the next index.
+ *
+ * \param begin First index of the range.
+ * \param end   One past the last index of the range.
+ * \param func  Callable invoked once per index. Invocations for different indices may run
+ *              concurrently so \p func must not write shared state. It may itself run parallel
+ *              loops, which share the same threads.
+ * \param group Group the chunks run in.
+ * \exception   The first exception thrown by \p func, rethrown on the calling thread once the
+ *              running chunks have finished. The indices not started by then are skipped.
+ */
+template <class Function>
+void parallel_for(const int begin, const int end, Function func, TaskGroup& group)
+{
+    const int count = end - begin;
+    if (count <= 0) return;
+
+    const int concurrency = group.get_scheduler().concurrency();
+    if (concurrency == 1 or count == 1) {
+        for (int i = begin; i < end and not group.is_cancelled(); i++)
+            func(i);
+        return;
+    }
+
+    int depth = 2;
+    while ((1 << depth) < 4 * concurrency)
+        depth++;
+    group.spawn(new detail::RangeTask<Function>(begin, end, depth, depth, func, group, begin, count));
+    group.wait();
+}
+
+/**
+ * \brief Runs \p func(i) for every \p i in [\p begin, \p end) on the shared
+ *        finance::TaskScheduler.
+ * \ingroup Finance
+ *
+ * \see parallel_for(const int, const int, Function, TaskGroup&)
+ */
+template <class Function>
+void parallel_for(const int begin, const int end, Function func)
+{
+    TaskGroup group;
+    parallel_for(begin, end, func, group);
+}
+
+}
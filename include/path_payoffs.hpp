@@ -0,0 +1,204 @@
+/**
+ * \file
+ * Streaming payoff accumulators of path dependent options for finance::MonteCarloEngine.
+ *
+ * Each accumulator keeps only the running state it needs (a running sum, the running extrema
+ * or a survival probability) and updates it as each step of the path is generated.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+
+
+
+namespace finance {
+
+/**
+ * \brief The AsianOption class is an arithmetic average price option.
+ * \ingroup Finance
+ *
+ * \par
+ *      The average is taken over the prices at the end of every time step,
+ *      \f$ A = \frac{1}{n}\sum_{i=1}^{n}S_{t_{i}} \f$, and the payoff is \f$ \max(A - K, 0) \f$ for a
+ *      call and \f$ \max(K - A, 0) \f$ for a put.
+ */
+template <class T>
+class AsianOption
+{
+public:
+    AsianOption(const T strike,
+                const bool call)
+        : strike{strike},
+          call{call}
+    {}
+
+    void start(const T, const T, const T)
+    {
+        sum = 0.0;
+        count = 0;
+    }
+
+    void step(const T, const T s_next)
+    {
+        sum += s_next;
+        count++;
+    }
+
+    T value() const
+    {
+        const T average = sum / count;
+        return call ? std::max(average - strike, T(0)) : std::max(strike - average, T(0));
+    }
+
+private:
+    T strike;
+    bool call;
+    T sum = 0.0;
+    int count = 0;
+};
+
+/**
+ * \brief The BarrierOption class is a European option that is activated (knock-in) or
+ *        cancelled (knock-out) when the price crosses a barrier.
+ * \ingroup Finance
+ *
+ * \par Brownian bridge correction.
+ *      Checking the barrier only at the simulated dates misses the crossings that happen
+ *      between them and biases the price. Conditional on the end points of a step, the log
+ *      price is a Brownian bridge and the probability that it crossed the barrier \f$ B \f$
+ *      inside the step is
+ *
+ *      \f$ p = e^{-2\frac{\ln(B/S_{t})\ln(B/S_{t+\Delta t})}{\sigma^{2}\Delta t}} \f$
+ * \par
+ *      The accumulator keeps the probability that the path survived every step,
+ *      \f$ \prod(1 - p) \f$, and weights the payoff with it. Continuous monitoring is then matched
+ *      with far fewer time steps, and the estimator is smooth in the barrier.
+ */
+template <class T>
+class BarrierOption
+{
+public:
+    /**
+     * \param strike                Strike \f$ K \f$.
+     * \param barrier               Barrier \f$ B \f$.
+     * \param call                  True for a call, false for a put.
+     * \param up                    True if the barrier is above the spot, false if below.
+     * \param knock_in              True for a knock-in, false for a knock-out.
+     * \param continuous_monitoring True to apply the Brownian bridge correction, false to
+     *                              monitor only at the simulated dates.
+     */
+    BarrierOption(const T strike,
+                  const T barrier,
+                  const bool call,
+                  const bool up,
+                  const bool knock_in,
+                  const bool continuous_monitoring = true)
+        : strike{strike},
+          barrier{barrier},
+          call{call},
+          up{up},
+          knock_in{knock_in},
+          continuous_monitoring{continuous_monitoring}
+    {}
+
+    void start(const T spot, const T sigma, const T dt)
+    {
+        survival = crossed(spot) ? T(0) : T(1);
+        inv_var = T(1) / (sigma * sigma * dt);
+        last = spot;
+    }
+
+    void step(const T s_prev, const T s_next)
+    {
+        last = s_next;
+        if (survival == T(0)) return;
+        if (crossed(s_next)) {
+            survival = 0.0;
+        } else if (continuous_monitoring) {
+            const T p = exp(-2 * log(barrier / s_prev) * log(barrier / s_next) * inv_var);
+            survival *= 1 - p;
+        }
+    }
+
+    T value() const
+    {
+        const T payoff = call ? std::max(last - strike, T(0)) : std::max(strike - last, T(0));
+        return payoff * (knock_in ? 1 - survival : survival);
+    }
+
+private:
+    bool crossed(const T s) const
+    {
+        return up ? s >= barrier : s <= barrier;
+    }
+
+    T strike;
+    T barrier;
+    bool call;
+    bool up;
+    bool knock_in;
+    bool continuous_monitoring;
+    T survival = 1.0;
+    T inv_var = 0.0;
+    T last = 0.0;
+};
+
+/**
+ * \brief The LookbackOption class pays against the extreme price reached over the path.
+ * \ingroup Finance
+ *
+ * \par
+ *      With floating strike a call pays \f$ S_{T} - \min S \f$ and a put \f$ \max S - S_{T} \f$. With
+ *      fixed strike \f$ K \f$ a call pays \f$ \max(\max S - K, 0) \f$ and a put
+ *      \f$ \max(K - \min S, 0) \f$. Only the running minimum and maximum are kept.
+ */
+template <class T>
+class LookbackOption
+{
+public:
+    /**
+     * \param call      True for a call, false for a put.
+     * \param floating  True for a floating strike, false for the fixed \p strike.
+     * \param strike    Fixed strike, ignored when \p floating.
+     */
+    LookbackOption(const bool call,
+                   const bool floating,
+                   const T strike = 0.0)
+        : call{call},
+          floating{floating},
+          strike{strike}
+    {}
+
+    void start(const T spot, const T, const T)
+    {
+        minimum = spot;
+        maximum = spot;
+        last = spot;
+    }
+
+    void step(const T, const T s_next)
+    {
+        minimum = std::min(minimum, s_next);
+        maximum = std::max(maximum, s_next);
+        last = s_next;
+    }
+
+    T value() const
+    {
+        if (floating)
+            return call ? last - minimum : maximum - last;
+        return call ? std::max(maximum - strike, T(0)) : std::max(strike - minimum, T(0));
+    }
+
+private:
+    bool call;
+    bool floating;
+    T strike;
+    T minimum = 0.0;
+    T maximum = 0.0;
+    T last = 0.0;
+};
+
+}
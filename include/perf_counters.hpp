@@ -0,0 +1,74 @@
+/**
+ * \file
+ * The finance::PerfCounters class reads the hardware performance counters of the calling thread.
+ */
+
+#pragma once
+
+
+
+namespace finance {
+
+/**
+ * \brief The PerfCounters class counts hardware events (cycles, instructions, misses) over a
+ *        region of code run by the calling thread.
+ * \ingroup Finance
+ *
+ * \par
+ *      On Linux the counters are opened with perf_event_open for the calling thread only, in
+ *      user mode. Each event is opened on its own: an event the CPU, the kernel or the
+ *      permissions (<tt>/proc/sys/kernel/perf_event_paranoid</tt>) do not allow is simply
+ *      reported unavailable, and on other systems every event is unavailable. Callers never
+ *      need to handle an error: they check available() and skip what is missing.
+ * \par
+ *      When the kernel multiplexes more events than the hardware has counters, counts are
+ *      scaled by the fraction of time each event was actually counted.
+ * \par
+ *      FpAssists is the raw Intel event FP_ASSIST.ANY and is only opened on Intel CPUs; its
+ *      encoding is not guaranteed on every Intel generation.
+ */
+class PerfCounters
+{
+public:
+    enum Event { Cycles, Instructions, CacheMisses, BranchMisses, FpAssists, NumEvents };
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator =(const PerfCounters&) = delete;
+
+    /**
+     * \brief Returns true if at least one event can be counted.
+     */
+    bool available() const;
+
+    bool available(const Event e) const;
+
+    /**
+     * \brief Returns the short name of \p e, as used in reports: "cycles", "instructions"...
+     */
+    static const char* name(const Event e);
+
+    /**
+     * \brief Resets and starts every available counter.
+     */
+    void start();
+
+    /**
+     * \brief Stops the counters and records their values.
+     */
+    void stop();
+
+    /**
+     * \brief Returns the count of \p e between the last start() and stop(), NaN if \p e is not
+     *        available.
+     */
+    double value(const Event e) const;
+
+private:
+    int descriptors[NumEvents];
+    double values[NumEvents];
+};
+
+}
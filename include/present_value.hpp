@@ -7,14 +7,81 @@
 #pragma once
 
 #include <cmath>
+#include <limits>
 #include <vector>
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
+
+#include <batch_kernels.hpp>
+#include <latency_histogram.hpp>
+#include <solver_statistics.hpp>
+#include <trace.hpp>
 
 
 
 namespace finance {
 
+namespace detail {
+
+/**
+ * Sums of discounted cash flows: plain loops, and the dispatched batch kernels for double.
+ */
+template <class T>
+T pv_continuous_sum(const std::vector<T>& cflow_times, const std::vector<T>& cflow_amounts, const T r)
+{
+    T present_value = 0.0;
+    for (std::size_t t = 0; t < cflow_times.size(); t++) {
+        present_value += cflow_amounts[t] * exp(-r * cflow_times[t]);
+    }
+    return present_value;
+}
+
+inline double pv_continuous_sum(const std::vector<double>& cflow_times, const std::vector<double>& cflow_amounts, const double r)
+{
+    return pv_continuous_batch(cflow_times.data(), cflow_amounts.data(), static_cast<int>(cflow_times.size()), r);
+}
+
+/**
+ * Discount factors \f$ e^{-rt} \f$, computed for double by the same kernel as
+ * pv_continuous_sum(), so a sum over them gives the same value.
+ */
+template <class T>
+void discount_factors_continuous(const std::vector<T>& times, const T r, std::vector<T>& factors)
+{
+    factors.resize(times.size());
+    for (std::size_t i = 0; i < times.size(); i++)
+        factors[i] = exp(-r * times[i]);
+}
+
+inline void discount_factors_continuous(const std::vector<double>& times, const double r, std::vector<double>& factors)
+{
+    factors.resize(times.size());
+    for (std::size_t i = 0; i < times.size(); i++)
+        factors[i] = -r * times[i];
+    exp_batch(factors.data(), factors.data(), static_cast<int>(factors.size()));
+}
+
+template <class T>
+T pv_discrete_sum(const std::vector<T>& cflow_times, const std::vector<T>& cflow_amounts, const T r)
+{
+    T present_value = 0.0;
+    for (std::size_t t = 0; t < cflow_times.size(); t++) {
+        present_value += cflow_amounts[t] / pow(1.0 + r, cflow_times[t]);
+    }
+    return present_value;
+}
+
+inline double pv_discrete_sum(const std::vector<double>& cflow_times, const std::vector<double>& cflow_amounts, const double r)
+{
+    // Below -1 only pow() defines the discount factors, at integer times.
+    if (not (r > -1.0))
+        return pv_discrete_sum<double>(cflow_times, cflow_amounts, r);
+    return pv_discrete_batch(cflow_times.data(), cflow_amounts.data(), static_cast<int>(cflow_times.size()), r);
+}
+
+}
+
 /**
  * \brief The PresentValue class provides methods to calculate the current value of a stream of
  *        future payments.
@@ -57,16 +124,30 @@ public:
      *      get the following present value calculation:
      *
      *      \f$ PV = \sum_{i=1}^{n}e^{-rt_{i}}C_{t_{i}} \f$
+     * \par
+     *      For double the sum runs in pv_continuous_batch() at the instruction set level of the
+     *      host.
      */
     T pv_continuous_cflow(const std::vector<T>& cflow_times,
                           const std::vector<T>& cflow_amounts,
                           const T r)
     {
-        T present_value = 0.0;
-        for (int t = 0; t < cflow_times.size(); t++) {
-            present_value += cflow_amounts[t] * exp(-r * cflow_times[t]);
-        }
-        return present_value;
+        return detail::pv_continuous_sum(cflow_times, cflow_amounts, r);
+    }
+
+    /**
+     * \brief Stores in \p factors the continuously compounded discount factors
+     *        \f$ d_{t} = e^{-rt} \f$ of \p times, the ones pv_continuous_cflow() applies.
+     *
+     * \param times         Instants of time.
+     * \param r             Constant interest rate.
+     * \param factors       Resized to the number of times.
+     */
+    void discount_factors_continuous(const std::vector<T>& times,
+                                     const T r,
+                                     std::vector<T>& factors)
+    {
+        detail::discount_factors_continuous(times, r, factors);
     }
 
     /**
@@ -115,6 +196,8 @@ public:
      *
      * \param cflow_times   Instants of time.
      * \param cflow_amounts Cash flow at time \f$ t \f$.
+     * \param statistics    If not null, receives the iterations, evaluations and final bracket of
+     *                      the solve, also when it throws std::domain_error.
      * \exception std::invalid_argument if parameter sizes differ
      * \exception std::domain_error if an internall error occurrs.
      * \return              The calculated internal rate of return.
@@ -135,28 +218,41 @@ public:
      *      know that there is one IRR, we find the IRR using an iterative bisection process.
      */
     T irr_discrete_cflow(const std::vector<T>& cflow_times,
-                         const std::vector<T>& cflow_amounts)
+                         const std::vector<T>& cflow_amounts,
+                         SolverStatistics* statistics = nullptr)
     {
         if (cflow_times.size() != cflow_amounts.size())
             throw std::invalid_argument("sizes differ");
+        FINANCE_TRACE_SCOPE("irr_discrete_cflow");
 
         const T ACCURACY = 1.0e-5;
         const int MAX_ITERATIONS = 50;
+        SolverStatistics stats;
         T x1 = 0.0;
         T x2 = 0.2;
 
         T f1 = pv_discrete_cflow(cflow_times, cflow_amounts, x1);
         T f2 = pv_discrete_cflow(cflow_times, cflow_amounts, x2);
+        stats.function_evaluations = 2;
         for (int i = 0; i < MAX_ITERATIONS and (f1*f2) >= 0.0; i++) {
             if (fabs(f1) < fabs(f2))
                 f1 = pv_discrete_cflow(cflow_times, cflow_amounts, x1+=1.6*(x1-x2));
             else
                 f2 = pv_discrete_cflow(cflow_times, cflow_amounts, x2+=1.6*(x2-x1));
+            stats.bracket_iterations++;
+            stats.function_evaluations++;
         }
-        if (f1*f2 > 0.0)
+        stats.bracket_lower = std::min(x1, x2);
+        stats.bracket_upper = std::max(x1, x2);
+        stats.bracket_width = fabs(x2 - x1);
+        if (f1*f2 > 0.0) {
+            stats.failure = SolverStatistics::NoBracket;
+            if (statistics) *statistics = stats;
             throw std::domain_error("f1 & f2 are wrong");
+        }
 
         T f = pv_discrete_cflow(cflow_times, cflow_amounts, x1);
+        stats.function_evaluations++;
         T rtb;
         T dx=0;
         if (f < 0.0) {
@@ -170,11 +266,18 @@ public:
             dx *= 0.5;
             T x_mid = rtb + dx;
             T f_mid = pv_discrete_cflow(cflow_times, cflow_amounts, x_mid);
+            stats.iterations++;
+            stats.function_evaluations++;
+            stats.bracket_width = fabs(dx);
             if (f_mid <= 0.0)
                 rtb = x_mid;
-            if ((fabs(f_mid) < ACCURACY) or (fabs(dx) < ACCURACY))
+            if ((fabs(f_mid) < ACCURACY) or (fabs(dx) < ACCURACY)) {
+                if (statistics) *statistics = stats;
                 return x_mid;
+            }
         }
+        stats.failure = SolverStatistics::NotConverged;
+        if (statistics) *statistics = stats;
         throw std::domain_error("Solution not found");
     }
 
@@ -203,16 +306,15 @@ public:
      *      Then the present value of a stream of cash flow paid at discrete dates \f$ t = 1,2,..N \f$ is:
      *
      *      \f$ PV = \sum_{t=1}^{N}\frac{C_{t}}{(1+r)^{t}} \f$
+     * \par
+     *      For double, and \f$ r > -1 \f$, the sum runs in pv_discrete_batch() at the instruction
+     *      set level of the host.
      */
     T pv_discrete_cflow(const std::vector<T>& cflow_times,
                         const std::vector<T>& cflow_amounts,
                         const T r)
     {
-        T present_value = 0.0;
-        for (int t = 0; t < cflow_times.size(); t++) {
-            present_value += cflow_amounts[t] / pow(1.0 + r, cflow_times[t]);
-        }
-        return present_value;
+        return detail::pv_discrete_sum(cflow_times, cflow_amounts, r);
     }
 
 
@@ -307,6 +409,52 @@ public:
         return initial_cflow_amount * ((1/(r-g) - pow((1+g)/(1+r), num_periods) * (1/(r-g)) ));
     }
 
+    /**
+     * \brief Calculates pv_growing_annuity() for every pair of an interest rate and a growing rate.
+     *
+     * \param initial_cflow_amount  Initial payment \f$ X_{1} \f$.
+     * \param num_periods           Number of of periods \f$ T \f$ into the future.
+     * \param rates                 Interest rates \f$ r_{j} \f$.
+     * \param growths               Growing rates \f$ g_{i} \f$.
+     * \param pvs                   Output present values, row major: the value for \f$ g_{i} \f$ and
+     *                              \f$ r_{j} \f$ is at <tt>i * rates.size() + j</tt>.
+     *
+     * \par
+     *      The power is computed as \f$ e^{T(\ln(1+g) - \ln(1+r))} \f$, with the logarithms
+     *      computed once per rate instead of once per point, so the inner loop is one exponential
+     *      and one division over contiguous memory. When \f$ r = g \f$ the limit
+     *      \f$ PV = \frac{X_{1}T}{1+r} \f$ is used.
+     */
+    void pv_growing_annuity_grid(const T initial_cflow_amount,
+                                 const T num_periods,
+                                 const std::vector<T>& rates,
+                                 const std::vector<T>& growths,
+                                 std::vector<T>& pvs)
+    {
+        FINANCE_TRACE_SCOPE("pv_growing_annuity_grid");
+        FINANCE_LATENCY_SCOPE("pv_growing_annuity_grid");
+        const int n = static_cast<int>(rates.size());
+        std::vector<T> log_discount(n);
+        for (int j = 0; j < n; j++)
+            log_discount[j] = log1p(rates[j]);
+
+        const T tolerance = sqrt(std::numeric_limits<T>::epsilon());
+        pvs.resize(growths.size() * n);
+        if (n == 0)
+            return;
+        for (std::size_t i = 0; i < growths.size(); i++) {
+            const T g = growths[i];
+            const T log_growth = log1p(g);
+            T* row = &pvs[i * n];
+            for (int j = 0; j < n; j++) {
+                const T d = rates[j] - g;
+                const T ratio = exp(num_periods * (log_growth - log_discount[j]));
+                row[j] = (std::fabs(d) > tolerance) ? initial_cflow_amount * (1 - ratio) / d
+                                                    : initial_cflow_amount * num_periods / (1 + rates[j]);
+            }
+        }
+    }
+
 private:
     T present_value;
 };
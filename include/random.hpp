@@ -0,0 +1,502 @@
+/**
+ * \file
+ * Random number generators whose output depends only on a stream identifier and a position,
+ * never on how the work was split between threads: the counter-based Philox and Threefry
+ * generators, xoshiro generators with jump-ahead, and bulk uniform and normal variates.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include <vector_math.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief Identifies one stream of random numbers: the run (the seed), the instrument and the
+ *        path drawn within it.
+ * \ingroup Finance
+ *
+ * \par
+ *      The counter-based generators key on the run and put the instrument and path in the upper
+ *      words of their counter, so two distinct streams of one run never share a value, however
+ *      many values each draws.
+ */
+struct StreamId
+{
+    StreamId(const std::uint64_t run, const std::uint32_t instrument = 0, const std::uint32_t path = 0)
+        : run{run},
+          instrument{instrument},
+          path{path}
+    {}
+
+    std::uint64_t run;
+    std::uint32_t instrument;
+    std::uint32_t path;
+};
+
+namespace detail {
+
+inline std::uint64_t rotl64(const std::uint64_t x, const int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * Steele, Lea and Flood's SplitMix64: advances \p x and returns a well mixed 64 bit word.
+ */
+inline std::uint64_t splitmix64(std::uint64_t& x)
+{
+    std::uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * One round of Philox-4x32 on the counter \p c0 ... \p c3 with the round key \p k0, \p k1.
+ */
+FINANCE_VMATH_INLINE void philox_round(std::uint32_t& c0, std::uint32_t& c1, std::uint32_t& c2, std::uint32_t& c3,
+                                       const std::uint32_t k0, const std::uint32_t k1)
+{
+    const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c0;
+    const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2;
+    c0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+    c2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<std::uint32_t>(p1);
+    c3 = static_cast<std::uint32_t>(p0);
+}
+
+/**
+ * Philox-4x32-10 (Salmon et al., SC'11): encrypts the counter \p c0 ... \p c3 under the key
+ * \p k0, \p k1 in place. The rounds are unrolled by hand so that loops over counters
+ * vectorize.
+ */
+FINANCE_VMATH_INLINE void philox4x32(std::uint32_t& c0, std::uint32_t& c1, std::uint32_t& c2, std::uint32_t& c3,
+                                     const std::uint32_t k0, const std::uint32_t k1)
+{
+    const std::uint32_t W0 = 0x9E3779B9u;
+    const std::uint32_t W1 = 0xBB67AE85u;
+    philox_round(c0, c1, c2, c3, k0, k1);
+    philox_round(c0, c1, c2, c3, k0 + W0, k1 + W1);
+    philox_round(c0, c1, c2, c3, k0 + 2 * W0, k1 + 2 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 3 * W0, k1 + 3 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 4 * W0, k1 + 4 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 5 * W0, k1 + 5 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 6 * W0, k1 + 6 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 7 * W0, k1 + 7 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 8 * W0, k1 + 8 * W1);
+    philox_round(c0, c1, c2, c3, k0 + 9 * W0, k1 + 9 * W1);
+}
+
+/**
+ * Threefry-4x64-20 (Salmon et al., SC'11): the Threefish block cipher without tweak, encrypting
+ * \p x in place under the key \p k.
+ */
+inline void threefry4x64(const std::uint64_t (&k)[4], std::uint64_t (&x)[4])
+{
+    static const int Rotations[8][2] = { {14, 16}, {52, 57}, {23, 40}, {5, 37},
+                                         {25, 33}, {46, 12}, {58, 22}, {32, 32} };
+    const std::uint64_t ks[5] = { k[0], k[1], k[2], k[3],
+                                  0x1BD11BDAA9FC1A22ull ^ k[0] ^ k[1] ^ k[2] ^ k[3] };
+    for (int i = 0; i < 4; i++)
+        x[i] += ks[i];
+    for (int round = 0; round < 20; round++) {
+        const int* r = Rotations[round % 8];
+        // Even rounds mix the pairs (0, 1) and (2, 3), odd ones (0, 3) and (2, 1).
+        const int a = (round % 2 == 0) ? 1 : 3;
+        const int b = 4 - a;
+        x[0] += x[a];
+        x[a] = rotl64(x[a], r[0]) ^ x[0];
+        x[2] += x[b];
+        x[b] = rotl64(x[b], r[1]) ^ x[2];
+        if (round % 4 == 3) {
+            const int s = round / 4 + 1;
+            for (int i = 0; i < 4; i++)
+                x[i] += ks[(s + i) % 5];
+            x[3] += s;
+        }
+    }
+}
+
+template <class Engine>
+std::uint64_t draw64(Engine& engine, std::true_type)
+{
+    const std::uint64_t lo = engine();
+    return lo | (static_cast<std::uint64_t>(engine()) << 32);
+}
+
+template <class Engine>
+std::uint64_t draw64(Engine& engine, std::false_type)
+{
+    return engine();
+}
+
+/**
+ * Fields shared by the xoshiro256 generators: the state, its update and the jumps.
+ */
+class Xoshiro256State
+{
+public:
+    /**
+     * \brief Advances the state by \f$ 2^{128} \f$ draws: 2^128 non-overlapping sequences of
+     *        2^128 draws each can be cut from one seed.
+     */
+    void jump()
+    {
+        static const std::uint64_t Jump[4] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+                                               0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+        apply(Jump);
+    }
+
+    /**
+     * \brief Advances the state by \f$ 2^{192} \f$ draws, to cut 2^64 starting points each
+     *        of which jump() can split further.
+     */
+    void long_jump()
+    {
+        static const std::uint64_t LongJump[4] = { 0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull,
+                                                   0x77710069854ee241ull, 0x39109bb02acbe635ull };
+        apply(LongJump);
+    }
+
+protected:
+    explicit Xoshiro256State(const StreamId& stream)
+    {
+        std::uint64_t x = stream.run;
+        x = splitmix64(x) ^ ((static_cast<std::uint64_t>(stream.instrument) << 32) | stream.path);
+        for (int i = 0; i < 4; i++)
+            s[i] = splitmix64(x);
+    }
+
+    void advance()
+    {
+        const std::uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rotl64(s[3], 45);
+    }
+
+    std::uint64_t s[4];
+
+private:
+    void apply(const std::uint64_t (&polynomial)[4])
+    {
+        std::uint64_t t[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++) {
+            for (int b = 0; b < 64; b++) {
+                if (polynomial[i] & (1ull << b)) {
+                    for (int j = 0; j < 4; j++)
+                        t[j] ^= s[j];
+                }
+                advance();
+            }
+        }
+        for (int j = 0; j < 4; j++)
+            s[j] = t[j];
+    }
+};
+
+}
+
+/**
+ * \brief Returns the uniform variate in (0, 1) of the 64 random bits \p bits: the odd multiples
+ *        of \f$ 2^{-53} \f$, so neither 0 nor 1 is ever drawn and normal quantiles stay finite.
+ */
+FINANCE_VMATH_INLINE double uniform_double(const std::uint64_t bits)
+{
+    return vmath::detail::from_bits(0x3ff0000000000000ull | (bits >> 12)) - (1.0 - 1.0 / 9007199254740992.0);
+}
+
+/**
+ * \brief Returns the uniform variate in (0, 1) of the 32 random bits \p bits: the odd multiples
+ *        of \f$ 2^{-24} \f$.
+ */
+FINANCE_VMATH_INLINE float uniform_float(const std::uint32_t bits)
+{
+    return static_cast<float>((bits >> 9) * 2u + 1u) * (1.0f / 16777216.0f);
+}
+
+/**
+ * \brief The Philox4x32 class is the counter-based Philox-4x32-10 generator, one stream per
+ *        StreamId.
+ * \ingroup Finance
+ *
+ * \par
+ *      Word \f$ w \f$ of a stream is word \f$ w \bmod 4 \f$ of the encryption of the counter
+ *      \f$ (\lfloor w/4 \rfloor, path, instrument) \f$ under the key \f$ run \f$, so seek() and
+ *      discard() jump anywhere in O(1), and the value at a position is the same whichever thread
+ *      draws it. Passes BigCrush; \f$ 2^{66} \f$ words per stream.
+ * \par
+ *      Satisfies UniformRandomBitGenerator. uniform_batch() and normal_batch() fill arrays from
+ *      the same streams with SIMD.
+ */
+class Philox4x32
+{
+public:
+    typedef std::uint32_t result_type;
+
+    explicit Philox4x32(const StreamId& stream)
+        : key{static_cast<std::uint32_t>(stream.run), static_cast<std::uint32_t>(stream.run >> 32)},
+          path{stream.path},
+          instrument{stream.instrument},
+          position{0}
+    {
+        refill();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const result_type word = buffer[position % 4];
+        if (++position % 4 == 0)
+            refill();
+        return word;
+    }
+
+    /**
+     * \brief Moves to word \p word of the stream.
+     */
+    void seek(const std::uint64_t word)
+    {
+        position = word;
+        refill();
+    }
+
+    /**
+     * \brief Skips the next \p z words.
+     */
+    void discard(const unsigned long long z)
+    {
+        seek(position + z);
+    }
+
+    /**
+     * \brief Returns the position of the next word in the stream.
+     */
+    std::uint64_t get_position() const
+    {
+        return position;
+    }
+
+private:
+    void refill()
+    {
+        const std::uint64_t block = position / 4;
+        buffer[0] = static_cast<std::uint32_t>(block);
+        buffer[1] = static_cast<std::uint32_t>(block >> 32);
+        buffer[2] = path;
+        buffer[3] = instrument;
+        detail::philox4x32(buffer[0], buffer[1], buffer[2], buffer[3], key[0], key[1]);
+    }
+
+    std::uint32_t key[2];
+    std::uint32_t path;
+    std::uint32_t instrument;
+    std::uint64_t position;
+    std::uint32_t buffer[4];
+};
+
+/**
+ * \brief The Threefry4x64 class is the counter-based Threefry-4x64-20 generator, one stream per
+ *        StreamId.
+ * \ingroup Finance
+ *
+ * \par
+ *      Word \f$ w \f$ of a stream is word \f$ w \bmod 4 \f$ of the encryption of the counter
+ *      \f$ (\lfloor w/4 \rfloor, path, instrument, 0) \f$ under the key \f$ (run, 0, 0, 0) \f$.
+ *      It draws 64 bit words with only additions, rotations and exclusive ors, for hosts where
+ *      the multiplications of Philox4x32 are slow; seek() and discard() are O(1) as well.
+ */
+class Threefry4x64
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Threefry4x64(const StreamId& stream)
+        : key{stream.run, 0, 0, 0},
+          path{stream.path},
+          instrument{stream.instrument},
+          position{0}
+    {
+        refill();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const result_type word = buffer[position % 4];
+        if (++position % 4 == 0)
+            refill();
+        return word;
+    }
+
+    /**
+     * \brief Moves to word \p word of the stream.
+     */
+    void seek(const std::uint64_t word)
+    {
+        position = word;
+        refill();
+    }
+
+    /**
+     * \brief Skips the next \p z words.
+     */
+    void discard(const unsigned long long z)
+    {
+        seek(position + z);
+    }
+
+    /**
+     * \brief Returns the position of the next word in the stream.
+     */
+    std::uint64_t get_position() const
+    {
+        return position;
+    }
+
+private:
+    void refill()
+    {
+        buffer[0] = position / 4;
+        buffer[1] = path;
+        buffer[2] = instrument;
+        buffer[3] = 0;
+        detail::threefry4x64(key, buffer);
+    }
+
+    std::uint64_t key[4];
+    std::uint64_t path;
+    std::uint64_t instrument;
+    std::uint64_t position;
+    std::uint64_t buffer[4];
+};
+
+/**
+ * \brief The Xoshiro256StarStar class is Blackman and Vigna's xoshiro256** generator: the
+ *        fastest sequential source of 64 bit words here, with jump-ahead for parallel streams.
+ * \ingroup Finance
+ *
+ * \par
+ *      The state is seeded by hashing the StreamId with SplitMix64: distinct ids give unrelated
+ *      sequences, which overlap only with negligible probability. Sequences that provably never
+ *      overlap are cut from one id with jump() and long_jump(). Satisfies
+ *      UniformRandomBitGenerator.
+ */
+class Xoshiro256StarStar : public detail::Xoshiro256State
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Xoshiro256StarStar(const StreamId& stream)
+        : Xoshiro256State(stream)
+    {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const result_type word = detail::rotl64(s[1] * 5, 7) * 9;
+        advance();
+        return word;
+    }
+};
+
+/**
+ * \brief The Xoshiro256Plus class is Blackman and Vigna's xoshiro256+ generator: a little
+ *        faster than Xoshiro256StarStar, with weaker low bits, so meant for floating point
+ *        variates, which only use the upper 53.
+ * \ingroup Finance
+ */
+class Xoshiro256Plus : public detail::Xoshiro256State
+{
+public:
+    typedef std::uint64_t result_type;
+
+    explicit Xoshiro256Plus(const StreamId& stream)
+        : Xoshiro256State(stream)
+    {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()()
+    {
+        const result_type word = s[0] + s[3];
+        advance();
+        return word;
+    }
+};
+
+/**
+ * \brief Returns a uniform variate in (0, 1) drawn from 64 bits of \p engine: one word of a 64
+ *        bit engine, two of a 32 bit one, the first as the low half.
+ * \ingroup Finance
+ */
+template <class Engine>
+double uniform_variate(Engine& engine)
+{
+    typedef std::integral_constant<bool, (Engine::max() <= 0xffffffffull)> Narrow;
+    return uniform_double(detail::draw64(engine, Narrow()));
+}
+
+/**
+ * \brief Returns a standard normal variate: the normal quantile of uniform_variate().
+ * \ingroup Finance
+ *
+ * \par
+ *      One uniform per normal, so a normal drawn at a known position can be drawn again after a
+ *      seek, unlike with rejection or Box-Muller methods.
+ */
+template <class Engine>
+double normal_variate(Engine& engine)
+{
+    return vmath::normal_quantile(uniform_variate(engine));
+}
+
+/**
+ * \brief Stores in \p u the \p n uniform variates of \p stream from the \p first th on, as
+ *        uniform_variate() of a Philox4x32 on \p stream seeked to word 2 \p first would.
+ * \ingroup Finance
+ *
+ * \par
+ *      Compiled for each finance::Isa level like the batch kernels, with the counters of
+ *      several blocks encrypted in each SIMD register.
+ */
+void uniform_batch(const StreamId& stream, const std::uint64_t first, double* u, const int n);
+
+/**
+ * \brief Stores in \p u the \p n uniform variates of \p stream from the \p first th on, each
+ *        uniform_float() of one word of a Philox4x32 on \p stream seeked to word \p first.
+ * \ingroup Finance
+ */
+void uniform_batch(const StreamId& stream, const std::uint64_t first, float* u, const int n);
+
+/**
+ * \brief Stores in \p z the standard normal quantiles of the uniforms uniform_batch() would
+ *        store: the \p n normal variates of \p stream from the \p first th on.
+ * \ingroup Finance
+ *
+ * \par
+ *      In double, the values are those of normal_variate() of a seeked Philox4x32, to the bit at
+ *      the Generic level; the other levels may differ in the last bit where they contract to
+ *      fused multiply-adds.
+ */
+void normal_batch(const StreamId& stream, const std::uint64_t first, double* z, const int n);
+void normal_batch(const StreamId& stream, const std::uint64_t first, float* z, const int n);
+
+}
@@ -0,0 +1,116 @@
+/**
+ * \file
+ * Floating point sums whose result depends only on the values summed and their order, not on
+ * the number of threads or how a parallel loop was chunked.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include <parallel.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief Number of values a block of reproducible_sum() holds. Blocks are the unit of parallel
+ *        work and their boundaries are fixed, so the tree of additions is fixed too.
+ */
+const int REPRODUCIBLE_SUM_BLOCK = 1024;
+
+namespace detail {
+
+/**
+ * Sums get(first) ... get(first + n - 1), n > 0, along a tree whose shape depends only on n:
+ * halves down to 16 values, summed in 4 interleaved lanes.
+ */
+template <class Get>
+double pairwise_sum(const Get& get, const int first, const int n)
+{
+    if (n <= 16) {
+        double lanes[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for (int i = 0; i < n; i++)
+            lanes[i & 3] += get(first + i);
+        return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    }
+    const int half = n / 2;
+    return pairwise_sum(get, first, half) + pairwise_sum(get, first + half, n - half);
+}
+
+}
+
+/**
+ * \brief Returns the sum of \p values[0] ... \p values[\p n - 1] as a pairwise tree of fixed
+ *        shape: the same values give the same bits on every run.
+ * \ingroup Finance
+ *
+ * \par
+ *      Pairwise summation also bounds the rounding error by \f$ O(\epsilon \log n) \f$ instead of
+ *      \f$ O(\epsilon n) \f$ for a running sum, at about the same speed.
+ */
+inline double pairwise_sum(const double* values, const int n)
+{
+    if (n <= 0)
+        return 0.0;
+    return detail::pairwise_sum([values](const int i) { return values[i]; }, 0, n);
+}
+
+/**
+ * \brief Returns the sum of \p values[0] ... \p values[\p n - 1]: the pairwise sums of blocks of
+ *        REPRODUCIBLE_SUM_BLOCK values, summed pairwise.
+ * \ingroup Finance
+ *
+ * \par
+ *      The result is bitwise identical to the parallel reproducible_sum() of the same values.
+ */
+inline double reproducible_sum(const double* values, const int n)
+{
+    if (n <= 0)
+        return 0.0;
+    const int num_blocks = (n + REPRODUCIBLE_SUM_BLOCK - 1) / REPRODUCIBLE_SUM_BLOCK;
+    return detail::pairwise_sum([values, n](const int b) {
+        const int first = b * REPRODUCIBLE_SUM_BLOCK;
+        const int count = n - first < REPRODUCIBLE_SUM_BLOCK ? n - first : REPRODUCIBLE_SUM_BLOCK;
+        return pairwise_sum(values + first, count);
+    }, 0, num_blocks);
+}
+
+inline double reproducible_sum(const std::vector<double>& values)
+{
+    return reproducible_sum(values.data(), static_cast<int>(values.size()));
+}
+
+/**
+ * \brief Returns the sum of \p func(i) for every \p i in [\p begin, \p end), computing the values
+ *        in parallel.
+ * \ingroup Finance
+ *
+ * \par
+ *      Each block of REPRODUCIBLE_SUM_BLOCK indices is evaluated and summed by one task, and the
+ *      block sums are added along a fixed tree once all are known, so the result does not depend
+ *      on the number of threads or on which thread ran which block: it is the serial
+ *      reproducible_sum() of the values \p func returns.
+ *
+ * \param func  Callable returning the value of an index as a double. Invocations for different
+ *              indices may run concurrently.
+ * \exception   The first exception thrown by \p func, as parallel_for().
+ */
+template <class Function>
+double reproducible_sum(const int begin, const int end, Function func)
+{
+    const int n = end - begin;
+    if (n <= 0)
+        return 0.0;
+    const int num_blocks = (n + REPRODUCIBLE_SUM_BLOCK - 1) / REPRODUCIBLE_SUM_BLOCK;
+    std::vector<double> sums(num_blocks);
+    parallel_for(0, num_blocks, [&](const int b) {
+        const int first = begin + b * REPRODUCIBLE_SUM_BLOCK;
+        const int count = end - first < REPRODUCIBLE_SUM_BLOCK ? end - first : REPRODUCIBLE_SUM_BLOCK;
+        sums[b] = detail::pairwise_sum([&func](const int i) { return static_cast<double>(func(i)); }, first, count);
+    });
+    return pairwise_sum(sums.data(), num_blocks);
+}
+
+}
@@ -0,0 +1,226 @@
+/**
+ * \file
+ * Convergence statistics of the root finders: finance::SolverStatistics describes one solve and
+ * finance::SolverTelemetry aggregates them over a batch.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <iostream>
+#include <algorithm>
+
+
+
+namespace finance {
+
+/**
+ * \brief How one call of a bracketing root finder went.
+ * \ingroup Finance
+ *
+ * \par
+ *      The solvers fill it before returning or throwing, so a failed solve still reports how far
+ *      it got. bracket_lower and bracket_upper are the bracket once expanded, before it is
+ *      narrowed, and bracket_width is the width left when the solver stopped.
+ */
+struct SolverStatistics
+{
+    enum Failure { None, NoBracket, NotConverged };
+
+    int bracket_iterations = 0;
+    int iterations = 0;
+    int function_evaluations = 0;
+    double bracket_lower = std::numeric_limits<double>::quiet_NaN();
+    double bracket_upper = std::numeric_limits<double>::quiet_NaN();
+    double bracket_width = std::numeric_limits<double>::quiet_NaN();
+    Failure failure = None;
+};
+
+/**
+ * \brief Aggregates finance::SolverStatistics: counters per failure reason and histograms of
+ *        iterations, function evaluations and final bracket widths.
+ * \ingroup Finance
+ *
+ * \par
+ *      Counts up to 255 have a bucket each and larger ones share an overflow bucket, so
+ *      percentiles of iterations and evaluations are exact for the solvers of this library.
+ *      Bracket widths are bucketed by power of ten from 1e-20 to 1e+4.
+ * \par
+ *      Recording is not synchronized: parallel batches record into one object per worker and
+ *      merge() them afterwards.
+ */
+class SolverTelemetry
+{
+public:
+    enum Histogram { BracketIterations, Iterations, FunctionEvaluations, NumHistograms };
+
+    static const int MAX_COUNT = 256;
+    static const int MIN_WIDTH_EXPONENT = -20;
+    static const int MAX_WIDTH_EXPONENT = 4;
+    static const int NUM_WIDTHS = MAX_WIDTH_EXPONENT - MIN_WIDTH_EXPONENT + 1;
+
+    SolverTelemetry()
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int h = 0; h < NumHistograms; h++)
+            std::fill(counts[h], counts[h] + MAX_COUNT + 1, 0);
+        std::fill(widths, widths + NUM_WIDTHS, 0);
+        calls = 0;
+        std::fill(failures, failures + 3, 0);
+        std::fill(totals, totals + NumHistograms, 0);
+    }
+
+    void record(const SolverStatistics& s)
+    {
+        calls++;
+        failures[s.failure]++;
+        add(BracketIterations, s.bracket_iterations);
+        add(Iterations, s.iterations);
+        add(FunctionEvaluations, s.function_evaluations);
+        if (not std::isnan(s.bracket_width))
+            widths[width_bucket(s.bracket_width)]++;
+    }
+
+    void merge(const SolverTelemetry& other)
+    {
+        for (int h = 0; h < NumHistograms; h++) {
+            for (int i = 0; i <= MAX_COUNT; i++)
+                counts[h][i] += other.counts[h][i];
+            totals[h] += other.totals[h];
+        }
+        for (int i = 0; i < NUM_WIDTHS; i++)
+            widths[i] += other.widths[i];
+        calls += other.calls;
+        for (int f = 0; f < 3; f++)
+            failures[f] += other.failures[f];
+    }
+
+    long long get_calls() const
+    {
+        return calls;
+    }
+
+    long long get_failures(const SolverStatistics::Failure f) const
+    {
+        return failures[f];
+    }
+
+    /**
+     * \brief Sum of \p h over every recorded call.
+     */
+    long long get_total(const Histogram h) const
+    {
+        return totals[h];
+    }
+
+    double mean(const Histogram h) const
+    {
+        return calls > 0 ? static_cast<double>(totals[h]) / calls : 0.0;
+    }
+
+    /**
+     * \brief Number of calls where \p h was \p count, or more than 255 for the last bucket.
+     */
+    long long get_count(const Histogram h, const int count) const
+    {
+        return counts[h][count_bucket(count)];
+    }
+
+    /**
+     * \brief Smallest value of \p h not exceeded by a fraction \p q of the calls, 0 <= q <= 1.
+     *        Returns MAX_COUNT if it falls in the overflow bucket.
+     */
+    int percentile(const Histogram h, const double q) const
+    {
+        const long long rank = static_cast<long long>(std::ceil(q * calls));
+        long long seen = 0;
+        for (int i = 0; i < MAX_COUNT; i++) {
+            seen += counts[h][i];
+            if (seen >= rank and seen > 0)
+                return i;
+        }
+        return MAX_COUNT;
+    }
+
+    /**
+     * \brief Number of final bracket widths in [1e<sup>e</sup>, 1e<sup>e+1</sup>); the first and
+     *        last buckets also hold everything below and above.
+     */
+    long long get_width_count(const int exponent) const
+    {
+        return widths[exponent_bucket(exponent)];
+    }
+
+    /**
+     * \brief Writes a readable summary, each line prefixed with \p label:
+     *
+     *          irr: calls=1000 converged=998 no_bracket=2 not_converged=0
+     *          irr: function_evaluations mean=21.3 p50=20 p90=24 p99=31 p99.9=58 max=58
+     *          irr: bracket_width 1e-06:998
+     */
+    void write_report(std::ostream& os, const char* label) const
+    {
+        static const char* const names[NumHistograms] = { "bracket_iterations", "iterations", "function_evaluations" };
+
+        os << label << ": calls=" << calls
+           << " converged=" << failures[SolverStatistics::None]
+           << " no_bracket=" << failures[SolverStatistics::NoBracket]
+           << " not_converged=" << failures[SolverStatistics::NotConverged] << '\n';
+        if (calls == 0)
+            return;
+        for (int h = 0; h < NumHistograms; h++) {
+            const Histogram histogram = static_cast<Histogram>(h);
+            os << label << ": " << names[h]
+               << " mean=" << mean(histogram)
+               << " p50=" << percentile(histogram, 0.5)
+               << " p90=" << percentile(histogram, 0.9)
+               << " p99=" << percentile(histogram, 0.99)
+               << " p99.9=" << percentile(histogram, 0.999)
+               << " max=" << percentile(histogram, 1.0) << '\n';
+        }
+        os << label << ": bracket_width";
+        for (int e = MIN_WIDTH_EXPONENT; e <= MAX_WIDTH_EXPONENT; e++)
+            if (widths[e - MIN_WIDTH_EXPONENT] > 0)
+                os << " 1e" << e << ':' << widths[e - MIN_WIDTH_EXPONENT];
+        os << '\n';
+    }
+
+private:
+    void add(const Histogram h, const int value)
+    {
+        counts[h][count_bucket(value)]++;
+        totals[h] += value;
+    }
+
+    static int count_bucket(const int count)
+    {
+        return count < 0 ? 0 : (count > MAX_COUNT ? MAX_COUNT : count);
+    }
+
+    static int exponent_bucket(const int exponent)
+    {
+        if (exponent < MIN_WIDTH_EXPONENT) return 0;
+        if (exponent > MAX_WIDTH_EXPONENT) return NUM_WIDTHS - 1;
+        return exponent - MIN_WIDTH_EXPONENT;
+    }
+
+    static int width_bucket(const double width)
+    {
+        if (std::isinf(width)) return NUM_WIDTHS - 1;
+        if (not (width > 0.0)) return 0;
+        return exponent_bucket(static_cast<int>(std::floor(std::log10(width))));
+    }
+
+    long long counts[NumHistograms][MAX_COUNT + 1];
+    long long widths[NUM_WIDTHS];
+    long long calls;
+    long long failures[3];
+    long long totals[NumHistograms];
+};
+
+}
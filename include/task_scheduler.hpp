@@ -0,0 +1,237 @@
+/**
+ * \file
+ * The finance::TaskScheduler class: one pool of worker threads, shared by every engine, that
+ * balances tasks by work stealing.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+
+
+namespace finance {
+
+class TaskGroup;
+
+/**
+ * \brief A unit of work run by the finance::TaskScheduler. Tasks are created by
+ *        finance::TaskGroup::run() and parallel_for(), which own them.
+ */
+class Task
+{
+public:
+    Task()
+        : group{nullptr},
+          owner{-1}
+    {}
+
+    virtual ~Task() {}
+
+    virtual void execute() = 0;
+
+    /**
+     * \brief Returns true if the task runs on another thread than the worker whose deque it
+     *        was queued in, or on a worker when it was queued in the shared queue.
+     */
+    bool stolen() const;
+
+private:
+    friend class TaskGroup;
+    friend class TaskScheduler;
+
+    TaskGroup* group;
+    int owner;
+};
+
+/**
+ * \brief The TaskScheduler class runs tasks on a fixed pool of worker threads.
+ * \ingroup Finance
+ *
+ * \par
+ *      Each worker has its own deque: it pushes and pops the tasks it spawns at the back, in
+ *      last in first out order which keeps their data in its caches, and idle workers steal
+ *      the oldest tasks from the front of the others' deques. Tasks spawned by threads outside
+ *      the pool go to a shared queue. Workers without work sleep until tasks are spawned.
+ * \par
+ *      A thread waiting for a finance::TaskGroup runs pending tasks instead of blocking, so
+ *      nested parallelism (a parallel loop inside a task) adds no thread and cannot deadlock:
+ *      the number of running threads stays the pool size plus the threads that wait.
+ * \par
+ *      Deques are guarded by a mutex each: tasks here are coarse (blocks of paths, names,
+ *      chunks of a range), so a lock per push or steal costs little and keeps the deques
+ *      simple.
+ */
+class TaskScheduler
+{
+public:
+    /**
+     * \param num_workers   Number of worker threads. Callers waiting on a group also run
+     *                      tasks, so hardware threads minus one uses every core.
+     */
+    explicit TaskScheduler(const int num_workers);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator =(const TaskScheduler&) = delete;
+
+    /**
+     * \brief Returns the scheduler shared by the engines, started on first use with one worker
+     *        less than the hardware threads, or FINANCE_NUM_THREADS - 1 if that environment
+     *        variable is set.
+     */
+    static TaskScheduler& instance();
+
+    int get_num_workers() const;
+
+    /**
+     * \brief Returns the number of threads that run tasks while one thread waits: the workers
+     *        and the waiting thread.
+     */
+    int concurrency() const;
+
+    /**
+     * \brief Returns the number of tasks spawned since the scheduler started.
+     */
+    long long get_spawned() const;
+
+    /**
+     * \brief Returns the index of the calling worker thread, or -1 if the caller is not one of
+     *        the workers of any scheduler.
+     */
+    static int current_worker();
+
+    /**
+     * \brief Queues \p task, owned by the scheduler from then on.
+     *
+     * \param affinity  Worker whose deque receives the task, modulo the number of workers, or
+     *                  -1 for the calling worker's deque (the shared queue for other threads).
+     *                  The task is still stolen by another worker if that one is busy.
+     */
+    void spawn(Task* task, const int affinity = -1);
+
+    /**
+     * \brief Runs one pending task on the calling thread, if there is one.
+     *
+     * \return false if no task was pending.
+     */
+    bool run_one();
+
+private:
+    struct Queue;
+
+    Task* find_task(const int self);
+    void execute(Task* task);
+    void work(const int self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::unique_ptr<Queue> shared;
+    std::vector<std::thread> workers;
+    std::atomic<long long> spawned;
+    std::atomic<long> queued;
+    std::atomic<int> sleeping;
+    std::atomic<bool> stop;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+};
+
+/**
+ * \brief The TaskGroup class runs a set of tasks on a finance::TaskScheduler and waits for them.
+ * \ingroup Finance
+ *
+ * \par
+ *      cancel() skips the tasks of the group that have not started; running tasks can poll
+ *      is_cancelled() to stop early. A task that throws cancels the group and its exception,
+ *      the first one, is rethrown by wait().
+ * \par
+ *      Tasks may run more tasks in the same group or in nested groups.
+ */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::instance())
+        : scheduler(scheduler),
+          pending{0},
+          cancelled{false}
+    {}
+
+    /**
+     * \brief Waits for the tasks still running. Their exceptions are discarded.
+     */
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator =(const TaskGroup&) = delete;
+
+    /**
+     * \brief Runs \p func() as a task of the group.
+     *
+     * \param affinity  See TaskScheduler::spawn().
+     */
+    template <class Function>
+    void run(Function func, const int affinity = -1)
+    {
+        spawn(new FunctionTask<Function>(func), affinity);
+    }
+
+    /**
+     * \brief Runs \p task, which the group owns from then on, as a task of the group.
+     */
+    void spawn(Task* task, const int affinity = -1);
+
+    /**
+     * \brief Waits until every task of the group has run or been skipped, running pending
+     *        tasks meanwhile.
+     *
+     * \exception The first exception thrown by a task of the group.
+     */
+    void wait();
+
+    void cancel();
+
+    bool is_cancelled() const
+    {
+        return cancelled.load(std::memory_order_relaxed);
+    }
+
+    TaskScheduler& get_scheduler() const
+    {
+        return scheduler;
+    }
+
+private:
+    friend class TaskScheduler;
+
+    template <class Function>
+    struct FunctionTask : Task
+    {
+        explicit FunctionTask(const Function& func)
+            : func(func)
+        {}
+
+        void execute() override
+        {
+            func();
+        }
+
+        Function func;
+    };
+
+    void fail(std::exception_ptr e);
+    void finished();
+
+    TaskScheduler& scheduler;
+    std::atomic<long> pending;
+    std::atomic<bool> cancelled;
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+}
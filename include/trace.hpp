@@ -0,0 +1,114 @@
+/**
+ * \file
+ * Scoped trace events recorded into per-thread ring buffers and exported to the Chrome trace
+ * JSON and Perfetto formats.
+ *
+ * Tracing is compiled in only when FINANCE_TRACING is defined (<tt>CONFIG += tracing</tt> in the
+ * qmake projects). Otherwise the macros expand to nothing and cost nothing.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <iostream>
+
+
+
+namespace finance {
+
+/**
+ * \brief Starts or stops recording trace events. Recording is off at startup.
+ */
+void trace_enable(const bool on);
+
+/**
+ * \brief Returns true while trace events are recorded.
+ */
+inline bool trace_enabled();
+
+/**
+ * \brief Discards every recorded event. No thread may be recording.
+ */
+void trace_clear();
+
+/**
+ * \brief Writes the recorded events in the Chrome trace event JSON format, readable by
+ *        chrome://tracing and ui.perfetto.dev. No thread may be recording.
+ */
+void write_chrome_trace(std::ostream& os);
+
+/**
+ * \brief Writes the recorded events as a Perfetto protobuf trace, one track per thread.
+ *        No thread may be recording.
+ */
+void write_perfetto_trace(std::ostream& os);
+
+/**
+ * \brief Records a begin event named \p name on the calling thread. \p name must be a string
+ *        with static storage (a literal).
+ */
+void trace_begin(const char* name);
+
+/**
+ * \brief Records the end event of \p name on the calling thread.
+ */
+void trace_end(const char* name);
+
+/**
+ * \brief The TraceScope class records a begin event on construction and the matching end event
+ *        on destruction, if recording was on at construction.
+ *
+ * \par
+ *      Each thread writes its events into its own ring buffer with plain stores and publishes
+ *      them with one release store, so recording takes no lock and never waits on another
+ *      thread. When a buffer is full the oldest events are overwritten. Buffers are kept when
+ *      their thread exits and reused by the next thread, so short lived worker threads do not
+ *      grow memory.
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+        : name{trace_enabled() ? name : nullptr}
+    {
+        if (this->name != nullptr)
+            trace_begin(this->name);
+    }
+
+    ~TraceScope()
+    {
+        if (name != nullptr)
+            trace_end(name);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator =(const TraceScope&) = delete;
+
+private:
+    const char* name;
+};
+
+namespace detail {
+
+extern std::atomic<bool> trace_recording;
+
+}
+
+inline bool trace_enabled()
+{
+    return detail::trace_recording.load(std::memory_order_relaxed);
+}
+
+}
+
+#define FINANCE_TRACE_CONCAT_(a, b) a##b
+#define FINANCE_TRACE_CONCAT(a, b) FINANCE_TRACE_CONCAT_(a, b)
+
+#if defined(FINANCE_TRACING)
+/**
+ * \brief Traces the enclosing scope as an event named \p name (a string literal).
+ */
+#define FINANCE_TRACE_SCOPE(name) ::finance::TraceScope FINANCE_TRACE_CONCAT(finance_trace_scope_, __COUNTER__)(name)
+#else
+#define FINANCE_TRACE_SCOPE(name) do {} while (false)
+#endif
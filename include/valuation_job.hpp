@@ -0,0 +1,75 @@
+/**
+ * \file
+ * Batch valuation jobs: a stream of cash flows valued with finance::PresentValue, and the text
+ * formats used to read jobs and write results.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include <solver_statistics.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief A stream of cash flows to value at a flat discretely compounded rate.
+ * \ingroup Finance
+ */
+struct ValuationJob
+{
+    std::string name;
+    double rate;
+    std::vector<double> cflow_times;
+    std::vector<double> cflow_amounts;
+};
+
+/**
+ * \brief The outcome of a finance::ValuationJob.
+ * \ingroup Finance
+ */
+struct ValuationResult
+{
+    std::string name;
+    double present_value;
+    double irr;
+    bool unique_irr;
+    bool irr_found;
+    SolverStatistics irr_statistics;
+};
+
+/**
+ * \brief Reads jobs, one per line, from \p is.
+ *
+ * \par Job format.
+ *      Each line holds a name, the rate and then pairs of time and amount, separated by blanks:
+ *
+ *          bond-1 0.05 0 -100 1 10 2 110
+ * \par
+ *      Empty lines and lines starting with '#' are skipped.
+ *
+ * \exception std::invalid_argument if a line is malformed, naming the line number.
+ */
+std::vector<ValuationJob> read_valuation_jobs(std::istream& is);
+
+/**
+ * \brief Values a job: present value, internal rate of return and whether the IRR is unique.
+ *
+ * \par
+ *      When no IRR is found irr_found is false and irr is NaN; the job itself does not fail.
+ *      irr_statistics tells how the IRR solve went either way.
+ */
+ValuationResult evaluate(const ValuationJob& job);
+
+/**
+ * \brief Writes results to \p os as CSV with a header line:
+ *
+ *          name,present_value,irr,unique_irr
+ */
+void write_valuation_results(std::ostream& os, const std::vector<ValuationResult>& results);
+
+}
@@ -0,0 +1,680 @@
+/**
+ * \file
+ * Elementary functions written as branch free code the compiler vectorizes: exp, log, pow, erf,
+ * erfc, the normal distribution and its quantile, sine and cosine, for float and double.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__)
+#define FINANCE_VMATH_INLINE inline __attribute__((always_inline))
+#else
+#define FINANCE_VMATH_INLINE inline
+#endif
+
+
+
+namespace finance {
+
+/**
+ * \brief Vectorizable elementary functions.
+ * \ingroup Finance
+ *
+ * \par
+ *      Each function is straight line code: special cases are computed alongside and selected,
+ *      never branched to, so a loop calling them under <tt>#pragma omp simd</tt> compiles to
+ *      SIMD code of the instruction set of the enclosing function, from SSE2 to AVX-512. The
+ *      batch kernels of batch_kernels.hpp are built that way, once per finance::Isa level.
+ *      Vectorizing needs <tt>-fno-trapping-math -fno-math-errno</tt>, set in the qmake projects.
+ * \par
+ *      pow and the erf family need exact products, which FMA computes in two instructions and
+ *      plain SSE2 in about seventeen: their template parameter \p Fma is true where the caller is
+ *      compiled for FMA, as the AVX2 and AVX-512 kernels are. Elsewhere true still gives the
+ *      same results, through a library call to fma() that does not vectorize.
+ * \par
+ *      The error bounds below are the maxima <tt>stock-market-benchmark --accuracy</tt> measures
+ *      against long double references at every level, rounded up, over samples of the whole
+ *      domain, subnormals included. The erf family loses a few ulp to its Chebyshev series,
+ *      whose double coefficients and recurrence round at each of about 25 terms. The float
+ *      functions evaluate the double ones and round once: 0.5 ulp but for the rare double
+ *      rounding.
+ */
+namespace vmath {
+
+namespace detail {
+
+FINANCE_VMATH_INLINE double from_bits(const std::uint64_t b)
+{
+    double x;
+    std::memcpy(&x, &b, sizeof(x));
+    return x;
+}
+
+FINANCE_VMATH_INLINE std::uint64_t to_bits(const double x)
+{
+    std::uint64_t b;
+    std::memcpy(&b, &x, sizeof(b));
+    return b;
+}
+
+const double INF          = std::numeric_limits<double>::infinity();
+const double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+const double LN2_HI       = 6.93147180369123816490e-01;   // Low 32 bits zero: k * LN2_HI is exact.
+const double LN2_LO       = 1.90821492927058770002e-10;
+const double LOG2_E       = 1.44269504088896338700e+00;
+const double ROUND        = 6755399441055744.0;           // 1.5 * 2^52: x + ROUND rounds x to an integer.
+const double TWO52        = 4503599627370496.0;
+
+/**
+ * Sum a + b = s + e exactly, for |a| >= |b|.
+ */
+FINANCE_VMATH_INLINE void fast_two_sum(const double a, const double b, double& s, double& e)
+{
+    s = a + b;
+    e = b - (s - a);
+}
+
+/**
+ * Product a b = p + e, exact but for a_lo b_lo, below 2^-104 relative. a and b are split by
+ * masking the low 27 bits rather than by Dekker's multiplication, which FMA contraction breaks.
+ */
+template <bool Fma>
+FINANCE_VMATH_INLINE void two_product(const double a, const double b, double& p, double& e)
+{
+    const std::uint64_t MASK = 0xfffffffff8000000ull;
+    const double a_hi = from_bits(to_bits(a) & MASK);
+    const double a_lo = a - a_hi;
+    const double b_hi = from_bits(to_bits(b) & MASK);
+    const double b_lo = b - b_hi;
+    p = a * b;
+    e = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+}
+
+/**
+ * Product a b = p + e exactly, in two instructions on FMA hardware.
+ */
+template <>
+FINANCE_VMATH_INLINE void two_product<true>(const double a, const double b, double& p, double& e)
+{
+    p = a * b;
+    e = std::fma(a, b, -p);
+}
+
+/**
+ * e^(x + tail) for a tail much smaller than ulp(x): 2^k e^r with |r| <= log(2)/2, e^r by its
+ * Taylor series to degree 13. 2^k is applied in two halves so subnormal results round once.
+ */
+FINANCE_VMATH_INLINE double exp_tail(double x, double tail)
+{
+    // Past the bounds the tail may be large too: it is dropped with the clamp.
+    tail = x > 710.0 ? 0.0 : tail;
+    tail = x < -746.0 ? 0.0 : tail;
+    x = x > 710.0 ? 710.0 : x;
+    x = x < -746.0 ? -746.0 : x;
+    const double t = x * LOG2_E + ROUND;
+    const double k = t - ROUND;
+    const std::int64_t ki = static_cast<std::int64_t>(to_bits(t) - to_bits(ROUND));
+    const double r = ((x - k * LN2_HI) - k * LN2_LO) + tail;
+
+    double p = 1.0 / 6227020800.0;
+    p = p * r + 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    // k is in [-1077, 1025]: shifting k + 2048 halves it without an arithmetic shift.
+    const std::int64_t k1 = static_cast<std::int64_t>(static_cast<std::uint64_t>(ki + 2048) >> 1) - 1024;
+    const std::int64_t k2 = ki - k1;
+    const double s1 = from_bits(static_cast<std::uint64_t>(k1 + 1023) << 52);
+    const double s2 = from_bits(static_cast<std::uint64_t>(k2 + 1023) << 52);
+    return p * s1 * s2;
+}
+
+/**
+ * Splits x > 0, finite, into 2^e m with sqrt(2)/2 <= m < sqrt(2), e returned as a double.
+ */
+FINANCE_VMATH_INLINE double log_reduce(const double x, double& e)
+{
+    const bool subnormal = x < std::numeric_limits<double>::min();
+    const double xs = subnormal ? x * 18014398509481984.0 : x;   // 2^54
+    const std::uint64_t b = to_bits(xs);
+    // The biased exponent as a double without an integer conversion.
+    e = from_bits(0x4330000000000000ull | ((b >> 52) & 0x7ff)) - TWO52;
+    e -= subnormal ? 1023.0 + 54.0 : 1023.0;
+    const double m = from_bits((b & 0x000fffffffffffffull) | 0x3ff0000000000000ull);
+    const bool high = m > 1.41421356237309504880;
+    e = high ? e + 1.0 : e;
+    return high ? 0.5 * m : m;
+}
+
+/**
+ * Sum a + b = s + e exactly, in any order of magnitude.
+ */
+FINANCE_VMATH_INLINE void two_sum(const double a, const double b, double& s, double& e)
+{
+    s = a + b;
+    const double bb = s - a;
+    e = (a - (s - bb)) + (b - bb);
+}
+
+/**
+ * The odd series of 2 atanh(s) past 2s + 2/3 s^3, divided by s: z^2 (2/5 + 2/7 z + ... + 2/27 z^11)
+ * with z = s^2 <= 0.0295, truncated below 2^-72.
+ */
+FINANCE_VMATH_INLINE double atanh_rest(const double z)
+{
+    double R = 2.0 / 27.0;
+    R = R * z + 2.0 / 25.0;
+    R = R * z + 2.0 / 23.0;
+    R = R * z + 2.0 / 21.0;
+    R = R * z + 2.0 / 19.0;
+    R = R * z + 2.0 / 17.0;
+    R = R * z + 2.0 / 15.0;
+    R = R * z + 2.0 / 13.0;
+    R = R * z + 2.0 / 11.0;
+    R = R * z + 2.0 / 9.0;
+    R = R * z + 2.0 / 7.0;
+    R = R * z + 2.0 / 5.0;
+    return R * z * z;
+}
+
+/**
+ * The odd series of 2 atanh(s) past 2s, divided by s.
+ */
+FINANCE_VMATH_INLINE double atanh_tail(const double z)
+{
+    return 2.0 / 3.0 * z + atanh_rest(z);
+}
+
+/**
+ * log x = hi + lo to about 2^-63 relative, for x > 0 finite: pow() needs more than double
+ * precision for y log x, |y| reaching 2000 below overflow. 2s and 2/3 s^3 are carried in
+ * double-double, the rest of the series is below 2^-14.
+ */
+template <bool Fma>
+FINANCE_VMATH_INLINE void log_extended(const double x, double& hi, double& lo)
+{
+    const double TWO_THIRDS_HI = 6.66666666666666629659e-01;
+    const double TWO_THIRDS_LO = 3.70074341541718826838e-17;
+    double e;
+    const double m = log_reduce(x, e);
+    const double f = m - 1.0;                    // Exact.
+    double u, u_lo;
+    fast_two_sum(2.0, f, u, u_lo);
+    // s = f / u to within an ulp and s_lo from the exact residual: one division.
+    const double inverse = 1.0 / u;
+    const double s = f * inverse;
+    double p, p_lo;
+    two_product<Fma>(s, u, p, p_lo);
+    const double s_lo = (((f - p) - p_lo) - s * u_lo) * inverse;
+
+    double z, z_lo;
+    two_product<Fma>(s, s, z, z_lo);
+    double c, c_lo;
+    two_product<Fma>(s, z, c, c_lo);
+    c_lo += s * z_lo + 3.0 * z * s_lo;           // s^3 = c + c_lo
+    double t, t_lo;
+    two_product<Fma>(c, TWO_THIRDS_HI, t, t_lo);
+    t_lo += c * TWO_THIRDS_LO + c_lo * TWO_THIRDS_HI;
+    const double rest = s * atanh_rest(z) + 2.0 * z * z * s_lo;   // The rest at s + s_lo.
+
+    double a, a_lo;
+    two_sum(e * LN2_HI, 2.0 * s, a, a_lo);      // e * LN2_HI is exact.
+    double b, b_lo;
+    two_sum(a, t, b, b_lo);
+    const double low = a_lo + b_lo + (((2.0 * s_lo + t_lo) + rest) + e * LN2_LO);
+    fast_two_sum(b, low, hi, lo);
+}
+
+template <int K>
+struct Clenshaw
+{
+    static FINANCE_VMATH_INLINE void step(const double* c, const double t2, double& b1, double& b2)
+    {
+        const double b0 = t2 * b1 - b2 + c[K];
+        b2 = b1;
+        b1 = b0;
+        Clenshaw<K - 1>::step(c, t2, b1, b2);
+    }
+};
+
+template <>
+struct Clenshaw<0>
+{
+    static FINANCE_VMATH_INLINE void step(const double*, const double, double&, double&)
+    {}
+};
+
+/**
+ * Sum of c[k] T_k(t), k = 0 ... N - 1, for t in [-1, 1].
+ */
+template <int N>
+FINANCE_VMATH_INLINE double chebyshev(const double (&c)[N], const double t)
+{
+    double b1 = 0.0;
+    double b2 = 0.0;
+    Clenshaw<N - 1>::step(c, 2.0 * t, b1, b2);
+    return t * b1 - b2 + c[0];
+}
+
+// Chebyshev series fitted in long double: erf(x)/x in 2x^2 - 1 on [0, 1], erfc(x) e^(x^2) in
+// (4x - 7)/5 on [0.5, 3] and in (2x - 9)/3 on [3, 6], and x erfc(x) e^(x^2) in 1/x on [6, 28].
+const double ERF_SMALL[] = {
+    9.75476939382654118e-01, -1.42261205103713650e-01, 1.00355821875997963e-02,
+    -5.76876469976748420e-04, 2.74199312521960772e-05, -1.10431755073448989e-06,
+    3.84887554203880693e-08, -1.18085825345434765e-09, 3.23342157953002154e-11,
+    -7.99101599778181919e-13, 1.79908876424966773e-14, -3.71919292238565004e-16,
+    7.31836466427715493e-18
+};
+
+const double ERFC_MIDDLE[] = {
+    3.37675412912703143e-01, -2.03126827903252621e-01, 5.60120658575802774e-02,
+    -1.43826276299964095e-02, 3.47617646488347382e-03, -7.97047504515357064e-04,
+    1.74418006029943928e-04, -3.65999163082405873e-05, 7.39293159357856217e-06,
+    -1.44204597169854545e-06, 2.72349569381790941e-07, -4.99170465224126766e-08,
+    8.89611499864942845e-09, -1.54428439043478296e-09, 2.61509032202338065e-10,
+    -4.32575597236295301e-11, 6.99801381122758232e-12, -1.10839412734847768e-12,
+    1.72045907522681156e-13, -2.61945928272874779e-14, 3.91502422928541300e-15,
+    -5.74956477827209861e-16, 8.28967428555260597e-17, -1.16212920363290007e-17,
+    1.74285499227044830e-18
+};
+
+const double ERFC_LARGE[] = {
+    1.29026899654741678e-01, -4.20426781395117979e-02, 6.69848712109275338e-03,
+    -1.04509167917437576e-03, 1.59858998849494137e-04, -2.39982615872386828e-05,
+    3.53906410506355145e-06, -5.13130320064919132e-07, 7.32026861126343613e-08,
+    -1.02821931292583388e-08, 1.42290887079953100e-09, -1.94111579580590992e-10,
+    2.61179634858518446e-11, -3.46779620174289990e-12, 4.54560296647901514e-13,
+    -5.88486476165636181e-14, 7.52766673141914588e-15, -9.51775008632693788e-16,
+    1.19005192708345376e-16, -1.47230137514479465e-17, 1.76408728481495604e-18,
+    -1.68051336735253192e-19
+};
+
+const double ERFC_TAIL[] = {
+    5.60793985634050918e-01, -3.59593902553495808e-03, -5.49703367599666979e-04,
+    1.04489584294675538e-05, 6.49358991583533152e-07, -3.41488318547384252e-08,
+    -7.23351709509389311e-10, 1.18940480061573487e-10, -1.49776654295198660e-12,
+    -3.88765213597819257e-13, 2.17358954186092079e-14, 8.22250796096712941e-16,
+    -1.46771158594793939e-16, 3.67815587015707348e-18
+};
+
+/**
+ * erf(x) for |x| <= 1.
+ */
+FINANCE_VMATH_INLINE double erf_small(const double x)
+{
+    return x * chebyshev(ERF_SMALL, 2.0 * x * x - 1.0);
+}
+
+/**
+ * erfc(a) for 0.5 <= a <= 28, given a^2 = sq + sq_lo: e^(-a^2) times the series of the interval
+ * of a. Past 28 erfc underflows and the result is 0.
+ */
+FINANCE_VMATH_INLINE double erfc_large(const double a, const double sq, const double sq_lo)
+{
+    const double gauss = exp_tail(-sq, -sq_lo);
+    const double T0 = 1.0 / 6.0 + 1.0 / 28.0;
+    const double T1 = 1.0 / 6.0 - 1.0 / 28.0;
+    double g = chebyshev(ERFC_TAIL, (2.0 / a - T0) / T1) / a;
+    g = a < 6.0 ? chebyshev(ERFC_LARGE, (2.0 * a - 9.0) / 3.0) : g;
+    g = a < 3.0 ? chebyshev(ERFC_MIDDLE, 0.8 * a - 1.4) : g;
+    return gauss * g;
+}
+
+/**
+ * x - k pi/2 = y + y_lo for the k nearest x / (pi/2): pi/2 is split in three 33 bit parts and a
+ * tail (Cody and Waite), so k times each part is exact for |k| < 2^20 and the rounding error of
+ * each subtraction is carried into y_lo. Returns k as a double.
+ */
+FINANCE_VMATH_INLINE double reduce_half_pi(const double x, double& y, double& y_lo)
+{
+    const double INV_PIO2 = 6.36619772367581382433e-01;
+    const double PIO2_1   = 1.57079632673412561417e+00;
+    const double PIO2_2   = 6.07710050630396597660e-11;
+    const double PIO2_3   = 2.02226624871116645580e-21;
+    const double PIO2_3T  = 8.47842766036889956997e-32;
+    const double k = (x * INV_PIO2 + ROUND) - ROUND;
+    const double r1 = x - k * PIO2_1;
+    const double w2 = k * PIO2_2;
+    const double r2 = r1 - w2;
+    const double e2 = (r1 - r2) - w2;
+    const double w3 = k * PIO2_3;
+    const double r3 = r2 - w3;
+    const double e3 = (r2 - r3) - w3;
+    const double tail = (e2 + e3) - k * PIO2_3T;
+    y = r3 + tail;
+    y_lo = (r3 - y) + tail;
+    return k;
+}
+
+/**
+ * sin(x + y) for |x| <= pi/4 and y much smaller than ulp(x), by the polynomial of fdlibm.
+ */
+FINANCE_VMATH_INLINE double sin_kernel(const double x, const double y)
+{
+    const double z = x * x;
+    const double v = z * x;
+    const double r = 8.33333333332248946124e-03 + z * (-1.98412698298579493134e-04 + z * (2.75573137070700676789e-06
+                   + z * (-2.50507602534068634195e-08 + z * 1.58969099521155010221e-10)));
+    return x - ((z * (0.5 * y - v * r) - y) - v * -1.66666666666666324348e-01);
+}
+
+/**
+ * cos(x + y) for |x| <= pi/4 and y much smaller than ulp(x), by the polynomial of fdlibm.
+ */
+FINANCE_VMATH_INLINE double cos_kernel(const double x, const double y)
+{
+    const double z = x * x;
+    const double w = z * z;
+    const double r = z * (4.16666666666666019037e-02 + z * (-1.38888888888741095749e-03 + z * 2.48015872894767294178e-05))
+                   + w * w * (-2.75573143513906633035e-07 + z * (2.08757232129817482790e-09 + z * -1.13596475577881948265e-11));
+    const double hz = 0.5 * z;
+    const double one_hz = 1.0 - hz;
+    return one_hz + (((1.0 - one_hz) - hz) + (z * r - x * y));
+}
+
+
+}
+
+/**
+ * \brief Returns \f$ e^{x} \f$. Error below 1.5 ulp.
+ *
+ * \par
+ *      Overflows to infinity above 709.78, underflows through the subnormals to 0 below -745.13;
+ *      exp(-inf) is 0 and NaN stays NaN.
+ */
+FINANCE_VMATH_INLINE double exp(const double x)
+{
+    return detail::exp_tail(x, 0.0);
+}
+
+/**
+ * \brief Returns \f$ \log x \f$. Error below 1.5 ulp.
+ *
+ * \par
+ *      log(0) is minus infinity, log(inf) infinity and negative arguments and NaN give NaN.
+ */
+FINANCE_VMATH_INLINE double log(const double x)
+{
+    using namespace detail;
+    double e;
+    const double m = log_reduce(x, e);
+    // log(m) = f - s (f - R) where s = f / (2 + f) and R the series of 2 atanh(s) past 2s.
+    const double f = m - 1.0;
+    const double s = f / (2.0 + f);
+    const double R = atanh_tail(s * s);
+    double y = e * LN2_HI + ((f - s * (f - R)) + e * LN2_LO);
+
+    y = x > 0.0 ? y : (x == 0.0 ? -INF : NOT_A_NUMBER);
+    y = x == INF ? INF : y;
+    return x != x ? x : y;
+}
+
+/**
+ * \brief Returns \f$ x^{y} \f$. Error below 1.5 ulp.
+ *
+ * \par
+ *      Computed as \f$ e^{y \log x} \f$ with log x carried in double-double, so the error does
+ *      not grow with \f$ |y \log x| \f$. Special cases follow C99: pow(x, 0) and pow(1, y) are
+ *      1 even for NaN, a negative x gives NaN unless y is an integer, and zeros and infinities
+ *      give the signed zeros and infinities of Annex F.
+ */
+template <bool Fma = false>
+FINANCE_VMATH_INLINE double pow(const double x, const double y)
+{
+    using namespace detail;
+    const double ax = std::fabs(x);
+    const double ay = std::fabs(y);
+    const double LIMIT = 18446744073709551616.0;   // 2^64: any larger |y| over/underflows too.
+
+    const double xs = ax > 0.0 ? (ax < INF ? ax : 1.0) : 1.0;
+    double yc = y > LIMIT ? LIMIT : y;
+    yc = yc < -LIMIT ? -LIMIT : yc;
+    yc = yc == yc ? yc : 0.0;
+    double l_hi, l_lo;
+    log_extended<Fma>(xs, l_hi, l_lo);
+    double p, p_lo;
+    two_product<Fma>(yc, l_hi, p, p_lo);
+    double r = exp_tail(p, p_lo + yc * l_lo);
+
+    // Integer and odd y, without rounding instructions SSE2 lacks: every |y| >= 2^52 is an
+    // integer and every |y| >= 2^53 even. The special cases are nested selects rather than
+    // conditions joined by and/or, which GCC does not vectorize.
+    const double ay_int = ay < TWO52 ? ay : 0.0;
+    const bool y_integer = (ay_int + TWO52) - TWO52 == ay_int;
+    const double half = 0.5 * (ay < 2.0 * TWO52 ? ay : 0.0);
+
+    r = ax == 0.0 ? (y < 0.0 ? INF : 0.0) : r;
+    r = ax == INF ? (y < 0.0 ? 0.0 : INF) : r;
+    const double odd = (half + TWO52) - TWO52 != half ? std::copysign(r, x) : r;
+    r = y_integer ? odd : (x < 0.0 ? (ax < INF ? NOT_A_NUMBER : r) : r);
+    const double unit = ax < 1.0 ? (y > 0.0 ? 0.0 : INF) : (y > 0.0 ? INF : 0.0);
+    r = ay == INF ? (ax == 1.0 ? 1.0 : unit) : r;
+    r = x != x ? x : r;
+    r = y != y ? y : r;
+    r = x == 1.0 ? 1.0 : r;
+    return y == 0.0 ? 1.0 : r;
+}
+
+/**
+ * \brief Returns the error function \f$ \frac{2}{\sqrt{\pi}} \int_{0}^{x} e^{-t^{2}} dt \f$.
+ *        Error below 2.5 ulp.
+ *
+ * \par
+ *      A Chebyshev series of erf(x)/x below 1, 1 - erfc(x) above; NaN stays NaN.
+ */
+template <bool Fma = false>
+FINANCE_VMATH_INLINE double erf(const double x)
+{
+    using namespace detail;
+    const double ax = std::fabs(x);
+    const double a = ax < 6.0 ? ax : 6.0;   // erf(x) rounds to 1 from 5.93.
+    double sq, sq_lo;
+    two_product<Fma>(a, a, sq, sq_lo);
+    double large = 1.0 - erfc_large(a, sq, sq_lo);
+    large = x < 0.0 ? -large : large;
+    const double y = ax < 1.0 ? erf_small(x) : large;
+    return x != x ? x : y;
+}
+
+/**
+ * \brief Returns the complementary error function \f$ 1 - erf(x) \f$. Error below 7 ulp.
+ *
+ * \par
+ *      Chebyshev series of \f$ e^{x^{2}} erfc(x) \f$ from 0.5 to 28, times \f$ e^{-x^{2}} \f$
+ *      with \f$ x^{2} \f$ carried exactly: the relative error stays small down to the
+ *      subnormals erfc reaches near 27. Below -6 it rounds to 2; NaN stays NaN.
+ */
+template <bool Fma = false>
+FINANCE_VMATH_INLINE double erfc(const double x)
+{
+    using namespace detail;
+    const double ax = std::fabs(x);
+    const double a = ax < 28.0 ? ax : 28.0;
+    double sq, sq_lo;
+    two_product<Fma>(a, a, sq, sq_lo);
+    const double tail = erfc_large(a, sq, sq_lo);
+    double y = x < 0.0 ? 2.0 - tail : tail;
+    y = ax < 0.5 ? 1.0 - erf_small(x) : y;
+    return x != x ? x : y;
+}
+
+/**
+ * \brief Returns the standard normal distribution \f$ N(x) = \frac{1}{2} erfc(-x/\sqrt{2}) \f$.
+ *        Error below 8 ulp.
+ *
+ * \par
+ *      \f$ x^{2}/2 \f$ is carried exactly rather than squaring the rounded \f$ x/\sqrt{2} \f$,
+ *      so the lower tail keeps its relative accuracy down to -38, where N underflows.
+ */
+template <bool Fma = false>
+FINANCE_VMATH_INLINE double normal_cdf(const double x)
+{
+    using namespace detail;
+    const double SQRT1_2 = 0.70710678118654752440;
+    const double LIMIT = 39.0;   // 28 sqrt(2) would be 39.6.
+    double xc = x > LIMIT ? LIMIT : x;
+    xc = xc < -LIMIT ? -LIMIT : xc;
+    const double a = std::fabs(xc) * SQRT1_2;
+    double sq, sq_lo;
+    two_product<Fma>(xc, xc, sq, sq_lo);
+    const double tail = 0.5 * erfc_large(a, 0.5 * sq, 0.5 * sq_lo);
+    double y = x < 0.0 ? tail : 1.0 - tail;
+    y = a < 0.5 ? 0.5 + 0.5 * erf_small(x * SQRT1_2) : y;
+    return x != x ? x : y;
+}
+
+/**
+ * \brief Returns the standard normal quantile \f$ \Phi^{-1}(p) \f$: the z such that
+ *        \f$ P(Z \leq z) = p \f$. Error below 8 ulp.
+ *
+ * \par
+ *      Wichura's algorithm AS 241: one rational approximation for \f$ |p - 0.5| \leq 0.425 \f$
+ *      and two in \f$ \sqrt{-\log(\min(p, 1 - p))} \f$ for the tails. 0 and 1 map to minus and
+ *      plus infinity, p outside [0, 1] and NaN to NaN.
+ */
+FINANCE_VMATH_INLINE double normal_quantile(const double p)
+{
+    using namespace detail;
+    // The three rational functions are evaluated and their numerators and denominators
+    // selected, to divide once.
+    const double q = p - 0.5;
+    double r = 0.180625 - q * q;
+    const double central_num = q *
+        (((((((2.5090809287301226727e+3 * r + 3.3430575583588128105e+4) * r + 6.7265770927008700853e+4) * r
+             + 4.5921953931549871457e+4) * r + 1.3731693765509461125e+4) * r + 1.9715909503065514427e+3) * r
+          + 1.3314166789178437745e+2) * r + 3.3871328727963666080e+0);
+    const double central_den =
+        (((((((5.2264952788528545610e+3 * r + 2.8729085735721942674e+4) * r + 3.9307895800092710610e+4) * r
+             + 2.1213794301586595867e+4) * r + 5.3941960214247511077e+3) * r + 6.8718700749205790830e+2) * r
+          + 4.2313330701600911252e+1) * r + 1.0);
+
+    const double tail_p = q < 0.0 ? p : 1.0 - p;
+    r = std::sqrt(-log(tail_p > 0.0 ? tail_p : 1.0));
+    const double r1 = r - 1.6;
+    const double near_num =
+        (((((((7.74545014278341407640e-4 * r1 + 2.27238449892691845833e-2) * r1 + 2.41780725177450611770e-1) * r1
+             + 1.27045825245236838258e+0) * r1 + 3.64784832476320460504e+0) * r1 + 5.76949722146069140550e+0) * r1
+          + 4.63033784615654529590e+0) * r1 + 1.42343711074968357734e+0);
+    const double near_den =
+        (((((((1.05075007164441684324e-9 * r1 + 5.47593808499534494600e-4) * r1 + 1.51986665636164571966e-2) * r1
+             + 1.48103976427480074590e-1) * r1 + 6.89767334985100004550e-1) * r1 + 1.67638483018380384940e+0) * r1
+          + 2.05319162663775882187e+0) * r1 + 1.0);
+    const double r2 = r - 5.0;
+    const double far_num =
+        (((((((2.01033439929228813265e-7 * r2 + 2.71155556874348757815e-5) * r2 + 1.24266094738807843860e-3) * r2
+             + 2.65321895265761230930e-2) * r2 + 2.96560571828504891230e-1) * r2 + 1.78482653991729133580e+0) * r2
+          + 5.46378491116411436990e+0) * r2 + 6.65790464350110377720e+0);
+    const double far_den =
+        (((((((2.04426310338993978564e-15 * r2 + 1.42151175831644588870e-7) * r2 + 1.84631831751005468180e-5) * r2
+             + 7.86869131145613259100e-4) * r2 + 1.48753612908506148525e-2) * r2 + 1.36929880922735805310e-1) * r2
+          + 5.99832206555887937690e-1) * r2 + 1.0);
+    double tail_num = r <= 5.0 ? near_num : far_num;
+    tail_num = q < 0.0 ? -tail_num : tail_num;
+    const double tail_den = r <= 5.0 ? near_den : far_den;
+
+    const bool central = std::fabs(q) <= 0.425;
+    double z = (central ? central_num : tail_num) / (central ? central_den : tail_den);
+    z = p == 0.0 ? -INF : z;
+    z = p == 1.0 ? INF : z;
+    z = (p < 0.0 or p > 1.0) ? NOT_A_NUMBER : z;
+    return p != p ? p : z;
+}
+
+/**
+ * \brief Stores \f$ \sin x \f$ in \p s and \f$ \cos x \f$ in \p c. Error below 1 ulp for
+ *        \f$ |x| < 2^{20}\pi/2 \f$, about 1.6e6.
+ *
+ * \par
+ *      x is reduced to \f$ [-\pi/4, \pi/4] \f$ by multiples of \f$ \pi/2 \f$ carried to about 150
+ *      bits, so results near the zeros keep their relative accuracy; beyond the bound the
+ *      multiples are no longer exact and the accuracy degrades. Infinities and NaN give NaN.
+ */
+FINANCE_VMATH_INLINE void sincos(const double x, double& s, double& c)
+{
+    using namespace detail;
+    const double xr = std::fabs(x) < INF ? x : 0.0;
+    double y, y_lo;
+    const double k = reduce_half_pi(xr, y, y_lo);
+    const double ks = sin_kernel(y, y_lo);
+    const double kc = cos_kernel(y, y_lo);
+
+    // The quadrant k mod 4 from the low bits of k + ROUND, as exp_tail() takes its exponent.
+    const std::uint64_t q = to_bits(k + ROUND) & 3;
+    double sn = (q & 1) ? kc : ks;
+    double cs = (q & 1) ? ks : kc;
+    sn = (q & 2) ? -sn : sn;
+    cs = ((q + 1) & 2) ? -cs : cs;
+
+    sn = x == 0.0 ? x : sn;
+    s = std::fabs(x) < INF ? sn : NOT_A_NUMBER;
+    c = std::fabs(x) < INF ? cs : NOT_A_NUMBER;
+}
+
+/**
+ * \brief The float functions: evaluated in double and rounded once.
+ */
+FINANCE_VMATH_INLINE float exp(const float x)
+{
+    return static_cast<float>(exp(static_cast<double>(x)));
+}
+
+FINANCE_VMATH_INLINE float log(const float x)
+{
+    return static_cast<float>(log(static_cast<double>(x)));
+}
+
+template <bool Fma = false>
+FINANCE_VMATH_INLINE float pow(const float x, const float y)
+{
+    return static_cast<float>(pow<Fma>(static_cast<double>(x), static_cast<double>(y)));
+}
+
+template <bool Fma = false>
+FINANCE_VMATH_INLINE float erf(const float x)
+{
+    return static_cast<float>(erf<Fma>(static_cast<double>(x)));
+}
+
+template <bool Fma = false>
+FINANCE_VMATH_INLINE float erfc(const float x)
+{
+    return static_cast<float>(erfc<Fma>(static_cast<double>(x)));
+}
+
+template <bool Fma = false>
+FINANCE_VMATH_INLINE float normal_cdf(const float x)
+{
+    return static_cast<float>(normal_cdf<Fma>(static_cast<double>(x)));
+}
+
+FINANCE_VMATH_INLINE float normal_quantile(const float p)
+{
+    return static_cast<float>(normal_quantile(static_cast<double>(p)));
+}
+
+FINANCE_VMATH_INLINE void sincos(const float x, float& s, float& c)
+{
+    double sd, cd;
+    sincos(static_cast<double>(x), sd, cd);
+    s = static_cast<float>(sd);
+    c = static_cast<float>(cd);
+}
+
+}
+
+}
@@ -0,0 +1,522 @@
+/**
+ * \file
+ * The finance::SviSlice class parametrizes the implied volatility smile of one expiry and
+ * finance::VolatilitySurface interpolates a set of slices in time.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include <parallel.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief The SviSlice class is the raw SVI parametrization of the total implied variance of one
+ *        expiry.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Stochastic volatility inspired (SVI) smile.
+ *      With log moneyness \f$ k = \ln(K/F) \f$ the total implied variance
+ *      \f$ w = \sigma_{BS}^{2}t \f$ is
+ *
+ *      \f$ w(k) = a + b\left(\rho(k - m) + \sqrt{(k - m)^{2} + s^{2}}\right) \f$
+ * \par Calibration.
+ *      For fixed \f$ (m, s) \f$ and \f$ y = (k - m)/s \f$ the slice is linear in
+ *      \f$ (a, d, c) = (a, \rho bs, bs) \f$, \f$ w = a + dy + c\sqrt{y^{2} + 1} \f$, so the inner fit is a
+ *      3x3 least squares problem. The outer fit over \f$ (m, s) \f$ is a small Nelder-Mead search
+ *      (the quasi-explicit method of Zeliade, 2009).
+ */
+template <class T>
+class SviSlice
+{
+public:
+    SviSlice()
+        : expiry{0}, a{0}, b{0}, rho{0}, m{0}, s{1}
+    {}
+
+    SviSlice(const T expiry,
+             const T a,
+             const T b,
+             const T rho,
+             const T m,
+             const T s)
+        : expiry{expiry}, a{a}, b{b}, rho{rho}, m{m}, s{s}
+    {}
+
+    T get_expiry() const { return expiry; }
+    T get_a() const { return a; }
+    T get_b() const { return b; }
+    T get_rho() const { return rho; }
+    T get_m() const { return m; }
+    T get_s() const { return s; }
+
+    /**
+     * \brief Returns the total implied variance \f$ w(k) \f$.
+     */
+    T total_variance(const T k) const
+    {
+        const T x = k - m;
+        return a + b * (rho * x + sqrt(x * x + s * s));
+    }
+
+    /**
+     * \brief Returns the implied volatility at log moneyness \p k.
+     */
+    T volatility(const T k) const
+    {
+        return sqrt(std::max(T(0), total_variance(k)) / expiry);
+    }
+
+    /**
+     * \brief Checks the slice is free of butterfly arbitrage at log moneyness \p k.
+     *
+     * \par
+     *      The risk neutral density is non negative where \f$ w > 0 \f$ and (Gatheral, 2004)
+     *
+     *      \f$ g(k) = \left(1 - \frac{kw'}{2w}\right)^{2} - \frac{w'^{2}}{4}\left(\frac{1}{w} + \frac{1}{4}\right) + \frac{w''}{2} \ge 0 \f$
+     */
+    bool butterfly_free(const T k) const
+    {
+        const T x = k - m;
+        const T root = sqrt(x * x + s * s);
+        const T w   = total_variance(k);
+        const T w1  = b * (rho + x / root);
+        const T w2  = b * s * s / (root * root * root);
+        if (w <= T(0)) return false;
+        const T g = (1 - k * w1 / (2 * w)) * (1 - k * w1 / (2 * w))
+                  - w1 * w1 / 4 * (1 / w + T(0.25))
+                  + w2 / 2;
+        return g >= T(0);
+    }
+
+    /**
+     * \brief Fits the slice to total implied variances.
+     *
+     * \param expiry            Expiry of the slice.
+     * \param log_moneyness     Quoted log moneyness \f$ k_{i} \f$.
+     * \param total_variances   Quoted total variances \f$ w_{i} \f$.
+     * \return                  The calibrated slice.
+     * \exception std::invalid_argument if sizes differ or there are fewer than 5 quotes.
+     */
+    static SviSlice calibrate(const T expiry,
+                              const std::vector<T>& log_moneyness,
+                              const std::vector<T>& total_variances)
+    {
+        if (log_moneyness.size() != total_variances.size())
+            throw std::invalid_argument("sizes differ");
+        if (log_moneyness.size() < 5)
+            throw std::invalid_argument("at least 5 quotes are needed");
+
+        auto fit = [&](const T m, const T s, SviSlice* slice) {
+            return fit_linear(expiry, log_moneyness, total_variances, m, s, slice);
+        };
+
+        const int lowest = static_cast<int>(std::min_element(total_variances.begin(), total_variances.end()) - total_variances.begin());
+        T x[3][2] = {{log_moneyness[lowest], log(T(0.1))},
+                     {log_moneyness[lowest] + T(0.1), log(T(0.1))},
+                     {log_moneyness[lowest], log(T(0.2))}};
+        T f[3];
+        for (int i = 0; i < 3; i++)
+            f[i] = fit(x[i][0], exp(x[i][1]), nullptr);
+
+        // Nelder-Mead on (m, ln s).
+        const int MAX_ITERATIONS = 200;
+        for (int it = 0; it < MAX_ITERATIONS; it++) {
+            int order[3] = {0, 1, 2};
+            std::sort(order, order + 3, [&](const int l, const int r) { return f[l] < f[r]; });
+            const int best = order[0], mid = order[1], worst = order[2];
+            if (std::fabs(f[worst] - f[best]) <= T(1e-14) * (T(1) + std::fabs(f[best])))
+                break;
+
+            T c[2], xr[2];
+            for (int d = 0; d < 2; d++) {
+                c[d]  = T(0.5) * (x[best][d] + x[mid][d]);
+                xr[d] = c[d] + (c[d] - x[worst][d]);
+            }
+            const T fr = fit(xr[0], exp(xr[1]), nullptr);
+            if (fr < f[best]) {
+                T xe[2];
+                for (int d = 0; d < 2; d++) xe[d] = c[d] + 2 * (c[d] - x[worst][d]);
+                const T fe = fit(xe[0], exp(xe[1]), nullptr);
+                const T* keep = (fe < fr) ? xe : xr;
+                x[worst][0] = keep[0];
+                x[worst][1] = keep[1];
+                f[worst] = std::min(fe, fr);
+            } else if (fr < f[mid]) {
+                x[worst][0] = xr[0];
+                x[worst][1] = xr[1];
+                f[worst] = fr;
+            } else {
+                T xc[2];
+                for (int d = 0; d < 2; d++) xc[d] = c[d] + T(0.5) * (x[worst][d] - c[d]);
+                const T fc = fit(xc[0], exp(xc[1]), nullptr);
+                if (fc < f[worst]) {
+                    x[worst][0] = xc[0];
+                    x[worst][1] = xc[1];
+                    f[worst] = fc;
+                } else {
+                    for (const int i : {mid, worst}) {
+                        for (int d = 0; d < 2; d++) x[i][d] = x[best][d] + T(0.5) * (x[i][d] - x[best][d]);
+                        f[i] = fit(x[i][0], exp(x[i][1]), nullptr);
+                    }
+                }
+            }
+        }
+
+        const int best = static_cast<int>(std::min_element(f, f + 3) - f);
+        SviSlice slice;
+        fit(x[best][0], exp(x[best][1]), &slice);
+        return slice;
+    }
+
+private:
+    static T fit_linear(const T expiry,
+                        const std::vector<T>& k,
+                        const std::vector<T>& w,
+                        const T m,
+                        const T s,
+                        SviSlice* slice)
+    {
+        // Normal equations of w = a + d y + c z with z = sqrt(y^2 + 1).
+        T n = 0, sy = 0, sz = 0, syy = 0, syz = 0, szz = 0, sw = 0, syw = 0, szw = 0;
+        for (std::size_t i = 0; i < k.size(); i++) {
+            const T y = (k[i] - m) / s;
+            const T z = sqrt(y * y + 1);
+            n   += 1;   sy  += y;     sz  += z;
+            syy += y*y; syz += y*z;   szz += z*z;
+            sw  += w[i]; syw += y*w[i]; szw += z*w[i];
+        }
+        const T A[3][3] = {{n, sy, sz}, {sy, syy, syz}, {sz, syz, szz}};
+        const T rhs[3] = {sw, syw, szw};
+        const T det = A[0][0] * (A[1][1] * A[2][2] - A[1][2] * A[2][1])
+                    - A[0][1] * (A[1][0] * A[2][2] - A[1][2] * A[2][0])
+                    + A[0][2] * (A[1][0] * A[2][1] - A[1][1] * A[2][0]);
+        T sol[3] = {0, 0, 0};
+        if (std::fabs(det) > std::numeric_limits<T>::min()) {
+            for (int col = 0; col < 3; col++) {
+                T B[3][3];
+                for (int r = 0; r < 3; r++)
+                    for (int cc = 0; cc < 3; cc++)
+                        B[r][cc] = (cc == col) ? rhs[r] : A[r][cc];
+                sol[col] = (B[0][0] * (B[1][1] * B[2][2] - B[1][2] * B[2][1])
+                          - B[0][1] * (B[1][0] * B[2][2] - B[1][2] * B[2][0])
+                          + B[0][2] * (B[1][0] * B[2][1] - B[1][1] * B[2][0])) / det;
+            }
+        }
+
+        // Keep b >= 0 and |rho| <= 1.
+        T a = sol[0];
+        T c = std::max(T(0), sol[2]);
+        T d = std::max(-c, std::min(c, sol[1]));
+
+        T error = 0.0;
+        for (std::size_t i = 0; i < k.size(); i++) {
+            const T y = (k[i] - m) / s;
+            const T e = a + d * y + c * sqrt(y * y + 1) - w[i];
+            error += e * e;
+        }
+        if (slice != nullptr) {
+            const T b = c / s;
+            const T rho = (c > T(0)) ? d / c : T(0);
+            *slice = SviSlice(expiry, a, b, rho, m, s);
+        }
+        return error;
+    }
+
+    T expiry;
+    T a;
+    T b;
+    T rho;
+    T m;
+    T s;
+};
+
+namespace detail {
+
+/**
+ * Next identity of a volatility surface: a new one is drawn whenever slices change, so a cache
+ * keyed on it never outlives the slices it was filled from.
+ */
+inline unsigned long long next_surface_id()
+{
+    static std::atomic<unsigned long long> next(0);
+    return ++next;
+}
+
+}
+
+/**
+ * \brief Result of the static arbitrage checks of a finance::VolatilitySurface.
+ */
+struct ArbitrageReport
+{
+    /** Slices with a negative risk neutral density somewhere on the check grid. */
+    std::vector<int> butterfly_violations;
+    /** Slices \f$ i \f$ whose total variance exceeds the one of slice \f$ i+1 \f$. */
+    std::vector<int> calendar_violations;
+
+    bool arbitrage_free() const
+    {
+        return butterfly_violations.empty() and calendar_violations.empty();
+    }
+};
+
+/**
+ * \brief The VolatilitySurface class gives the implied volatility for any strike and expiry from
+ *        a set of SVI slices.
+ * \ingroup Finance
+ *
+ * \tparam T        The type of calculations (must be an floating point).
+ *
+ * \par Interpolation in time.
+ *      Strikes are mapped to log moneyness \f$ k = \ln(K/F(t)) \f$ with
+ *      \f$ F(t) = S_{0}e^{(r-q)t} \f$. Between two slices the total variance at the same \f$ k \f$ is
+ *      interpolated linearly in time, which keeps the surface free of calendar arbitrage when
+ *      the slices are. Before the first slice the total variance is scaled linearly from zero
+ *      and after the last one the volatility is extrapolated flat.
+ * \par Lookups.
+ *      A lookup finds the slices around the expiry by binary search and evaluates both at one
+ *      log moneyness. Each thread keeps its last lookup: the expiry with its bracket and log
+ *      forward, and the strike with its volatility. A repeated (strike, expiry) costs two
+ *      compares and a new strike at the same expiry skips the search. The cache is per thread
+ *      and keyed on an identity that changes with the slices, so reads take no lock and
+ *      several threads may read one surface. Whole chains should use volatilities(), which
+ *      brackets the expiry once for every strike.
+ */
+template <class T>
+class VolatilitySurface
+{
+public:
+    /**
+     * \param spot      Spot price \f$ S_{0} \f$.
+     * \param r         Constant interest rate, continuously compounded.
+     * \param q         Constant dividend yield, continuously compounded.
+     */
+    VolatilitySurface(const T spot,
+                      const T r,
+                      const T q)
+        : spot{spot},
+          r{r},
+          q{q},
+          id{detail::next_surface_id()}
+    {}
+
+    T get_spot() const { return spot; }
+    T get_rate() const { return r; }
+    T get_dividend_yield() const { return q; }
+
+    int size() const
+    {
+        return static_cast<int>(slices.size());
+    }
+
+    const SviSlice<T>& slice_at(const int i) const
+    {
+        return slices.at(i);
+    }
+
+    /**
+     * \brief Returns the forward \f$ F(t) = S_{0}e^{(r-q)t} \f$.
+     */
+    T forward(const T t) const
+    {
+        return spot * exp((r - q) * t);
+    }
+
+    /**
+     * \brief Inserts a slice keeping the slices sorted by expiry.
+     */
+    void add_slice(const SviSlice<T>& slice)
+    {
+        auto it = std::lower_bound(slices.begin(), slices.end(), slice,
+                                   [](const SviSlice<T>& l, const SviSlice<T>& r) { return l.get_expiry() < r.get_expiry(); });
+        slices.insert(it, slice);
+        id = detail::next_surface_id();
+    }
+
+    /**
+     * \brief Calibrates one slice per expiry, in parallel across expiries.
+     *
+     * \param expiries      Expiries of the quotes.
+     * \param strikes       Quoted strikes of each expiry.
+     * \param volatilities  Quoted implied volatilities of each expiry.
+     * \exception std::invalid_argument if parameter sizes differ.
+     */
+    void calibrate(const std::vector<T>& expiries,
+                   const std::vector<std::vector<T>>& strikes,
+                   const std::vector<std::vector<T>>& volatilities)
+    {
+        if (expiries.size() != strikes.size() or expiries.size() != volatilities.size())
+            throw std::invalid_argument("sizes differ");
+
+        std::vector<SviSlice<T>> fitted(expiries.size());
+        parallel_for(0, static_cast<int>(expiries.size()), [&](const int i) {
+            if (strikes[i].size() != volatilities[i].size())
+                throw std::invalid_argument("sizes differ");
+            const T t = expiries[i];
+            const T f = forward(t);
+            std::vector<T> k(strikes[i].size());
+            std::vector<T> w(strikes[i].size());
+            for (std::size_t j = 0; j < k.size(); j++) {
+                k[j] = log(strikes[i][j] / f);
+                w[j] = volatilities[i][j] * volatilities[i][j] * t;
+            }
+            fitted[i] = SviSlice<T>::calibrate(t, k, w);
+        });
+
+        slices.clear();
+        for (const SviSlice<T>& slice : fitted)
+            add_slice(slice);
+        id = detail::next_surface_id();
+    }
+
+    /**
+     * \brief Checks butterfly and calendar arbitrage on a log moneyness grid.
+     *
+     * \param k_min     Lowest log moneyness checked.
+     * \param k_max     Highest log moneyness checked.
+     * \param points    Number of grid points.
+     */
+    ArbitrageReport check_arbitrage(const T k_min = -1.5,
+                                    const T k_max = 1.5,
+                                    const int points = 61) const
+    {
+        ArbitrageReport report;
+        for (int i = 0; i < size(); i++) {
+            bool butterfly = true;
+            bool calendar = true;
+            for (int p = 0; p < points; p++) {
+                const T k = k_min + (k_max - k_min) * p / std::max(1, points - 1);
+                butterfly = butterfly and slices[i].butterfly_free(k);
+                if (i + 1 < size())
+                    calendar = calendar and slices[i].total_variance(k) <= slices[i+1].total_variance(k);
+            }
+            if (not butterfly) report.butterfly_violations.push_back(i);
+            if (not calendar) report.calendar_violations.push_back(i);
+        }
+        return report;
+    }
+
+    /**
+     * \brief Returns the total implied variance at log moneyness \p k and time \p t.
+     * \exception std::domain_error if the surface has no slices.
+     */
+    T total_variance(const T k, const T t) const
+    {
+        int lo, hi;
+        T w;
+        bracket(t, lo, hi, w);
+        return interpolate(k, t, lo, hi, w);
+    }
+
+    /**
+     * \brief Returns the implied volatility for \p strike and \p expiry.
+     */
+    T volatility(const T strike,
+                 const T expiry) const
+    {
+        static thread_local LastLookup last;
+        if (last.id != id or last.expiry != expiry) {
+            bracket(expiry, last.lo, last.hi, last.w);
+            last.log_forward = log(forward(expiry));
+            last.id = id;
+            last.expiry = expiry;
+            last.strike = std::numeric_limits<T>::quiet_NaN();
+        } else if (last.strike == strike) {
+            return last.vol;
+        }
+        last.vol = volatility_at(strike, expiry, last.log_forward, last.lo, last.hi, last.w);
+        last.strike = strike;
+        return last.vol;
+    }
+
+    /**
+     * \brief Returns the implied volatilities of a whole chain of one expiry.
+     *
+     * \param expiry    Expiry of the chain.
+     * \param strikes   Strikes of the chain.
+     * \param vols      Output volatilities, one per strike.
+     */
+    void volatilities(const T expiry,
+                      const std::vector<T>& strikes,
+                      std::vector<T>& vols) const
+    {
+        int lo, hi;
+        T w;
+        bracket(expiry, lo, hi, w);
+        const T log_forward = log(forward(expiry));
+        vols.resize(strikes.size());
+        for (std::size_t i = 0; i < strikes.size(); i++)
+            vols[i] = volatility_at(strikes[i], expiry, log_forward, lo, hi, w);
+    }
+
+private:
+    // Last lookup of a thread: the bracket of an expiry, then the volatility of a strike at it.
+    struct LastLookup
+    {
+        unsigned long long id = 0;
+        T expiry = 0;
+        int lo = 0;
+        int hi = 0;
+        T w = 0;
+        T log_forward = 0;
+        T strike = 0;
+        T vol = 0;
+    };
+
+    // The volatility at strike of the bracket lo, hi, w of expiry: one path for volatility() and
+    // volatilities(), so both give the same bits.
+    T volatility_at(const T strike, const T expiry, const T log_forward, const int lo, const int hi, const T w) const
+    {
+        const T k = log(strike) - log_forward;
+        return sqrt(std::max(T(0), interpolate(k, expiry, lo, hi, w)) / expiry);
+    }
+
+    // Finds the slices around t. lo == hi outside the slices; w is the weight of hi.
+    void bracket(const T t, int& lo, int& hi, T& w) const
+    {
+        if (slices.empty())
+            throw std::domain_error("empty surface");
+        if (t <= slices.front().get_expiry()) {
+            lo = hi = 0;
+            w = 1;
+            return;
+        }
+        if (t >= slices.back().get_expiry()) {
+            lo = hi = size() - 1;
+            w = 1;
+            return;
+        }
+        hi = static_cast<int>(std::lower_bound(slices.begin() + 1, slices.end(), t,
+                                               [](const SviSlice<T>& slice, const T x) { return slice.get_expiry() < x; })
+                              - slices.begin());
+        lo = hi - 1;
+        w = (t - slices[lo].get_expiry()) / (slices[hi].get_expiry() - slices[lo].get_expiry());
+    }
+
+    T interpolate(const T k, const T t, const int lo, const int hi, const T w) const
+    {
+        if (lo == hi)
+            return slices[lo].total_variance(k) * t / slices[lo].get_expiry();
+        return (1 - w) * slices[lo].total_variance(k) + w * slices[hi].total_variance(k);
+    }
+
+    T spot;
+    T r;
+    T q;
+    std::vector<SviSlice<T>> slices;
+    unsigned long long id;
+};
+
+}
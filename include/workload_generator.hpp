@@ -0,0 +1,105 @@
+/**
+ * \file
+ * The finance::WorkloadGenerator class writes reproducible synthetic portfolios and market
+ * histories in the on-disk formats read by the rest of the project.
+ */
+
+#pragma once
+
+#include <iostream>
+
+#include <date.hpp>
+#include <random.hpp>
+
+
+
+namespace finance {
+
+/**
+ * \brief The WorkloadGenerator class streams synthetic input data of any size.
+ * \ingroup Finance
+ *
+ * \par
+ *      Every method draws from one Xoshiro256StarStar generator on the stream of the seed, so the
+ *      same seed and the same sequence of calls always produce the same bytes. Nothing is kept in
+ *      memory: each record is formatted straight into a large output buffer with integer
+ *      arithmetic (no locale, no stream formatting), so output runs at about the speed of the
+ *      disk even for portfolios of hundreds of millions of cash flows.
+ * \par Formats.
+ *      - Cash flow books are written in the job format of read_valuation_jobs(), one stream per
+ *        line: <tt>name rate time amount time amount ...</tt>.
+ *      - Histories are written in the format of read_dated(): <tt>year-month-day,value</tt>.
+ *      - Option chains are written as CSV with the header <tt>expiry,strike,implied_volatility</tt>.
+ */
+class WorkloadGenerator
+{
+public:
+    explicit WorkloadGenerator(const unsigned long seed);
+
+    /**
+     * \brief Writes a book of coupon bonds bought near par.
+     *
+     * \param os                    Output stream.
+     * \param num_bonds             Number of bonds.
+     * \param num_flows             Number of cash flows per bond, the purchase included.
+     * \param sign_change_fraction  Fraction of the bonds given an extra negative flow midway, so
+     *                              their stream changes sign more than once and its IRR may be
+     *                              neither unique nor inside the initial bracket.
+     */
+    void write_bonds(std::ostream& os,
+                     const long num_bonds,
+                     const int num_flows,
+                     const double sign_change_fraction = 0.0);
+
+    /**
+     * \brief Writes a book of amortizing loans: the principal lent, then level payments.
+     *
+     * \par
+     *      Parameters are as in write_bonds().
+     */
+    void write_loans(std::ostream& os,
+                     const long num_loans,
+                     const int num_flows,
+                     const double sign_change_fraction = 0.0);
+
+    /**
+     * \brief Writes the implied volatility of option chains drawn from random SVI smiles.
+     *
+     * \param os            Output stream.
+     * \param num_expiries  Number of expiries, evenly spaced up to two years.
+     * \param num_strikes   Number of strikes per expiry, evenly spaced in log moneyness.
+     * \param spot          Spot price, also the forward.
+     */
+    void write_option_chains(std::ostream& os,
+                             const int num_expiries,
+                             const int num_strikes,
+                             const double spot);
+
+    /**
+     * \brief Writes a daily closing price history following geometric Brownian motion.
+     *
+     * \param os            Output stream.
+     * \param start         First date.
+     * \param num_days      Number of business days (weekends are skipped).
+     * \param spot          First price.
+     * \param drift         Annual drift.
+     * \param volatility    Annual volatility.
+     *
+     * \par
+     *      Only dates accepted by Date::valid() are written, so every date of the history can
+     *      be queried.
+     */
+    void write_history(std::ostream& os,
+                       const Date& start,
+                       const int num_days,
+                       const double spot,
+                       const double drift,
+                       const double volatility);
+
+private:
+    double uniform(const double a, const double b);
+
+    Xoshiro256StarStar generator;
+};
+
+}
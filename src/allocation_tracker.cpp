@@ -0,0 +1,114 @@
+#include "allocation_tracker.hpp"
+
+#include <cstdlib>
+#include <new>
+
+namespace finance {
+
+namespace {
+
+// Trivially constructible, so usable by allocations made while a thread starts or exits.
+thread_local AllocationCounts counts = { 0, 0, 0 };
+
+}
+
+bool allocation_tracking_enabled()
+{
+#if defined(FINANCE_ALLOCATION_TRACKING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+AllocationCounts thread_allocations()
+{
+    return counts;
+}
+
+#if defined(FINANCE_ALLOCATION_TRACKING)
+
+namespace {
+
+void* allocate(std::size_t size)
+{
+    counts.allocations++;
+    counts.bytes += static_cast<long>(size);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void deallocate(void* p)
+{
+    if (p == nullptr)
+        return;
+    counts.deallocations++;
+    std::free(p);
+}
+
+}
+
+#endif
+
+}
+
+#if defined(FINANCE_ALLOCATION_TRACKING)
+
+// Replacements of the global allocation functions that count every allocation.
+
+void* operator new(std::size_t size)
+{
+    void* p = finance::allocate(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](std::size_t size)
+{
+    void* p = finance::allocate(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return finance::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return finance::allocate(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    finance::deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    finance::deallocate(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    finance::deallocate(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    finance::deallocate(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    finance::deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    finance::deallocate(p);
+}
+
+#endif
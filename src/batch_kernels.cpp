@@ -0,0 +1,299 @@
+#include "batch_kernels.hpp"
+#include "vector_math.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+// The kernel bodies are written once, as loops over the vmath functions the compiler vectorizes
+// (#pragma omp simd, enabled by -fopenmp-simd in the qmake projects), and inlined into one
+// function per level, each compiled for its instruction set by a target attribute.
+
+namespace finance {
+
+namespace {
+
+FINANCE_VMATH_INLINE double pv_continuous_body(const double* times, const double* amounts, const int n, const double r)
+{
+    double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+    for (int i = 0; i < n; i++)
+        sum += amounts[i] * vmath::exp(-r * times[i]);
+    return sum;
+}
+
+FINANCE_VMATH_INLINE double pv_discrete_body(const double* times, const double* amounts, const int n, const double r)
+{
+    const double a = std::log1p(r);
+    double sum = 0.0;
+#pragma omp simd reduction(+:sum)
+    for (int i = 0; i < n; i++)
+        sum += amounts[i] * vmath::exp(-a * times[i]);
+    return sum;
+}
+
+template <class T>
+FINANCE_VMATH_INLINE void exp_loop(const T* x, T* y, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vmath::exp(x[i]);
+}
+
+template <class T>
+FINANCE_VMATH_INLINE void log_loop(const T* x, T* y, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vmath::log(x[i]);
+}
+
+template <bool Fma, class T>
+FINANCE_VMATH_INLINE void pow_loop(const T* x, const T* y, T* z, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        z[i] = vmath::pow<Fma>(x[i], y[i]);
+}
+
+template <bool Fma, class T>
+FINANCE_VMATH_INLINE void erf_loop(const T* x, T* y, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vmath::erf<Fma>(x[i]);
+}
+
+template <bool Fma, class T>
+FINANCE_VMATH_INLINE void erfc_loop(const T* x, T* y, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vmath::erfc<Fma>(x[i]);
+}
+
+template <bool Fma, class T>
+FINANCE_VMATH_INLINE void normal_cdf_loop(const T* x, T* y, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        y[i] = vmath::normal_cdf<Fma>(x[i]);
+}
+
+template <class T>
+FINANCE_VMATH_INLINE void normals_loop(const T* u, T* z, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        z[i] = vmath::normal_quantile(u[i]);
+}
+
+template <class T>
+FINANCE_VMATH_INLINE void sincos_loop(const T* x, T* s, T* c, const int n)
+{
+#pragma omp simd
+    for (int i = 0; i < n; i++)
+        vmath::sincos(x[i], s[i], c[i]);
+}
+
+/**
+ * Adds one value of every window per pass, so each pass is a contiguous loop over the windows.
+ */
+FINANCE_VMATH_INLINE void rolling_loop(const double* x, const int n, const int window, double* mean, double* variance)
+{
+    const int m = n - window + 1;
+    for (int i = 0; i < m; i++)
+        mean[i] = 0.0;
+    for (int k = 0; k < window; k++) {
+        const double* xk = x + k;
+#pragma omp simd
+        for (int i = 0; i < m; i++)
+            mean[i] += xk[i];
+    }
+    const double inverse = 1.0 / window;
+    for (int i = 0; i < m; i++) {
+        mean[i] *= inverse;
+        variance[i] = 0.0;
+    }
+    for (int k = 0; k < window; k++) {
+        const double* xk = x + k;
+#pragma omp simd
+        for (int i = 0; i < m; i++) {
+            const double d = xk[i] - mean[i];
+            variance[i] += d * d;
+        }
+    }
+    const double scale = 1.0 / (window - 1);
+    for (int i = 0; i < m; i++)
+        variance[i] *= scale;
+}
+
+struct Kernels
+{
+    double (*pv_continuous)(const double*, const double*, int, double);
+    double (*pv_discrete)(const double*, const double*, int, double);
+    void (*exp)(const double*, double*, int);
+    void (*expf)(const float*, float*, int);
+    void (*log)(const double*, double*, int);
+    void (*logf)(const float*, float*, int);
+    void (*pow)(const double*, const double*, double*, int);
+    void (*powf)(const float*, const float*, float*, int);
+    void (*erf)(const double*, double*, int);
+    void (*erff)(const float*, float*, int);
+    void (*erfc)(const double*, double*, int);
+    void (*erfcf)(const float*, float*, int);
+    void (*normal_cdf)(const double*, double*, int);
+    void (*normal_cdff)(const float*, float*, int);
+    void (*normals)(const double*, double*, int);
+    void (*normalsf)(const float*, float*, int);
+    void (*sincos)(const double*, double*, double*, int);
+    void (*sincosf)(const float*, float*, float*, int);
+    void (*rolling)(const double*, int, int, double*, double*);
+};
+
+#define FINANCE_KERNELS(name, target, fma) \
+    target double pv_continuous_##name(const double* t, const double* a, int n, double r) { return pv_continuous_body(t, a, n, r); } \
+    target double pv_discrete_##name(const double* t, const double* a, int n, double r) { return pv_discrete_body(t, a, n, r); } \
+    target void exp_##name(const double* x, double* y, int n) { exp_loop(x, y, n); } \
+    target void expf_##name(const float* x, float* y, int n) { exp_loop(x, y, n); } \
+    target void log_##name(const double* x, double* y, int n) { log_loop(x, y, n); } \
+    target void logf_##name(const float* x, float* y, int n) { log_loop(x, y, n); } \
+    target void pow_##name(const double* x, const double* y, double* z, int n) { pow_loop<fma>(x, y, z, n); } \
+    target void powf_##name(const float* x, const float* y, float* z, int n) { pow_loop<fma>(x, y, z, n); } \
+    target void erf_##name(const double* x, double* y, int n) { erf_loop<fma>(x, y, n); } \
+    target void erff_##name(const float* x, float* y, int n) { erf_loop<fma>(x, y, n); } \
+    target void erfc_##name(const double* x, double* y, int n) { erfc_loop<fma>(x, y, n); } \
+    target void erfcf_##name(const float* x, float* y, int n) { erfc_loop<fma>(x, y, n); } \
+    target void normal_cdf_##name(const double* x, double* y, int n) { normal_cdf_loop<fma>(x, y, n); } \
+    target void normal_cdff_##name(const float* x, float* y, int n) { normal_cdf_loop<fma>(x, y, n); } \
+    target void normals_##name(const double* u, double* z, int n) { normals_loop(u, z, n); } \
+    target void normalsf_##name(const float* u, float* z, int n) { normals_loop(u, z, n); } \
+    target void sincos_##name(const double* x, double* s, double* c, int n) { sincos_loop(x, s, c, n); } \
+    target void sincosf_##name(const float* x, float* s, float* c, int n) { sincos_loop(x, s, c, n); } \
+    target void rolling_##name(const double* x, int n, int w, double* m, double* v) { rolling_loop(x, n, w, m, v); } \
+    const Kernels kernels_##name = { pv_continuous_##name, pv_discrete_##name, exp_##name, expf_##name, \
+                                     log_##name, logf_##name, pow_##name, powf_##name, erf_##name, \
+                                     erff_##name, erfc_##name, erfcf_##name, normal_cdf_##name, \
+                                     normal_cdff_##name, normals_##name, normalsf_##name, sincos_##name, \
+                                     sincosf_##name, rolling_##name };
+
+FINANCE_KERNELS(generic, , false)
+#if defined(FINANCE_ISA_DISPATCH)
+FINANCE_KERNELS(avx2, __attribute__((target("avx2,fma"))), true)
+FINANCE_KERNELS(avx512, __attribute__((target("avx512f,avx2,fma"))), true)
+#endif
+
+const Kernels& kernels()
+{
+#if defined(FINANCE_ISA_DISPATCH)
+    switch (active_isa()) {
+    case Isa::Avx512:
+        return kernels_avx512;
+    case Isa::Avx2:
+        return kernels_avx2;
+    default:
+        break;
+    }
+#endif
+    return kernels_generic;
+}
+
+}
+
+double pv_continuous_batch(const double* times, const double* amounts, const int n, const double r)
+{
+    return kernels().pv_continuous(times, amounts, n, r);
+}
+
+double pv_discrete_batch(const double* times, const double* amounts, const int n, const double r)
+{
+    return kernels().pv_discrete(times, amounts, n, r);
+}
+
+void exp_batch(const double* x, double* y, const int n)
+{
+    kernels().exp(x, y, n);
+}
+
+void exp_batch(const float* x, float* y, const int n)
+{
+    kernels().expf(x, y, n);
+}
+
+void log_batch(const double* x, double* y, const int n)
+{
+    kernels().log(x, y, n);
+}
+
+void log_batch(const float* x, float* y, const int n)
+{
+    kernels().logf(x, y, n);
+}
+
+void pow_batch(const double* x, const double* y, double* z, const int n)
+{
+    kernels().pow(x, y, z, n);
+}
+
+void pow_batch(const float* x, const float* y, float* z, const int n)
+{
+    kernels().powf(x, y, z, n);
+}
+
+void erf_batch(const double* x, double* y, const int n)
+{
+    kernels().erf(x, y, n);
+}
+
+void erf_batch(const float* x, float* y, const int n)
+{
+    kernels().erff(x, y, n);
+}
+
+void erfc_batch(const double* x, double* y, const int n)
+{
+    kernels().erfc(x, y, n);
+}
+
+void erfc_batch(const float* x, float* y, const int n)
+{
+    kernels().erfcf(x, y, n);
+}
+
+void normal_cdf_batch(const double* x, double* y, const int n)
+{
+    kernels().normal_cdf(x, y, n);
+}
+
+void normal_cdf_batch(const float* x, float* y, const int n)
+{
+    kernels().normal_cdff(x, y, n);
+}
+
+void normals_batch(const double* u, double* z, const int n)
+{
+    kernels().normals(u, z, n);
+}
+
+void normals_batch(const float* u, float* z, const int n)
+{
+    kernels().normalsf(u, z, n);
+}
+
+void sincos_batch(const double* x, double* s, double* c, const int n)
+{
+    kernels().sincos(x, s, c, n);
+}
+
+void sincos_batch(const float* x, float* s, float* c, const int n)
+{
+    kernels().sincosf(x, s, c, n);
+}
+
+void rolling_moments(const double* x, const int n, const int window, double* mean, double* variance)
+{
+    if (window < 2 or window > n)
+        throw std::invalid_argument("window must be in [2, n]");
+    kernels().rolling(x, n, window, mean, variance);
+}
+
+}
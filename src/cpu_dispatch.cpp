@@ -0,0 +1,72 @@
+#include "cpu_dispatch.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace finance {
+
+namespace {
+
+// -1 until first use.
+std::atomic<int> active{-1};
+
+Isa initial_isa()
+{
+    const Isa detected = detected_isa();
+    const char* name = std::getenv("FINANCE_ISA");
+    if (name == nullptr)
+        return detected;
+    const Isa levels[] = { Isa::Generic, Isa::Avx2, Isa::Avx512 };
+    for (const Isa isa : levels)
+        if (std::strcmp(name, isa_name(isa)) == 0 and isa <= detected)
+            return isa;
+    return detected;
+}
+
+}
+
+Isa detected_isa()
+{
+#if defined(FINANCE_ISA_DISPATCH)
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma");
+    if (avx2 and __builtin_cpu_supports("avx512f"))
+        return Isa::Avx512;
+    if (avx2)
+        return Isa::Avx2;
+#endif
+    return Isa::Generic;
+}
+
+Isa active_isa()
+{
+    int isa = active.load(std::memory_order_relaxed);
+    if (isa < 0) {
+        isa = static_cast<int>(initial_isa());
+        active.store(isa, std::memory_order_relaxed);
+    }
+    return static_cast<Isa>(isa);
+}
+
+bool set_isa(const Isa isa)
+{
+    if (isa > detected_isa())
+        return false;
+    active.store(static_cast<int>(isa), std::memory_order_relaxed);
+    return true;
+}
+
+const char* isa_name(const Isa isa)
+{
+    switch (isa) {
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Avx512:
+        return "avx512";
+    default:
+        return "generic";
+    }
+}
+
+}
@@ -0,0 +1,481 @@
+#include "event_log.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <condition_variable>
+
+namespace finance {
+
+namespace detail {
+
+std::atomic<bool> event_logging(false);
+
+}
+
+namespace {
+
+const std::uint64_t Capacity = 1 << 20;
+const std::size_t WriteSize = 1 << 20;
+const char Magic[8] = { 'F', 'I', 'N', 'L', 'O', 'G', '0', '1' };
+
+// Blocks of the file: a type and a payload length on 4 bytes each, then the payload.
+enum Block { FormatBlock = 1, RecordBlock = 2, DroppedBlock = 3, PassBlock = 4 };
+
+/**
+ * The ring buffer of one thread. Only the owning thread writes head, cached_tail and dropped,
+ * and only the log thread writes tail. Padding keeps the two sides on different cache lines.
+ */
+struct Ring
+{
+    explicit Ring(const int id)
+        : id(id), head(0), cached_tail(0), dropped(0), tail(0), reported_dropped(0), data(new char[Capacity])
+    {}
+
+    int id;
+    std::atomic<std::uint64_t> head;
+    std::uint64_t cached_tail;
+    std::atomic<std::uint64_t> dropped;
+    char padding[64];
+    std::atomic<std::uint64_t> tail;
+    std::uint64_t reported_dropped;
+    std::unique_ptr<char[]> data;
+};
+
+struct Format
+{
+    std::string text;
+    std::string signature;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<Ring*> rings;
+    std::vector<Ring*> free;
+    std::vector<Format> formats;
+};
+
+Registry& registry()
+{
+    // Never destroyed, so threads exiting after main() can still hand their ring back.
+    static Registry* r = new Registry;
+    return *r;
+}
+
+/**
+ * Owns the ring of the calling thread and hands it back for reuse when the thread exits.
+ */
+struct ThreadRing
+{
+    ThreadRing()
+        : ring(nullptr)
+    {}
+
+    ~ThreadRing()
+    {
+        if (ring == nullptr)
+            return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(ring);
+    }
+
+    Ring* ring;
+};
+
+thread_local ThreadRing current;
+
+Ring* acquire_ring()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (not r.free.empty()) {
+        Ring* ring = r.free.back();
+        r.free.pop_back();
+        return ring;
+    }
+    Ring* ring = new Ring(static_cast<int>(r.rings.size()) + 1);
+    r.rings.push_back(ring);
+    return ring;
+}
+
+/**
+ * The open log: the file, the thread writing it and what it has written so far.
+ */
+struct Writer
+{
+    std::ofstream file;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop = false;
+    std::size_t written_formats = 0;
+    std::string out;
+};
+
+std::mutex open_mutex;
+Writer* writer = nullptr;
+
+template <class T>
+void put(std::string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void put_block(std::string& out, const Block type, const std::size_t length)
+{
+    put(out, static_cast<std::uint32_t>(type));
+    put(out, static_cast<std::uint32_t>(length));
+}
+
+/**
+ * Moves everything the rings hold to w.out. Returns true if there was anything.
+ */
+bool drain(Writer& w)
+{
+    Registry& r = registry();
+    std::vector<Ring*> rings;
+    std::vector<std::uint64_t> heads;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        rings = r.rings;
+    }
+    // Heads first: the formats of every record below them are registered by now.
+    for (Ring* ring : rings)
+        heads.push_back(ring->head.load(std::memory_order_acquire));
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (; w.written_formats < r.formats.size(); w.written_formats++) {
+            const Format& f = r.formats[w.written_formats];
+            put_block(w.out, FormatBlock, 8 + f.signature.size() + f.text.size());
+            put(w.out, static_cast<std::uint32_t>(w.written_formats + 1));
+            put(w.out, static_cast<std::uint32_t>(f.signature.size()));
+            w.out += f.signature;
+            w.out += f.text;
+        }
+    }
+
+    bool any = false;
+    for (std::size_t i = 0; i < rings.size(); i++) {
+        Ring& ring = *rings[i];
+        std::uint64_t t = ring.tail.load(std::memory_order_relaxed);
+        if (t != heads[i]) {
+            const std::size_t start = w.out.size();
+            put_block(w.out, RecordBlock, 0);
+            put(w.out, static_cast<std::uint32_t>(ring.id));
+            put(w.out, static_cast<std::uint32_t>(0));
+            while (t != heads[i]) {
+                const char* record = &ring.data[t & (Capacity - 1)];
+                std::uint32_t header[2];
+                std::memcpy(header, record, 8);
+                if (header[0] != 0)
+                    w.out.append(record, header[1]);
+                t += header[1];
+            }
+            ring.tail.store(t, std::memory_order_release);
+            const std::uint32_t length = static_cast<std::uint32_t>(w.out.size() - start - 8);
+            std::memcpy(&w.out[start + 4], &length, 4);
+            any = true;
+        }
+        const std::uint64_t dropped = ring.dropped.load(std::memory_order_relaxed);
+        if (dropped != ring.reported_dropped) {
+            put_block(w.out, DroppedBlock, 16);
+            put(w.out, static_cast<std::uint32_t>(ring.id));
+            put(w.out, static_cast<std::uint32_t>(0));
+            put(w.out, dropped - ring.reported_dropped);
+            ring.reported_dropped = dropped;
+        }
+    }
+    if (any)
+        put_block(w.out, PassBlock, 0);
+    return any;
+}
+
+void flush(Writer& w)
+{
+    w.file.write(w.out.data(), w.out.size());
+    w.out.clear();
+}
+
+void run(Writer* w)
+{
+    std::unique_lock<std::mutex> lock(w->mutex);
+    for (;;) {
+        const bool stopping = w->stop;
+        lock.unlock();
+        const bool any = drain(*w);
+        // Large writes while busy; whatever is left once idle.
+        if (w->out.size() >= WriteSize or (not any and not w->out.empty()))
+            flush(*w);
+        lock.lock();
+        if (stopping)
+            break;
+        if (not any)
+            w->wake.wait_for(lock, std::chrono::milliseconds(1));
+    }
+    lock.unlock();
+    flush(*w);
+}
+
+}
+
+namespace detail {
+
+std::uint32_t log_register_format(const char* format, const std::string& signature)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Format f;
+    f.text = format;
+    f.signature = signature;
+    r.formats.push_back(f);
+    return static_cast<std::uint32_t>(r.formats.size());
+}
+
+std::uint64_t log_timestamp()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+char* log_reserve(const std::size_t size)
+{
+    Ring* ring = current.ring;
+    if (ring == nullptr)
+        ring = current.ring = acquire_ring();
+
+    std::uint64_t h = ring->head.load(std::memory_order_relaxed);
+    const std::uint64_t contiguous = Capacity - (h & (Capacity - 1));
+    const std::uint64_t needed = size + (contiguous < size ? contiguous : 0);
+    if (needed > Capacity - (h - ring->cached_tail)) {
+        ring->cached_tail = ring->tail.load(std::memory_order_acquire);
+        if (needed > Capacity - (h - ring->cached_tail)) {
+            ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    if (contiguous < size) {
+        // Records never wrap: skip the end of the buffer with a padding record.
+        const std::uint32_t padding[2] = { 0, static_cast<std::uint32_t>(contiguous) };
+        std::memcpy(&ring->data[h & (Capacity - 1)], padding, 8);
+        h += contiguous;
+        ring->head.store(h, std::memory_order_release);
+    }
+    return &ring->data[h & (Capacity - 1)];
+}
+
+void log_commit(const std::size_t size)
+{
+    Ring* ring = current.ring;
+    ring->head.store(ring->head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+}
+
+bool event_log_open(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(open_mutex);
+    if (writer != nullptr)
+        return false;
+
+    std::unique_ptr<Writer> w(new Writer);
+    w->file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (not w->file)
+        return false;
+
+    // Events left from an earlier log are discarded.
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> registry_lock(r.mutex);
+        for (Ring* ring : r.rings)
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    w->out.reserve(2 * WriteSize);
+    w->out.append(Magic, sizeof(Magic));
+    put(w->out, detail::log_timestamp());
+    put(w->out, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count()));
+    w->thread = std::thread(run, w.get());
+    writer = w.release();
+    detail::event_logging.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool event_log_close()
+{
+    std::lock_guard<std::mutex> lock(open_mutex);
+    if (writer == nullptr)
+        return true;
+    detail::event_logging.store(false, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> writer_lock(writer->mutex);
+        writer->stop = true;
+    }
+    writer->wake.notify_one();
+    writer->thread.join();
+    writer->file.close();
+    const bool ok = static_cast<bool>(writer->file);
+    delete writer;
+    writer = nullptr;
+    return ok;
+}
+
+namespace {
+
+struct Record
+{
+    std::uint64_t timestamp;
+    int ring;
+    std::uint32_t format;
+    std::string arguments;
+};
+
+template <class T>
+T get(const char*& p, const char* end)
+{
+    if (end - p < static_cast<std::ptrdiff_t>(sizeof(T)))
+        throw std::invalid_argument("truncated record");
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return value;
+}
+
+void render(std::ostream& os, const Format& f, const std::string& arguments)
+{
+    const char* p = arguments.data();
+    const char* end = p + arguments.size();
+    std::size_t from = 0;
+    for (const char code : f.signature) {
+        const std::size_t at = f.text.find("{}", from);
+        if (at == std::string::npos) {
+            os << f.text.substr(from);
+            from = f.text.size();
+            os << ' ';
+        } else {
+            os << f.text.substr(from, at - from);
+            from = at + 2;
+        }
+        switch (code) {
+        case 'i': os << get<std::int64_t>(p, end); break;
+        case 'u': os << get<std::uint64_t>(p, end); break;
+        case 'b': os << (get<std::uint64_t>(p, end) ? "true" : "false"); break;
+        case 'd': os << get<double>(p, end); break;
+        case 's': {
+            const std::uint32_t length = get<std::uint32_t>(p, end);
+            if (end - p < static_cast<std::ptrdiff_t>(length))
+                throw std::invalid_argument("truncated record");
+            os.write(p, length);
+            p += length;
+            break;
+        }
+        default:
+            throw std::invalid_argument("unknown argument type");
+        }
+    }
+    if (from < f.text.size())
+        os << f.text.substr(from);
+}
+
+}
+
+void write_event_log_text(std::istream& is, std::ostream& os)
+{
+    char magic[sizeof(Magic)];
+    std::uint64_t origin, wall;
+    if (not is.read(magic, sizeof(magic)) or not std::equal(magic, magic + sizeof(magic), Magic)
+        or not is.read(reinterpret_cast<char*>(&origin), 8) or not is.read(reinterpret_cast<char*>(&wall), 8))
+        throw std::invalid_argument("not an event log");
+
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << "# opened " << wall / 1000000000 << '.' << std::setw(9) << std::setfill('0') << wall % 1000000000
+       << std::setfill(' ') << " seconds since the epoch\n";
+
+    std::vector<Format> formats;
+    std::vector<Record> pass;
+    std::string payload;
+    auto write_pass = [&]() {
+        std::stable_sort(pass.begin(), pass.end(), [](const Record& a, const Record& b) {
+            return a.timestamp < b.timestamp;
+        });
+        for (const Record& record : pass) {
+            const std::int64_t ns = static_cast<std::int64_t>(record.timestamp - origin);
+            const std::uint64_t magnitude = ns < 0 ? -ns : ns;
+            os << (ns < 0 ? "-" : "") << magnitude / 1000000000 << '.' << std::setw(9) << std::setfill('0')
+               << magnitude % 1000000000 << std::setfill(' ') << " [" << record.ring << "] ";
+            if (record.format == 0 or record.format > formats.size())
+                throw std::invalid_argument("unknown format");
+            os << std::setprecision(15);
+            render(os, formats[record.format - 1], record.arguments);
+            os << std::setprecision(precision) << '\n';
+        }
+        pass.clear();
+    };
+
+    std::uint32_t block[2];
+    while (is.read(reinterpret_cast<char*>(block), 8)) {
+        payload.resize(block[1]);
+        if (block[1] > 0 and not is.read(&payload[0], block[1]))
+            throw std::invalid_argument("truncated block");
+        const char* p = payload.data();
+        const char* end = p + payload.size();
+        switch (block[0]) {
+        case FormatBlock: {
+            const std::uint32_t id = get<std::uint32_t>(p, end);
+            const std::uint32_t length = get<std::uint32_t>(p, end);
+            if (id != formats.size() + 1 or end - p < static_cast<std::ptrdiff_t>(length))
+                throw std::invalid_argument("malformed format");
+            Format f;
+            f.signature.assign(p, length);
+            f.text.assign(p + length, end);
+            formats.push_back(f);
+            break;
+        }
+        case RecordBlock: {
+            const int ring = static_cast<int>(get<std::uint32_t>(p, end));
+            get<std::uint32_t>(p, end);
+            while (p < end) {
+                const char* start = p;
+                Record record;
+                record.format = get<std::uint32_t>(p, end);
+                const std::uint32_t size = get<std::uint32_t>(p, end);
+                record.timestamp = get<std::uint64_t>(p, end);
+                if (size < 16 or end - start < static_cast<std::ptrdiff_t>(size))
+                    throw std::invalid_argument("truncated record");
+                record.ring = ring;
+                record.arguments.assign(p, start + size);
+                pass.push_back(std::move(record));
+                p = start + size;
+            }
+            break;
+        }
+        case DroppedBlock: {
+            const std::uint32_t ring = get<std::uint32_t>(p, end);
+            get<std::uint32_t>(p, end);
+            os << "# [" << ring << "] " << get<std::uint64_t>(p, end) << " events dropped, ring full\n";
+            break;
+        }
+        case PassBlock:
+            write_pass();
+            break;
+        default:
+            throw std::invalid_argument("unknown block");
+        }
+    }
+    if (is.gcount() != 0)
+        throw std::invalid_argument("truncated block");
+    write_pass();
+    os.flags(flags);
+    os.precision(precision);
+}
+
+}
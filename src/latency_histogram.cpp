@@ -0,0 +1,355 @@
+#include "latency_histogram.hpp"
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+namespace finance {
+
+namespace detail {
+
+std::atomic<bool> latency_recording(false);
+
+/**
+ * The buckets of one thread. Only the owning thread writes, with relaxed load and store pairs:
+ * a single writer needs no read-modify-write.
+ */
+struct LatencyShard
+{
+    LatencyShard()
+    {
+        for (int i = 0; i < LatencyHistogram::NUM_BUCKETS; i++)
+            buckets[i].store(0, std::memory_order_relaxed);
+        count.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        max.store(0, std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> buckets[LatencyHistogram::NUM_BUCKETS];
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> min;
+    std::atomic<std::uint64_t> max;
+};
+
+}
+
+namespace {
+
+const int SubBucketCount = 1 << LatencyHistogram::SUB_BUCKET_BITS;
+const int SubBucketHalf  = SubBucketCount / 2;
+
+inline void increment(std::atomic<std::uint64_t>& a, const std::uint64_t n)
+{
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct Slot
+{
+    bool alive;
+    std::vector<std::unique_ptr<detail::LatencyShard>> shards;
+    std::vector<detail::LatencyShard*> free;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::mutex named_mutex;
+    std::map<std::string, LatencyRecorder*> named;
+};
+
+Registry& registry()
+{
+    // Never destroyed, so threads exiting after main() can still hand their shards back.
+    static Registry* r = new Registry;
+    return *r;
+}
+
+/**
+ * The shards of the calling thread, by recorder id, handed back for reuse when the thread exits.
+ */
+struct ThreadShards
+{
+    ~ThreadShards()
+    {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (std::size_t id = 0; id < shards.size(); id++)
+            if (shards[id] != nullptr and r.slots[id]->alive)
+                r.slots[id]->free.push_back(shards[id]);
+    }
+
+    std::vector<detail::LatencyShard*> shards;
+};
+
+thread_local ThreadShards current;
+
+}
+
+LatencyHistogram::LatencyHistogram()
+    : buckets(NUM_BUCKETS, 0)
+{
+    clear();
+}
+
+int LatencyHistogram::bucket_of(const std::uint64_t value)
+{
+    if (value < SubBucketCount)
+        return static_cast<int>(value);
+    if (value >> MAX_VALUE_BITS)
+        return NUM_BUCKETS - 1;
+#if defined(__GNUC__)
+    const int msb = 63 - __builtin_clzll(value);
+#else
+    int msb = 0;
+    for (std::uint64_t v = value; v > 1; v >>= 1)
+        msb++;
+#endif
+    const int shift = msb - SUB_BUCKET_BITS + 1;
+    return SubBucketCount + (shift - 1) * SubBucketHalf + static_cast<int>(value >> shift) - SubBucketHalf;
+}
+
+std::uint64_t LatencyHistogram::lowest_value(const int bucket)
+{
+    if (bucket < SubBucketCount)
+        return bucket;
+    const int shift = (bucket - SubBucketCount) / SubBucketHalf + 1;
+    const std::uint64_t sub = (bucket - SubBucketCount) % SubBucketHalf + SubBucketHalf;
+    return sub << shift;
+}
+
+std::uint64_t LatencyHistogram::highest_value(const int bucket)
+{
+    if (bucket < SubBucketCount)
+        return bucket;
+    const int shift = (bucket - SubBucketCount) / SubBucketHalf + 1;
+    return lowest_value(bucket) + (std::uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(const std::uint64_t value,
+                              const std::uint64_t count)
+{
+    if (count == 0)
+        return;
+    buckets[bucket_of(value)] += count;
+    this->count += count;
+    sum += static_cast<double>(value) * count;
+    min = std::min(min, value);
+    max = std::max(max, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    for (int i = 0; i < NUM_BUCKETS; i++)
+        buckets[i] += other.buckets[i];
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+}
+
+void LatencyHistogram::add(const detail::LatencyShard& shard)
+{
+    for (int i = 0; i < NUM_BUCKETS; i++)
+        buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+    count += shard.count.load(std::memory_order_relaxed);
+    sum += static_cast<double>(shard.sum.load(std::memory_order_relaxed));
+    min = std::min(min, shard.min.load(std::memory_order_relaxed));
+    max = std::max(max, shard.max.load(std::memory_order_relaxed));
+}
+
+void LatencyHistogram::clear()
+{
+    std::fill(buckets.begin(), buckets.end(), 0);
+    count = 0;
+    min = std::numeric_limits<std::uint64_t>::max();
+    max = 0;
+    sum = 0.0;
+}
+
+std::uint64_t LatencyHistogram::get_count() const
+{
+    return count;
+}
+
+std::uint64_t LatencyHistogram::get_min() const
+{
+    return count > 0 ? min : 0;
+}
+
+std::uint64_t LatencyHistogram::get_max() const
+{
+    return max;
+}
+
+double LatencyHistogram::mean() const
+{
+    return count > 0 ? sum / count : 0.0;
+}
+
+std::uint64_t LatencyHistogram::percentile(const double q) const
+{
+    if (count == 0)
+        return 0;
+    const std::uint64_t rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * count)));
+    std::uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::min(highest_value(i), max);
+    }
+    return max;
+}
+
+void LatencyHistogram::write_percentiles(std::ostream& os) const
+{
+    static const double percentiles[] = { 50.0, 75.0, 90.0, 99.0, 99.9, 99.99, 99.999, 100.0 };
+
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << std::setw(12) << "percentile" << std::setw(12) << "value" << std::setw(12) << "count" << '\n';
+    os << std::fixed << std::setprecision(3);
+    for (const double p : percentiles) {
+        const std::uint64_t value = percentile(p / 100.0);
+        std::uint64_t below = 0;
+        for (int i = 0; i <= bucket_of(value); i++)
+            below += buckets[i];
+        os << std::setw(12) << p << std::setw(12) << value << std::setw(12) << below << '\n';
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+const std::vector<std::uint64_t>& LatencyHistogram::get_buckets() const
+{
+    return buckets;
+}
+
+LatencyRecorder::LatencyRecorder(const char* name)
+    : name{name}
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    id = static_cast<int>(r.slots.size());
+    r.slots.emplace_back(new Slot);
+    r.slots.back()->alive = true;
+}
+
+LatencyRecorder::~LatencyRecorder()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Slot& slot = *r.slots[id];
+    slot.alive = false;
+    slot.free.clear();
+    slot.shards.clear();
+}
+
+const char* LatencyRecorder::get_name() const
+{
+    return name;
+}
+
+detail::LatencyShard* LatencyRecorder::shard()
+{
+    std::vector<detail::LatencyShard*>& shards = current.shards;
+    const std::size_t index = static_cast<std::size_t>(id);
+    if (index < shards.size() and shards[index] != nullptr)
+        return shards[index];
+
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    Slot& slot = *r.slots[id];
+    detail::LatencyShard* s;
+    if (slot.free.empty()) {
+        slot.shards.emplace_back(new detail::LatencyShard);
+        s = slot.shards.back().get();
+    } else {
+        s = slot.free.back();
+        slot.free.pop_back();
+    }
+    if (shards.size() <= index)
+        shards.resize(index + 1, nullptr);
+    shards[index] = s;
+    return s;
+}
+
+void LatencyRecorder::record(const std::uint64_t value)
+{
+    detail::LatencyShard* s = shard();
+    increment(s->buckets[LatencyHistogram::bucket_of(value)], 1);
+    increment(s->count, 1);
+    increment(s->sum, value);
+    if (value < s->min.load(std::memory_order_relaxed))
+        s->min.store(value, std::memory_order_relaxed);
+    if (value > s->max.load(std::memory_order_relaxed))
+        s->max.store(value, std::memory_order_relaxed);
+}
+
+LatencyHistogram LatencyRecorder::snapshot() const
+{
+    LatencyHistogram h;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::unique_ptr<detail::LatencyShard>& s : r.slots[id]->shards)
+        h.add(*s);
+    return h;
+}
+
+void LatencyRecorder::clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (std::unique_ptr<detail::LatencyShard>& s : r.slots[id]->shards) {
+        for (int i = 0; i < LatencyHistogram::NUM_BUCKETS; i++)
+            s->buckets[i].store(0, std::memory_order_relaxed);
+        s->count.store(0, std::memory_order_relaxed);
+        s->sum.store(0, std::memory_order_relaxed);
+        s->min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+        s->max.store(0, std::memory_order_relaxed);
+    }
+}
+
+void latency_enable(const bool on)
+{
+    detail::latency_recording.store(on, std::memory_order_relaxed);
+}
+
+LatencyRecorder& latency_recorder(const char* name)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.named_mutex);
+    LatencyRecorder*& recorder = r.named[name];
+    if (recorder == nullptr)
+        recorder = new LatencyRecorder(name);
+    return *recorder;
+}
+
+void write_latency_report(std::ostream& os)
+{
+    Registry& r = registry();
+    std::vector<LatencyRecorder*> recorders;
+    {
+        std::lock_guard<std::mutex> lock(r.named_mutex);
+        for (const std::pair<const std::string, LatencyRecorder*>& n : r.named)
+            recorders.push_back(n.second);
+    }
+    for (const LatencyRecorder* recorder : recorders) {
+        const LatencyHistogram h = recorder->snapshot();
+        if (h.get_count() == 0)
+            continue;
+        os << recorder->get_name() << ": count=" << h.get_count() << " mean_ns=" << h.mean()
+           << " max_ns=" << h.get_max() << '\n';
+        h.write_percentiles(os);
+    }
+}
+
+}
@@ -3,13 +3,21 @@
 #include "present_value.hpp"
 #include "date.hpp"
 #include "dated.hpp"
+#include "event_log.hpp"
 
+#include <cstdlib>
 #include <vector>
 #include <iostream>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+
+    // FINANCE_EVENT_LOG=<file> records the events of the session for stock-market-log-decoder.
+    if (const char* log = std::getenv("FINANCE_EVENT_LOG"))
+        if (not finance::event_log_open(log))
+            std::cerr << "cannot open " << log << '\n';
+
     MainWindow w;
     w.show();
 
@@ -31,12 +39,15 @@ int main(int argc, char *argv[])
     float irr = pv.irr_discrete_cflow(time,amounts);
     bool  found = pv.unique_discrete_irr(time,amounts);
 
-    std::cout << "Present value, 5 persent discretely compounded interest = " << pvv << std::endl;
-    std::cout << "Internal rate of return, discrete compounding = " << irr << std::endl;
+    std::cout << "Present value, 5 persent discretely compounded interest = " << pvv << '\n';
+    std::cout << "Internal rate of return, discrete compounding = " << irr << '\n';
     if (found)
-        std::cout << "Real solution found" << std::endl;
+        std::cout << "Real solution found" << '\n';
     else
-        std::cout << "No meaningful solution found" << std::endl;
+        std::cout << "No meaningful solution found" << '\n';
+    std::cout.flush();
 
-    return a.exec();
+    const int status = a.exec();
+    finance::event_log_close();
+    return status;
 }
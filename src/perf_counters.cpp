@@ -0,0 +1,150 @@
+#include "perf_counters.hpp"
+
+#include <limits>
+
+#if defined(__linux__)
+#include <cstring>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+#endif
+
+namespace finance {
+
+namespace {
+
+#if defined(__linux__)
+
+bool is_intel()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    if (not __get_cpuid(0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return ebx == 0x756e6547 and edx == 0x49656e69 and ecx == 0x6c65746e;   // "GenuineIntel"
+#else
+    return false;
+#endif
+}
+
+int open_event(const PerfCounters::Event e)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (e) {
+    case PerfCounters::Cycles:       attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PerfCounters::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PerfCounters::CacheMisses:  attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case PerfCounters::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case PerfCounters::FpAssists:
+        if (not is_intel())
+            return -1;
+        attr.type = PERF_TYPE_RAW;
+        attr.config = 0x1eca;   // FP_ASSIST.ANY: event 0xca, umask 0x1e.
+        break;
+    default:
+        return -1;
+    }
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+#endif
+
+}
+
+PerfCounters::PerfCounters()
+{
+    for (int e = 0; e < NumEvents; e++) {
+#if defined(__linux__)
+        descriptors[e] = open_event(static_cast<Event>(e));
+#else
+        descriptors[e] = -1;
+#endif
+        values[e] = std::numeric_limits<double>::quiet_NaN();
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+#if defined(__linux__)
+    for (int e = 0; e < NumEvents; e++) {
+        if (descriptors[e] >= 0)
+            close(descriptors[e]);
+    }
+#endif
+}
+
+bool PerfCounters::available() const
+{
+    for (int e = 0; e < NumEvents; e++) {
+        if (descriptors[e] >= 0)
+            return true;
+    }
+    return false;
+}
+
+bool PerfCounters::available(const Event e) const
+{
+    return descriptors[e] >= 0;
+}
+
+const char* PerfCounters::name(const Event e)
+{
+    static const char* const Names[NumEvents] = {
+        "cycles", "instructions", "cache_misses", "branch_misses", "fp_assists"
+    };
+    return Names[e];
+}
+
+void PerfCounters::start()
+{
+#if defined(__linux__)
+    for (int e = 0; e < NumEvents; e++) {
+        if (descriptors[e] < 0)
+            continue;
+        ioctl(descriptors[e], PERF_EVENT_IOC_RESET, 0);
+        ioctl(descriptors[e], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+void PerfCounters::stop()
+{
+#if defined(__linux__)
+    for (int e = 0; e < NumEvents; e++) {
+        if (descriptors[e] >= 0)
+            ioctl(descriptors[e], PERF_EVENT_IOC_DISABLE, 0);
+    }
+    for (int e = 0; e < NumEvents; e++) {
+        values[e] = std::numeric_limits<double>::quiet_NaN();
+        if (descriptors[e] < 0)
+            continue;
+        // value, time enabled, time running
+        std::uint64_t data[3];
+        if (read(descriptors[e], data, sizeof(data)) != sizeof(data))
+            continue;
+        if (data[2] == 0)
+            values[e] = 0.0;
+        else
+            values[e] = static_cast<double>(data[0]) * (static_cast<double>(data[1]) / data[2]);
+    }
+#endif
+}
+
+double PerfCounters::value(const Event e) const
+{
+    return values[e];
+}
+
+}
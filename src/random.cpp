@@ -0,0 +1,165 @@
+#include "random.hpp"
+#include "cpu_dispatch.hpp"
+
+#include <algorithm>
+
+// Like the batch kernels, the bulk generators are loops the compiler vectorizes, one counter
+// block per iteration, compiled once per level by a target attribute.
+
+namespace finance {
+
+namespace {
+
+template <bool Normal>
+FINANCE_VMATH_INLINE double variate(const std::uint32_t lo, const std::uint32_t hi)
+{
+    const double u = uniform_double(lo | (static_cast<std::uint64_t>(hi) << 32));
+    return Normal ? vmath::normal_quantile(u) : u;
+}
+
+template <bool Normal>
+FINANCE_VMATH_INLINE float variate(const std::uint32_t bits)
+{
+    const float u = uniform_float(bits);
+    return Normal ? vmath::normal_quantile(u) : u;
+}
+
+/**
+ * Stores the two variates of each of the \p m blocks from \p block on.
+ */
+template <bool Normal>
+FINANCE_VMATH_INLINE void variate_loop(const StreamId& stream, const std::uint64_t block, double* out, const int m)
+{
+    const std::uint32_t k0 = static_cast<std::uint32_t>(stream.run);
+    const std::uint32_t k1 = static_cast<std::uint32_t>(stream.run >> 32);
+    const std::uint32_t path = stream.path;
+    const std::uint32_t instrument = stream.instrument;
+#pragma omp simd
+    for (int j = 0; j < m; j++) {
+        const std::uint64_t b = block + j;
+        std::uint32_t x0 = static_cast<std::uint32_t>(b);
+        std::uint32_t x1 = static_cast<std::uint32_t>(b >> 32);
+        std::uint32_t x2 = path;
+        std::uint32_t x3 = instrument;
+        detail::philox4x32(x0, x1, x2, x3, k0, k1);
+        out[2*j]   = variate<Normal>(x0, x1);
+        out[2*j+1] = variate<Normal>(x2, x3);
+    }
+}
+
+/**
+ * Stores the four variates of each of the \p m blocks from \p block on.
+ */
+template <bool Normal>
+FINANCE_VMATH_INLINE void variate_loop(const StreamId& stream, const std::uint64_t block, float* out, const int m)
+{
+    const std::uint32_t k0 = static_cast<std::uint32_t>(stream.run);
+    const std::uint32_t k1 = static_cast<std::uint32_t>(stream.run >> 32);
+    const std::uint32_t path = stream.path;
+    const std::uint32_t instrument = stream.instrument;
+#pragma omp simd
+    for (int j = 0; j < m; j++) {
+        const std::uint64_t b = block + j;
+        std::uint32_t x0 = static_cast<std::uint32_t>(b);
+        std::uint32_t x1 = static_cast<std::uint32_t>(b >> 32);
+        std::uint32_t x2 = path;
+        std::uint32_t x3 = instrument;
+        detail::philox4x32(x0, x1, x2, x3, k0, k1);
+        out[4*j]   = variate<Normal>(x0);
+        out[4*j+1] = variate<Normal>(x1);
+        out[4*j+2] = variate<Normal>(x2);
+        out[4*j+3] = variate<Normal>(x3);
+    }
+}
+
+struct Kernels
+{
+    void (*uniforms)(const StreamId&, std::uint64_t, double*, int);
+    void (*uniformsf)(const StreamId&, std::uint64_t, float*, int);
+    void (*normals)(const StreamId&, std::uint64_t, double*, int);
+    void (*normalsf)(const StreamId&, std::uint64_t, float*, int);
+};
+
+#define FINANCE_RANDOM_KERNELS(name, target) \
+    target void uniforms_##name(const StreamId& s, std::uint64_t b, double* u, int m) { variate_loop<false>(s, b, u, m); } \
+    target void uniformsf_##name(const StreamId& s, std::uint64_t b, float* u, int m) { variate_loop<false>(s, b, u, m); } \
+    target void normals_##name(const StreamId& s, std::uint64_t b, double* z, int m) { variate_loop<true>(s, b, z, m); } \
+    target void normalsf_##name(const StreamId& s, std::uint64_t b, float* z, int m) { variate_loop<true>(s, b, z, m); } \
+    const Kernels kernels_##name = { uniforms_##name, uniformsf_##name, normals_##name, normalsf_##name };
+
+FINANCE_RANDOM_KERNELS(generic, )
+#if defined(FINANCE_ISA_DISPATCH)
+FINANCE_RANDOM_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+FINANCE_RANDOM_KERNELS(avx512, __attribute__((target("avx512f,avx2,fma"))))
+#endif
+
+const Kernels& kernels()
+{
+#if defined(FINANCE_ISA_DISPATCH)
+    switch (active_isa()) {
+    case Isa::Avx512:
+        return kernels_avx512;
+    case Isa::Avx2:
+        return kernels_avx2;
+    default:
+        break;
+    }
+#endif
+    return kernels_generic;
+}
+
+/**
+ * Stores the variates \p first ... \p first + \p n - 1 of \p stream: the whole blocks in one
+ * call of \p kernel, the partial blocks at either end through a block of scratch.
+ */
+template <class T>
+void fill(void (*kernel)(const StreamId&, std::uint64_t, T*, int),
+          const StreamId& stream, std::uint64_t first, T* out, int n)
+{
+    const int per_block = 16 / sizeof(T);
+    const auto partial = [&]() {
+        T scratch[4];
+        kernel(stream, first / per_block, scratch, 1);
+        const int offset = static_cast<int>(first % per_block);
+        const int count = std::min(n, per_block - offset);
+        std::copy(scratch + offset, scratch + offset + count, out);
+        first += count;
+        out += count;
+        n -= count;
+    };
+    if (n > 0 and first % per_block != 0)
+        partial();
+    const int m = n / per_block;
+    if (m > 0) {
+        kernel(stream, first / per_block, out, m);
+        first += static_cast<std::uint64_t>(m) * per_block;
+        out += m * per_block;
+        n -= m * per_block;
+    }
+    if (n > 0)
+        partial();
+}
+
+}
+
+void uniform_batch(const StreamId& stream, const std::uint64_t first, double* u, const int n)
+{
+    fill(kernels().uniforms, stream, first, u, n);
+}
+
+void uniform_batch(const StreamId& stream, const std::uint64_t first, float* u, const int n)
+{
+    fill(kernels().uniformsf, stream, first, u, n);
+}
+
+void normal_batch(const StreamId& stream, const std::uint64_t first, double* z, const int n)
+{
+    fill(kernels().normals, stream, first, z, n);
+}
+
+void normal_batch(const StreamId& stream, const std::uint64_t first, float* z, const int n)
+{
+    fill(kernels().normalsf, stream, first, z, n);
+}
+
+}
@@ -0,0 +1,278 @@
+#include "task_scheduler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <algorithm>
+
+namespace finance {
+
+struct TaskScheduler::Queue
+{
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+    // Keeps the mutexes of neighbouring queues on different cache lines.
+    char padding[64];
+};
+
+namespace {
+
+thread_local int worker_index = -1;
+thread_local const TaskScheduler* worker_scheduler = nullptr;
+thread_local std::uint32_t steal_seed = 0;
+
+int default_workers()
+{
+    if (const char* threads = std::getenv("FINANCE_NUM_THREADS")) {
+        const int n = std::atoi(threads);
+        if (n > 0)
+            return n - 1;
+    }
+    return std::max(0, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+}
+
+/**
+ * Victim to start stealing from, spread over the workers so thieves do not all line up on the
+ * same deque.
+ */
+std::uint32_t next_victim()
+{
+    if (steal_seed == 0)
+        steal_seed = static_cast<std::uint32_t>(reinterpret_cast<std::uintptr_t>(&steal_seed)) | 1;
+    steal_seed ^= steal_seed << 13;
+    steal_seed ^= steal_seed >> 17;
+    steal_seed ^= steal_seed << 5;
+    return steal_seed;
+}
+
+}
+
+bool Task::stolen() const
+{
+    return owner != TaskScheduler::current_worker();
+}
+
+TaskScheduler::TaskScheduler(const int num_workers)
+    : shared(new Queue),
+      spawned{0},
+      queued{0},
+      sleeping{0},
+      stop{false}
+{
+    for (int w = 0; w < num_workers; w++)
+        queues.emplace_back(new Queue);
+    workers.reserve(num_workers);
+    for (int w = 0; w < num_workers; w++)
+        workers.emplace_back(&TaskScheduler::work, this, w);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stop.store(true);
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+        worker.join();
+
+    // Tasks of groups nobody waited for are dropped.
+    for (std::unique_ptr<Queue>& q : queues)
+        for (Task* task : q->tasks)
+            delete task;
+    for (Task* task : shared->tasks)
+        delete task;
+}
+
+TaskScheduler& TaskScheduler::instance()
+{
+    static TaskScheduler scheduler(default_workers());
+    return scheduler;
+}
+
+int TaskScheduler::get_num_workers() const
+{
+    return static_cast<int>(workers.size());
+}
+
+int TaskScheduler::concurrency() const
+{
+    return static_cast<int>(workers.size()) + 1;
+}
+
+long long TaskScheduler::get_spawned() const
+{
+    return spawned.load(std::memory_order_relaxed);
+}
+
+int TaskScheduler::current_worker()
+{
+    return worker_index;
+}
+
+void TaskScheduler::spawn(Task* task, const int affinity)
+{
+    const int self = (worker_scheduler == this) ? worker_index : -1;
+
+    int target = -1;
+    if (affinity >= 0 and not queues.empty())
+        target = affinity % static_cast<int>(queues.size());
+    else if (self >= 0)
+        target = self;
+    task->owner = target;
+
+    Queue* q = (target >= 0) ? queues[target].get() : shared.get();
+    {
+        std::lock_guard<std::mutex> lock(q->mutex);
+        q->tasks.push_back(task);
+    }
+    spawned.fetch_add(1, std::memory_order_relaxed);
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake.notify_one();
+    }
+}
+
+bool TaskScheduler::run_one()
+{
+    Task* task = find_task((worker_scheduler == this) ? worker_index : -1);
+    if (task == nullptr)
+        return false;
+    execute(task);
+    return true;
+}
+
+Task* TaskScheduler::find_task(const int self)
+{
+    if (queued.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+
+    Task* task = nullptr;
+    if (self >= 0) {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (not own.tasks.empty()) {
+            task = own.tasks.back();
+            own.tasks.pop_back();
+        }
+    }
+    if (task == nullptr) {
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        if (not shared->tasks.empty()) {
+            task = shared->tasks.front();
+            shared->tasks.pop_front();
+        }
+    }
+    const int n = static_cast<int>(queues.size());
+    const int start = (task == nullptr and n > 0) ? static_cast<int>(next_victim() % n) : 0;
+    for (int k = 0; task == nullptr and k < n; k++) {
+        const int victim = (start + k) % n;
+        if (victim == self)
+            continue;
+        Queue& q = *queues[victim];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (not q.tasks.empty()) {
+            task = q.tasks.front();
+            q.tasks.pop_front();
+        }
+    }
+    if (task != nullptr)
+        queued.fetch_sub(1);
+    return task;
+}
+
+void TaskScheduler::execute(Task* task)
+{
+    TaskGroup* group = task->group;
+    if (not group->is_cancelled()) {
+        try {
+            task->execute();
+        } catch (...) {
+            group->fail(std::current_exception());
+        }
+    }
+    delete task;
+    group->finished();
+}
+
+void TaskScheduler::work(const int self)
+{
+    worker_index = self;
+    worker_scheduler = this;
+    while (not stop.load()) {
+        if (Task* task = find_task(self)) {
+            execute(task);
+            continue;
+        }
+        // Spin a little before sleeping: tasks often come in bursts.
+        for (int i = 0; i < 64 and queued.load(std::memory_order_relaxed) == 0; i++)
+            std::this_thread::yield();
+        if (queued.load(std::memory_order_relaxed) > 0)
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleeping.fetch_add(1);
+        while (not stop.load() and queued.load() == 0)
+            wake.wait(lock);
+        sleeping.fetch_sub(1);
+    }
+}
+
+TaskGroup::~TaskGroup()
+{
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::spawn(Task* task, const int affinity)
+{
+    task->group = this;
+    pending.fetch_add(1, std::memory_order_relaxed);
+    scheduler.spawn(task, affinity);
+}
+
+void TaskGroup::wait()
+{
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (scheduler.run_one())
+            continue;
+        // Nothing left to help with: the last tasks run elsewhere.
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait_for(lock, std::chrono::microseconds(100), [this] {
+            return pending.load(std::memory_order_acquire) == 0;
+        });
+    }
+    // The last task decrements under the mutex: once it is released the group may be destroyed.
+    std::lock_guard<std::mutex> lock(mutex);
+    if (error) {
+        std::exception_ptr e = error;
+        error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+void TaskGroup::cancel()
+{
+    cancelled.store(true, std::memory_order_relaxed);
+}
+
+void TaskGroup::fail(std::exception_ptr e)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (not error)
+        error = e;
+    cancel();
+}
+
+void TaskGroup::finished()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        done.notify_all();
+}
+
+}
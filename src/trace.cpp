@@ -0,0 +1,269 @@
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace finance {
+
+namespace detail {
+
+std::atomic<bool> trace_recording(false);
+
+}
+
+namespace {
+
+const std::uint64_t Capacity = 1 << 15;
+
+struct Event
+{
+    const char* name;
+    std::uint64_t timestamp;
+    bool begin;
+};
+
+/**
+ * The ring buffer of one thread. head counts the events ever written; only the owning thread
+ * writes, and it publishes each event with a release store of head.
+ */
+struct Track
+{
+    explicit Track(const int id)
+        : id(id), head(0), events(new Event[Capacity])
+    {}
+
+    int id;
+    std::atomic<std::uint64_t> head;
+    std::unique_ptr<Event[]> events;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<Track*> tracks;
+    std::vector<Track*> free;
+};
+
+Registry& registry()
+{
+    // Never destroyed, so threads exiting after main() can still hand their track back.
+    static Registry* r = new Registry;
+    return *r;
+}
+
+/**
+ * Owns the track of the calling thread and hands it back for reuse when the thread exits.
+ */
+struct ThreadTrack
+{
+    ThreadTrack()
+        : track(nullptr)
+    {}
+
+    ~ThreadTrack()
+    {
+        if (track == nullptr)
+            return;
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.free.push_back(track);
+    }
+
+    Track* track;
+};
+
+thread_local ThreadTrack current;
+
+Track* acquire_track()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if (not r.free.empty()) {
+        Track* t = r.free.back();
+        r.free.pop_back();
+        return t;
+    }
+    Track* t = new Track(static_cast<int>(r.tracks.size()) + 1);
+    r.tracks.push_back(t);
+    return t;
+}
+
+std::uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void record(const char* name, const bool begin)
+{
+    Track* t = current.track;
+    if (t == nullptr)
+        t = current.track = acquire_track();
+    const std::uint64_t h = t->head.load(std::memory_order_relaxed);
+    Event& e = t->events[h & (Capacity - 1)];
+    e.name = name;
+    e.timestamp = now();
+    e.begin = begin;
+    t->head.store(h + 1, std::memory_order_release);
+}
+
+/**
+ * Calls f(track, event) for the events still in every ring, oldest first, skipping the end
+ * events whose begin event was overwritten.
+ */
+template <class Function>
+void for_each_event(Function f)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const Track* t : r.tracks) {
+        const std::uint64_t head = t->head.load(std::memory_order_acquire);
+        const std::uint64_t first = head > Capacity ? head - Capacity : 0;
+        int depth = 0;
+        for (std::uint64_t i = first; i < head; i++) {
+            const Event& e = t->events[i & (Capacity - 1)];
+            if (e.begin) {
+                depth++;
+            } else if (depth == 0) {
+                continue;
+            } else {
+                depth--;
+            }
+            f(*t, e);
+        }
+    }
+}
+
+void write_json_string(std::ostream& os, const char* s)
+{
+    os << '"';
+    for (; *s; s++) {
+        if (*s == '"' or *s == '\\')
+            os << '\\';
+        os << *s;
+    }
+    os << '"';
+}
+
+// Protocol buffers wire format.
+
+void put_varint(std::string& out, std::uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<char>(v));
+}
+
+void put_varint_field(std::string& out, const int field, const std::uint64_t v)
+{
+    put_varint(out, static_cast<std::uint64_t>(field) << 3);
+    put_varint(out, v);
+}
+
+void put_bytes_field(std::string& out, const int field, const std::string& bytes)
+{
+    put_varint(out, (static_cast<std::uint64_t>(field) << 3) | 2);
+    put_varint(out, bytes.size());
+    out += bytes;
+}
+
+}
+
+void trace_enable(const bool on)
+{
+    detail::trace_recording.store(on, std::memory_order_relaxed);
+}
+
+void trace_clear()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (Track* t : r.tracks)
+        t->head.store(0, std::memory_order_relaxed);
+}
+
+void trace_begin(const char* name)
+{
+    record(name, true);
+}
+
+void trace_end(const char* name)
+{
+    record(name, false);
+}
+
+void write_chrome_trace(std::ostream& os)
+{
+    std::uint64_t origin = ~std::uint64_t(0);
+    for_each_event([&](const Track&, const Event& e) { origin = std::min(origin, e.timestamp); });
+
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for_each_event([&](const Track& t, const Event& e) {
+        const std::uint64_t ns = e.timestamp - origin;
+        os << (first ? "\n" : ",\n") << "{\"name\":";
+        write_json_string(os, e.name);
+        os << ",\"ph\":\"" << (e.begin ? 'B' : 'E') << "\",\"pid\":1,\"tid\":" << t.id
+           << ",\"ts\":" << ns / 1000 << '.';
+        const std::uint64_t fraction = ns % 1000;
+        os << fraction / 100 << (fraction / 10) % 10 << fraction % 10 << '}';
+        first = false;
+    });
+    os << "\n]}\n";
+}
+
+void write_perfetto_trace(std::ostream& os)
+{
+    // Trace { repeated TracePacket packet = 1; }
+    const int SequenceId = 1;
+    std::string trace;
+    std::vector<int> described;
+    bool first = true;
+    for_each_event([&](const Track& t, const Event& e) {
+        if (std::find(described.begin(), described.end(), t.id) == described.end()) {
+            described.push_back(t.id);
+            // TrackDescriptor { uuid = 1; name = 2; thread = 4 { pid = 1; tid = 2; } }
+            std::string thread;
+            put_varint_field(thread, 1, 1);
+            put_varint_field(thread, 2, t.id);
+            std::string descriptor;
+            put_varint_field(descriptor, 1, t.id);
+            put_bytes_field(descriptor, 2, "thread " + std::to_string(t.id));
+            put_bytes_field(descriptor, 4, thread);
+            // TracePacket { trusted_packet_sequence_id = 10; sequence_flags = 13; track_descriptor = 60; }
+            std::string packet;
+            put_varint_field(packet, 10, SequenceId);
+            if (first)
+                put_varint_field(packet, 13, 1);   // SEQ_INCREMENTAL_STATE_CLEARED
+            put_bytes_field(packet, 60, descriptor);
+            put_bytes_field(trace, 1, packet);
+            first = false;
+        }
+        // TrackEvent { type = 9 (1 begin, 2 end); track_uuid = 11; name = 23; }
+        std::string event;
+        put_varint_field(event, 9, e.begin ? 1 : 2);
+        put_varint_field(event, 11, t.id);
+        if (e.begin)
+            put_bytes_field(event, 23, e.name);
+        // TracePacket { timestamp = 8; trusted_packet_sequence_id = 10; track_event = 11; }
+        std::string packet;
+        put_varint_field(packet, 8, e.timestamp);
+        put_varint_field(packet, 10, SequenceId);
+        put_bytes_field(packet, 11, event);
+        put_bytes_field(trace, 1, packet);
+        if (trace.size() > (1 << 20)) {
+            os.write(trace.data(), trace.size());
+            trace.clear();
+        }
+    });
+    os.write(trace.data(), trace.size());
+}
+
+}
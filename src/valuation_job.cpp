@@ -0,0 +1,74 @@
+#include "valuation_job.hpp"
+#include "present_value.hpp"
+#include "latency_histogram.hpp"
+#include "trace.hpp"
+
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+namespace finance {
+
+std::vector<ValuationJob> read_valuation_jobs(std::istream& is)
+{
+    FINANCE_TRACE_SCOPE("read_valuation_jobs");
+    std::vector<ValuationJob> jobs;
+    std::string line;
+    int line_number = 0;
+    while (std::getline(is, line)) {
+        line_number++;
+        const std::size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos or line[first] == '#')
+            continue;
+
+        std::istringstream fields(line);
+        ValuationJob job;
+        if (not (fields >> job.name >> job.rate))
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": expected name and rate");
+
+        double t, c;
+        while (fields >> t) {
+            if (not (fields >> c))
+                throw std::invalid_argument("line " + std::to_string(line_number) + ": time without amount");
+            job.cflow_times.push_back(t);
+            job.cflow_amounts.push_back(c);
+        }
+        if (not fields.eof())
+            throw std::invalid_argument("line " + std::to_string(line_number) + ": malformed number");
+        jobs.push_back(std::move(job));
+    }
+    return jobs;
+}
+
+ValuationResult evaluate(const ValuationJob& job)
+{
+    FINANCE_LATENCY_SCOPE("evaluate");
+    PresentValue<double> pv;
+
+    ValuationResult result;
+    result.name          = job.name;
+    result.present_value = pv.pv_discrete_cflow(job.cflow_times, job.cflow_amounts, job.rate);
+    result.unique_irr    = pv.unique_discrete_irr(job.cflow_times, job.cflow_amounts);
+    try {
+        result.irr       = pv.irr_discrete_cflow(job.cflow_times, job.cflow_amounts, &result.irr_statistics);
+        result.irr_found = true;
+    } catch (const std::domain_error&) {
+        result.irr       = std::numeric_limits<double>::quiet_NaN();
+        result.irr_found = false;
+    }
+    return result;
+}
+
+void write_valuation_results(std::ostream& os, const std::vector<ValuationResult>& results)
+{
+    os << "name,present_value,irr,unique_irr\n";
+    os.precision(17);
+    for (const ValuationResult& r : results) {
+        os << r.name << ',' << r.present_value << ',';
+        if (r.irr_found) os << r.irr;
+        else os << "nan";
+        os << ',' << (r.unique_irr ? "true" : "false") << '\n';
+    }
+}
+
+}
@@ -0,0 +1,271 @@
+#include "workload_generator.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+namespace finance {
+
+namespace {
+
+/**
+ * Formats records into a large buffer written to the stream in one call when full.
+ */
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(std::ostream& os)
+        : os(os), data(Capacity), used(0)
+    {}
+
+    ~OutputBuffer()
+    {
+        flush();
+    }
+
+    void put(const char c)
+    {
+        room(1);
+        data[used++] = c;
+    }
+
+    void put(const char* s)
+    {
+        while (*s)
+            put(*s++);
+    }
+
+    void put_int(long long v)
+    {
+        room(MaxNumber);
+        if (v < 0) {
+            data[used++] = '-';
+            v = -v;
+        }
+        char digits[24];
+        int n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + v % 10);
+            v /= 10;
+        } while (v > 0);
+        while (n > 0)
+            data[used++] = digits[--n];
+    }
+
+    void put_fixed(const double v, const int decimals)
+    {
+        static const double Scale[] = {1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8};
+        const double scaled = v * Scale[decimals];
+        if (not (std::fabs(scaled) < 9.0e15)) {
+            room(MaxNumber + 320);
+            used += std::snprintf(&data[used], MaxNumber + 320, "%.*f", decimals, v);
+            return;
+        }
+        long long units = std::llround(scaled);
+        if (units < 0) {
+            put('-');
+            units = -units;
+        }
+        const long long scale = static_cast<long long>(Scale[decimals]);
+        put_int(units / scale);
+        if (decimals == 0)
+            return;
+        put('.');
+        long long fraction = units % scale;
+        room(decimals);
+        for (int i = decimals - 1; i >= 0; i--) {
+            data[used + i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        used += decimals;
+    }
+
+    void flush()
+    {
+        os.write(data.data(), used);
+        used = 0;
+    }
+
+private:
+    static const int Capacity = 1 << 20;
+    static const int MaxNumber = 32;
+
+    void room(const int n)
+    {
+        if (used + n > Capacity)
+            flush();
+    }
+
+    std::ostream& os;
+    std::vector<char> data;
+    int used;
+};
+
+int days_in_month(const int month, const int year)
+{
+    static const int Days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const bool leap = (year % 4 == 0 and year % 100 != 0) or year % 400 == 0;
+    return (month == 2 and leap) ? 29 : Days[month-1];
+}
+
+/**
+ * Day of the week of a Gregorian date, 0 for Sunday (Sakamoto's method).
+ */
+int day_of_week(const int day, int month, int year)
+{
+    static const int Offset[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
+    if (month < 3)
+        year--;
+    return (year + year / 4 - year / 100 + year / 400 + Offset[month-1] + day) % 7;
+}
+
+void put_name(OutputBuffer& out, const char* prefix, const long i)
+{
+    out.put(prefix);
+    out.put_int(i);
+}
+
+}
+
+WorkloadGenerator::WorkloadGenerator(const unsigned long seed)
+    : generator(StreamId(seed))
+{}
+
+double WorkloadGenerator::uniform(const double a, const double b)
+{
+    return a + (b - a) * uniform_variate(generator);
+}
+
+void WorkloadGenerator::write_bonds(std::ostream& os,
+                                    const long num_bonds,
+                                    const int num_flows,
+                                    const double sign_change_fraction)
+{
+    OutputBuffer out(os);
+    for (long i = 0; i < num_bonds; i++) {
+        const double rate = uniform(0.01, 0.08);
+        const double coupon = 100.0 * uniform(0.01, 0.08);
+        const double price = uniform(90.0, 110.0);
+        const int reinvest = (uniform(0.0, 1.0) < sign_change_fraction and num_flows > 2) ? num_flows / 2 : -1;
+
+        put_name(out, "bond-", i);
+        out.put(' ');
+        out.put_fixed(rate, 6);
+        for (int t = 0; t < num_flows; t++) {
+            double amount = (t == 0) ? -price : coupon;
+            if (t == num_flows - 1 and t > 0)
+                amount += 100.0;
+            if (t == reinvest)
+                amount -= price * uniform(0.5, 1.5);
+            out.put(' ');
+            out.put_int(t);
+            out.put(' ');
+            out.put_fixed(amount, 2);
+        }
+        out.put('\n');
+    }
+}
+
+void WorkloadGenerator::write_loans(std::ostream& os,
+                                    const long num_loans,
+                                    const int num_flows,
+                                    const double sign_change_fraction)
+{
+    OutputBuffer out(os);
+    for (long i = 0; i < num_loans; i++) {
+        const double rate = uniform(0.01, 0.08);
+        const double loan_rate = rate + uniform(0.005, 0.04);
+        const double principal = std::floor(uniform(1.0e3, 1.0e6));
+        const int num_payments = std::max(1, num_flows - 1);
+        const double payment = principal * loan_rate / (1.0 - std::pow(1.0 + loan_rate, -num_payments));
+        const int redraw = (uniform(0.0, 1.0) < sign_change_fraction and num_flows > 2) ? num_flows / 2 : -1;
+
+        put_name(out, "loan-", i);
+        out.put(' ');
+        out.put_fixed(rate, 6);
+        for (int t = 0; t < num_flows; t++) {
+            double amount = (t == 0) ? -principal : payment;
+            if (t == redraw)
+                amount -= principal * uniform(0.5, 1.5);
+            out.put(' ');
+            out.put_int(t);
+            out.put(' ');
+            out.put_fixed(amount, 2);
+        }
+        out.put('\n');
+    }
+}
+
+void WorkloadGenerator::write_option_chains(std::ostream& os,
+                                            const int num_expiries,
+                                            const int num_strikes,
+                                            const double spot)
+{
+    OutputBuffer out(os);
+    out.put("expiry,strike,implied_volatility\n");
+    for (int e = 0; e < num_expiries; e++) {
+        const double t = 2.0 * (e + 1) / num_expiries;
+        // Raw SVI with a positive minimum variance: a + b s sqrt(1 - rho^2) > 0.
+        const double variance = uniform(0.02, 0.08);
+        const double a = 0.7 * variance * t;
+        const double b = uniform(0.05, 0.2) * std::sqrt(t);
+        const double rho = uniform(-0.8, -0.1);
+        const double m = uniform(-0.05, 0.05);
+        const double s = uniform(0.1, 0.4);
+        const double width = 0.5 * std::sqrt(t) + 0.1;
+        for (int j = 0; j < num_strikes; j++) {
+            const double k = (num_strikes == 1) ? 0.0 : -width + 2.0 * width * j / (num_strikes - 1);
+            const double x = k - m;
+            const double w = a + b * (rho * x + std::sqrt(x * x + s * s));
+            out.put_fixed(t, 6);
+            out.put(',');
+            out.put_fixed(spot * std::exp(k), 4);
+            out.put(',');
+            out.put_fixed(std::sqrt(w / t), 6);
+            out.put('\n');
+        }
+    }
+}
+
+void WorkloadGenerator::write_history(std::ostream& os,
+                                      const Date& start,
+                                      const int num_days,
+                                      const double spot,
+                                      const double drift,
+                                      const double volatility)
+{
+    const double dt = 1.0 / 252.0;
+    const double mu = (drift - 0.5 * volatility * volatility) * dt;
+    const double sd = volatility * std::sqrt(dt);
+    OutputBuffer out(os);
+    int day = start.get_day();
+    int month = start.get_month();
+    int year = start.get_year();
+    int weekday = day_of_week(day, month, year);
+    double price = spot;
+    for (int n = 0; n < num_days; ) {
+        if (weekday != 0 and weekday != 6 and Date(day, month, year).valid()) {
+            out.put_int(year);
+            out.put('-');
+            out.put_int(month);
+            out.put('-');
+            out.put_int(day);
+            out.put(',');
+            out.put_fixed(price, 4);
+            out.put('\n');
+            price *= std::exp(mu + sd * normal_variate(generator));
+            n++;
+        }
+        weekday = (weekday + 1) % 7;
+        if (++day > days_in_month(month, year)) {
+            day = 1;
+            if (++month > 12) {
+                month = 1;
+                year++;
+            }
+        }
+    }
+}
+
+}
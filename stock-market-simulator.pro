@@ -6,6 +6,12 @@ TARGET   = stock-market-simulator
 TEMPLATE = app
 CONFIG  += qt c++11
 
+# qmake CONFIG+=tracing compiles in the FINANCE_TRACE_SCOPE trace points.
+tracing: DEFINES += FINANCE_TRACING
+
+# The batch kernels are loops the compiler vectorizes for each instruction set level.
+gcc|clang: QMAKE_CXXFLAGS += -fopenmp-simd -fno-trapping-math -fno-math-errno
+
 INCLUDEPATH += ./src
 INCLUDEPATH += ./include
 INCLUDEPATH += ./gui
@@ -14,11 +20,64 @@ INCLUDEPATH += ./gui/layout
 
 SOURCES += src/main.cpp \
            src/date.cpp \
-           gui/src/main_window.cpp
+           src/valuation_job.cpp \
+           src/event_log.cpp \
+           src/batch_kernels.cpp \
+           src/random.cpp \
+           src/cpu_dispatch.cpp \
+           src/latency_histogram.cpp \
+           src/task_scheduler.cpp \
+           src/trace.cpp \
+           gui/src/main_window.cpp \
+           gui/src/compute_service.cpp \
+           gui/src/chart_widget.cpp \
+           gui/src/lazy_table_model.cpp \
+           gui/src/dashboard_widget.cpp \
+           gui/src/book_feed.cpp \
+           gui/src/depth_ladder_widget.cpp \
+           gui/src/liquidity_heatmap_widget.cpp \
+           gui/src/sweep_plot.cpp \
+           gui/src/sweep_widget.cpp
 
 HEADERS += include/present_value.hpp \
+           include/event_log.hpp \
+           include/batch_kernels.hpp \
+           include/vector_math.hpp \
+           include/cpu_dispatch.hpp \
+           include/latency_histogram.hpp \
+           include/solver_statistics.hpp \
            include/date.hpp \
            include/dated.hpp \
-           gui/include/main_window.hpp
+           include/parallel.hpp \
+           include/reproducible_sum.hpp \
+           include/task_scheduler.hpp \
+           include/hazard_curve.hpp \
+           include/credit_default_swap.hpp \
+           include/hull_white.hpp \
+           include/fft.hpp \
+           include/characteristic_functions.hpp \
+           include/carr_madan.hpp \
+           include/monte_carlo.hpp \
+           include/random.hpp \
+           include/path_payoffs.hpp \
+           include/volatility_surface.hpp \
+           include/black_scholes.hpp \
+           include/valuation_job.hpp \
+           include/min_max_pyramid.hpp \
+           include/bounded_queue.hpp \
+           include/market_update.hpp \
+           include/depth_book.hpp \
+           include/trace.hpp \
+           gui/include/main_window.hpp \
+           gui/include/compute_service.hpp \
+           gui/include/chart_widget.hpp \
+           gui/include/table_source.hpp \
+           gui/include/lazy_table_model.hpp \
+           gui/include/dashboard_widget.hpp \
+           gui/include/book_feed.hpp \
+           gui/include/depth_ladder_widget.hpp \
+           gui/include/liquidity_heatmap_widget.hpp \
+           gui/include/sweep_plot.hpp \
+           gui/include/sweep_widget.hpp
 
 FORMS   += gui/layout/main_window.ui
@@ -0,0 +1,15 @@
+# Renders the binary event logs written through FINANCE_LOG as text: no Qt modules are linked.
+
+QT      -= core gui
+
+TARGET   = stock-market-log-decoder
+TEMPLATE = app
+CONFIG  += console c++11 thread
+CONFIG  -= qt app_bundle
+
+INCLUDEPATH += ../include
+
+SOURCES += src/event_log_decoder_main.cpp \
+           ../src/event_log.cpp
+
+HEADERS += ../include/event_log.hpp
@@ -0,0 +1,54 @@
+#include "event_log.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " <log> [output]\n"
+              << "  Renders an event log written with FINANCE_LOG as text, to standard output by\n"
+              << "  default. Use '-' for standard input or standard output.\n";
+    return 1;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2 or argc > 3)
+        return usage(argv[0]);
+
+    const std::string input = argv[1];
+    const std::string output = (argc == 3) ? argv[2] : "-";
+
+    std::ifstream is;
+    if (input != "-") {
+        is.open(input.c_str(), std::ios::binary);
+        if (not is) {
+            std::cerr << "cannot open " << input << "\n";
+            return 2;
+        }
+    }
+    std::ofstream file;
+    if (output != "-") {
+        file.open(output.c_str());
+        if (not file) {
+            std::cerr << "cannot open " << output << "\n";
+            return 2;
+        }
+    }
+    std::ostream& os = (output == "-") ? std::cout : file;
+
+    try {
+        finance::write_event_log_text(input == "-" ? std::cin : is, os);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << input << ": " << e.what() << "\n";
+        return 2;
+    }
+    os.flush();
+    return os ? 0 : 2;
+}
@@ -0,0 +1,98 @@
+#include "workload_generator.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+namespace {
+
+int usage(const char* program)
+{
+    std::cerr << "usage: " << program << " <bonds|loans|chains|history> [options] <output>\n"
+              << "  --seed <n>          seed of the generator (default 1)\n"
+              << "  --count <n>         bonds, loans or expiries (default 1000)\n"
+              << "  --flows <n>         cash flows per bond or loan (default 20)\n"
+              << "  --sign-changes <f>  fraction of streams with several sign changes (default 0)\n"
+              << "  --strikes <n>       strikes per expiry (default 50)\n"
+              << "  --days <n>          business days of history (default 2520)\n"
+              << "  --start <y-m-d>     first date of history (default 2000-1-3)\n"
+              << "  --spot <x>          spot price (default 100)\n"
+              << "  Use '-' as <output> for standard output.\n";
+    return 1;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc < 3)
+        return usage(argv[0]);
+
+    const std::string kind = argv[1];
+    const std::string output = argv[argc - 1];
+    unsigned long seed = 1;
+    long count = 1000;
+    int flows = 20;
+    double sign_changes = 0.0;
+    int strikes = 50;
+    int days = 2520;
+    int year = 2000, month = 1, day = 3;
+    double spot = 100.0;
+
+    for (int i = 2; i < argc - 1; i++) {
+        const char* option = argv[i];
+        if (i + 1 >= argc - 1)
+            return usage(argv[0]);
+        const char* value = argv[++i];
+        if (std::strcmp(option, "--seed") == 0)
+            seed = std::strtoul(value, 0, 10);
+        else if (std::strcmp(option, "--count") == 0)
+            count = std::atol(value);
+        else if (std::strcmp(option, "--flows") == 0)
+            flows = std::atoi(value);
+        else if (std::strcmp(option, "--sign-changes") == 0)
+            sign_changes = std::atof(value);
+        else if (std::strcmp(option, "--strikes") == 0)
+            strikes = std::atoi(value);
+        else if (std::strcmp(option, "--days") == 0)
+            days = std::atoi(value);
+        else if (std::strcmp(option, "--start") == 0 and std::sscanf(value, "%d-%d-%d", &year, &month, &day) == 3)
+            continue;
+        else if (std::strcmp(option, "--spot") == 0)
+            spot = std::atof(value);
+        else
+            return usage(argv[0]);
+    }
+
+    std::ofstream file;
+    if (output != "-") {
+        file.open(output.c_str(), std::ios::binary);
+        if (not file) {
+            std::cerr << "cannot open " << output << "\n";
+            return 2;
+        }
+    }
+    std::ostream& os = (output == "-") ? std::cout : file;
+
+    finance::WorkloadGenerator generator(seed);
+    if (kind == "bonds")
+        generator.write_bonds(os, count, flows, sign_changes);
+    else if (kind == "loans")
+        generator.write_loans(os, count, flows, sign_changes);
+    else if (kind == "chains")
+        generator.write_option_chains(os, static_cast<int>(count), strikes, spot);
+    else if (kind == "history")
+        generator.write_history(os, Date(day, month, year), days, spot, 0.05, 0.2);
+    else
+        return usage(argv[0]);
+
+    os.flush();
+    if (not os) {
+        std::cerr << "cannot write " << output << "\n";
+        return 2;
+    }
+    return 0;
+}
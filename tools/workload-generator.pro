@@ -0,0 +1,19 @@
+# Synthetic workload generator: no Qt modules are linked.
+
+QT      -= core gui
+
+TARGET   = stock-market-workload
+TEMPLATE = app
+CONFIG  += console c++11
+CONFIG  -= qt app_bundle
+
+INCLUDEPATH += ../include
+
+SOURCES += src/workload_main.cpp \
+           ../src/workload_generator.cpp \
+           ../src/date.cpp
+
+HEADERS += ../include/workload_generator.hpp \
+           ../include/random.hpp \
+           ../include/vector_math.hpp \
+           ../include/date.hpp